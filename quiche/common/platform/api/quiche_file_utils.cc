@@ -12,6 +12,15 @@ absl::optional<std::string> ReadFileContents(absl::string_view file) {
   return ReadFileContentsImpl(file);
 }
 
+absl::optional<std::string> ReadFileRange(absl::string_view file,
+                                          uint64_t offset, size_t max_length) {
+  return ReadFileRangeImpl(file, offset, max_length);
+}
+
+absl::optional<uint64_t> GetFileSize(absl::string_view file) {
+  return GetFileSizeImpl(file);
+}
+
 bool EnumerateDirectory(absl::string_view path,
                         std::vector<std::string>& directories,
                         std::vector<std::string>& files) {
@@ -9,6 +9,8 @@
 #ifndef QUICHE_COMMON_PLATFORM_API_QUICHE_FILE_UTILS_H_
 #define QUICHE_COMMON_PLATFORM_API_QUICHE_FILE_UTILS_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -24,6 +26,15 @@ std::string JoinPath(absl::string_view a, absl::string_view b);
 // Reads the entire file into the memory.
 absl::optional<std::string> ReadFileContents(absl::string_view file);
 
+// Reads at most |max_length| bytes of the file starting at |offset|.  Returns
+// fewer bytes if the file ends before that, and an empty string if |offset| is
+// at or past the end of the file.
+absl::optional<std::string> ReadFileRange(absl::string_view file,
+                                          uint64_t offset, size_t max_length);
+
+// Returns the size of the file in bytes.
+absl::optional<uint64_t> GetFileSize(absl::string_view file);
+
 // Lists all files and directories in the directory specified by |path|. Returns
 // true on success, false on failure.
 bool EnumerateDirectory(absl::string_view path,
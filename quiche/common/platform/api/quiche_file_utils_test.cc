@@ -31,6 +31,42 @@ TEST(QuicheFileUtilsTest, ReadFileContentsFileNotFound) {
   EXPECT_FALSE(contents.has_value());
 }
 
+TEST(QuicheFileUtilsTest, ReadFileRange) {
+  std::string path = absl::StrCat(QuicheGetCommonSourcePath(),
+                                  "/platform/api/testdir/testfile");
+  absl::optional<std::string> contents = ReadFileRange(path, 5, 2);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_EQ(*contents, "is");
+
+  // Reads are truncated at the end of the file.
+  contents = ReadFileRange(path, 15, 100);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_EQ(*contents, "file.");
+
+  contents = ReadFileRange(path, 20, 100);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_EQ(*contents, "");
+}
+
+TEST(QuicheFileUtilsTest, ReadFileRangeFileNotFound) {
+  std::string path =
+      absl::StrCat(QuicheGetCommonSourcePath(),
+                   "/platform/api/testdir/file-that-does-not-exist");
+  EXPECT_FALSE(ReadFileRange(path, 0, 10).has_value());
+}
+
+TEST(QuicheFileUtilsTest, GetFileSize) {
+  std::string path = absl::StrCat(QuicheGetCommonSourcePath(),
+                                  "/platform/api/testdir/testfile");
+  absl::optional<uint64_t> size = GetFileSize(path);
+  ASSERT_TRUE(size.has_value());
+  EXPECT_EQ(20u, *size);
+
+  path = absl::StrCat(QuicheGetCommonSourcePath(),
+                      "/platform/api/testdir/file-that-does-not-exist");
+  EXPECT_FALSE(GetFileSize(path).has_value());
+}
+
 TEST(QuicheFileUtilsTest, EnumerateDirectory) {
   std::string path =
       absl::StrCat(QuicheGetCommonSourcePath(), "/platform/api/testdir");
@@ -7,36 +7,32 @@
 
 #include <string>
 
+#include "quiche_platform_impl/quiche_histogram_impl.h"
+
 namespace quiche {
 
-// Use namespace qualifier in case the macro is used outside the quiche
-// namespace.
+// Samples are recorded in the histograms of
+// QuicheHistogramRegistryImpl::Client(). Bucket layouts are fixed, so |min|,
+// |max| and |num_buckets| are ignored.
 
 #define QUICHE_CLIENT_HISTOGRAM_ENUM_IMPL(name, sample, enum_size, docstring) \
-  do {                                                                        \
-    quiche::QuicheClientSparseHistogramImpl(name, static_cast<int>(sample));  \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Client, name, sample)
 
 #define QUICHE_CLIENT_HISTOGRAM_BOOL_IMPL(name, sample, docstring) \
-  do {                                                             \
-    (void)sample; /* Workaround for -Wunused-variable. */          \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Client, name, sample)
 
 #define QUICHE_CLIENT_HISTOGRAM_TIMES_IMPL(name, sample, min, max, \
                                            num_buckets, docstring) \
-  do {                                                             \
-    (void)sample; /* Workaround for -Wunused-variable. */          \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Client, name, sample)
 
 #define QUICHE_CLIENT_HISTOGRAM_COUNTS_IMPL(name, sample, min, max, \
                                             num_buckets, docstring) \
-  do {                                                              \
-    quiche::QuicheClientSparseHistogramImpl(name, sample);          \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Client, name, sample)
 
-inline void QuicheClientSparseHistogramImpl(const std::string& /*name*/,
-                                            int /*sample*/) {
-  // No-op.
+// Records |sample| in the histogram |name|, which may differ between calls.
+inline void QuicheClientSparseHistogramImpl(const std::string& name,
+                                            int sample) {
+  QuicheHistogramRegistryImpl::Client().GetOrCreate(name)->Add(sample);
 }
 
 }  // namespace quiche
@@ -74,6 +74,49 @@ absl::optional<std::string> ReadFileContentsImpl(absl::string_view file) {
   return output;
 }
 
+absl::optional<std::string> ReadFileRangeImpl(absl::string_view file,
+                                              uint64_t offset,
+                                              size_t max_length) {
+  absl::optional<uint64_t> file_size = GetFileSizeImpl(file);
+  if (!file_size.has_value()) {
+    return absl::nullopt;
+  }
+  if (offset >= *file_size) {
+    return std::string();
+  }
+
+  std::ifstream input_file(std::string{file}, std::ios::binary);
+  if (!input_file || !input_file.is_open()) {
+    return absl::nullopt;
+  }
+  input_file.seekg(offset, std::ios_base::beg);
+
+  std::string output;
+  const uint64_t remaining = *file_size - offset;
+  output.resize(remaining < max_length ? remaining : max_length);
+  input_file.read(&output[0], output.size());
+  if (!input_file) {
+    return absl::nullopt;
+  }
+
+  return output;
+}
+
+absl::optional<uint64_t> GetFileSizeImpl(absl::string_view file) {
+  std::ifstream input_file(std::string{file}, std::ios::binary);
+  if (!input_file || !input_file.is_open()) {
+    return absl::nullopt;
+  }
+
+  input_file.seekg(0, std::ios_base::end);
+  auto file_size = input_file.tellg();
+  if (!input_file) {
+    return absl::nullopt;
+  }
+
+  return file_size;
+}
+
 #if defined(_WIN32)
 
 class ScopedDir {
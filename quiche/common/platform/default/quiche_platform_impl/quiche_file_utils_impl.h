@@ -5,6 +5,8 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_FILE_UTILS_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_FILE_UTILS_IMPL_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,12 @@ std::string JoinPathImpl(absl::string_view a, absl::string_view b);
 
 absl::optional<std::string> ReadFileContentsImpl(absl::string_view file);
 
+absl::optional<std::string> ReadFileRangeImpl(absl::string_view file,
+                                              uint64_t offset,
+                                              size_t max_length);
+
+absl::optional<uint64_t> GetFileSizeImpl(absl::string_view file);
+
 bool EnumerateDirectoryImpl(absl::string_view path,
                             std::vector<std::string>& directories,
                             std::vector<std::string>& files);
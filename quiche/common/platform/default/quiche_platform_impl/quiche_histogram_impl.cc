@@ -0,0 +1,181 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche_platform_impl/quiche_histogram_impl.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+#include "absl/strings/str_cat.h"
+
+namespace quiche {
+
+namespace {
+
+// log2(kNumLinearBuckets) and log2(kSubBucketsPerPowerOfTwo).
+constexpr int kLinearBits = 4;
+constexpr int kSubBucketBits = 3;
+
+static_assert(QuicheHistogramImpl::kNumLinearBuckets == 1u << kLinearBits,
+              "kLinearBits mismatch");
+static_assert(QuicheHistogramImpl::kSubBucketsPerPowerOfTwo ==
+                  1u << kSubBucketBits,
+              "kSubBucketBits mismatch");
+
+}  // namespace
+
+QuicheHistogramImpl::QuicheHistogramImpl(absl::string_view name)
+    : name_(name), shards_(new Shard[kNumShards]) {}
+
+// static
+size_t QuicheHistogramImpl::BucketIndex(uint64_t value) {
+  if (value < kNumLinearBuckets) {
+    return static_cast<size_t>(value);
+  }
+  // The position of the most significant bit picks the power of two, and the
+  // kSubBucketBits bits below it the bucket within that power.
+  const int msb = 63 - absl::countl_zero(value);
+  const size_t sub_bucket =
+      (value >> (msb - kSubBucketBits)) & (kSubBucketsPerPowerOfTwo - 1);
+  const size_t index = kNumLinearBuckets +
+                       (msb - kLinearBits) * kSubBucketsPerPowerOfTwo +
+                       sub_bucket;
+  // Samples above the int64_t range share the last bucket.
+  return std::min(index, kNumBuckets - 1);
+}
+
+// static
+int64_t QuicheHistogramImpl::BucketLowerBound(size_t index) {
+  if (index < kNumLinearBuckets) {
+    return static_cast<int64_t>(index);
+  }
+  const size_t offset = index - kNumLinearBuckets;
+  const int msb =
+      kLinearBits + static_cast<int>(offset / kSubBucketsPerPowerOfTwo);
+  const uint64_t sub_bucket = offset % kSubBucketsPerPowerOfTwo;
+  return static_cast<int64_t>((uint64_t{1} << msb) |
+                              (sub_bucket << (msb - kSubBucketBits)));
+}
+
+// static
+size_t QuicheHistogramImpl::ShardIndex() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local const size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+QuicheHistogramImpl::Snapshot QuicheHistogramImpl::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.name = name_;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    snapshot.sum += shards_[i].sum.load(std::memory_order_relaxed);
+  }
+  for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < kNumShards; ++i) {
+      count += shards_[i].counts[bucket].load(std::memory_order_relaxed);
+    }
+    if (count == 0) {
+      continue;
+    }
+    snapshot.count += count;
+    snapshot.buckets.push_back({BucketLowerBound(bucket), count});
+  }
+  return snapshot;
+}
+
+// static
+QuicheHistogramRegistryImpl& QuicheHistogramRegistryImpl::Server() {
+  static QuicheHistogramRegistryImpl* registry =
+      new QuicheHistogramRegistryImpl();
+  return *registry;
+}
+
+// static
+QuicheHistogramRegistryImpl& QuicheHistogramRegistryImpl::Client() {
+  static QuicheHistogramRegistryImpl* registry =
+      new QuicheHistogramRegistryImpl();
+  return *registry;
+}
+
+QuicheHistogramImpl* QuicheHistogramRegistryImpl::GetOrCreate(
+    absl::string_view name) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<QuicheHistogramImpl>& histogram =
+      histograms_[std::string(name)];
+  if (histogram == nullptr) {
+    histogram = std::make_unique<QuicheHistogramImpl>(name);
+  }
+  return histogram.get();
+}
+
+std::vector<QuicheHistogramImpl::Snapshot>
+QuicheHistogramRegistryImpl::GetSnapshots() const {
+  std::vector<const QuicheHistogramImpl*> histograms;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& entry : histograms_) {
+      histograms.push_back(entry.second.get());
+    }
+  }
+  std::sort(histograms.begin(), histograms.end(),
+            [](const QuicheHistogramImpl* a, const QuicheHistogramImpl* b) {
+              return a->name() < b->name();
+            });
+  std::vector<QuicheHistogramImpl::Snapshot> snapshots;
+  snapshots.reserve(histograms.size());
+  for (const QuicheHistogramImpl* histogram : histograms) {
+    snapshots.push_back(histogram->GetSnapshot());
+  }
+  return snapshots;
+}
+
+std::string QuicheHistogramRegistryImpl::ExportText() const {
+  std::string text;
+  for (const QuicheHistogramImpl::Snapshot& snapshot : GetSnapshots()) {
+    absl::StrAppend(&text, snapshot.name, " count=", snapshot.count,
+                    " sum=", snapshot.sum);
+    for (const QuicheHistogramImpl::Bucket& bucket : snapshot.buckets) {
+      absl::StrAppend(&text, " ", bucket.lower_bound, ":", bucket.count);
+    }
+    absl::StrAppend(&text, "\n");
+  }
+  return text;
+}
+
+std::string QuicheHistogramRegistryImpl::ExportJson() const {
+  // Histogram names are string literals of the call sites, so only quotes
+  // and backslashes need to be escaped.
+  auto escape = [](absl::string_view name) {
+    std::string escaped;
+    for (char c : name) {
+      if (c == '"' || c == '\\') {
+        escaped.push_back('\\');
+      }
+      escaped.push_back(c);
+    }
+    return escaped;
+  };
+  std::string json = "{";
+  bool first_histogram = true;
+  for (const QuicheHistogramImpl::Snapshot& snapshot : GetSnapshots()) {
+    absl::StrAppend(&json, first_histogram ? "" : ",", "\"",
+                    escape(snapshot.name), "\":{\"count\":", snapshot.count,
+                    ",\"sum\":", snapshot.sum, ",\"buckets\":[");
+    first_histogram = false;
+    bool first_bucket = true;
+    for (const QuicheHistogramImpl::Bucket& bucket : snapshot.buckets) {
+      absl::StrAppend(&json, first_bucket ? "" : ",", "[", bucket.lower_bound,
+                      ",", bucket.count, "]");
+      first_bucket = false;
+    }
+    absl::StrAppend(&json, "]}");
+  }
+  absl::StrAppend(&json, "}");
+  return json;
+}
+
+}  // namespace quiche
@@ -0,0 +1,148 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_HISTOGRAM_IMPL_H_
+#define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_HISTOGRAM_IMPL_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "quiche/common/platform/api/quiche_export.h"
+
+namespace quiche {
+
+// A histogram of non-negative integer samples with log-linear buckets: values
+// below 16 have a bucket each, and every power of two above is split into 8
+// buckets, which bounds the relative error to 12.5% over the whole int64_t
+// range. Add() is lock-free: counts are relaxed atomics, spread over shards
+// picked per thread so that threads recording the same histogram rarely share
+// a cache line.
+class QUICHE_EXPORT_PRIVATE QuicheHistogramImpl {
+ public:
+  static constexpr size_t kNumLinearBuckets = 16;
+  static constexpr size_t kSubBucketsPerPowerOfTwo = 8;
+  static constexpr size_t kNumBuckets =
+      kNumLinearBuckets + (63 - 4) * kSubBucketsPerPowerOfTwo;
+
+  struct QUICHE_EXPORT_PRIVATE Bucket {
+    // Smallest sample counted in this bucket.
+    int64_t lower_bound;
+    uint64_t count;
+  };
+
+  struct QUICHE_EXPORT_PRIVATE Snapshot {
+    std::string name;
+    uint64_t count = 0;
+    // Sum of the samples, wrapping around on overflow.
+    uint64_t sum = 0;
+    // Buckets with a non-zero count, in increasing order.
+    std::vector<Bucket> buckets;
+  };
+
+  explicit QuicheHistogramImpl(absl::string_view name);
+  QuicheHistogramImpl(const QuicheHistogramImpl&) = delete;
+  QuicheHistogramImpl& operator=(const QuicheHistogramImpl&) = delete;
+
+  // Records |sample|. Negative samples are counted as 0.
+  void Add(int64_t sample) {
+    Shard& shard = shards_[ShardIndex()];
+    const uint64_t value = sample < 0 ? 0 : static_cast<uint64_t>(sample);
+    shard.counts[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // Returns the counts recorded so far. Samples recorded concurrently may or
+  // may not be included.
+  Snapshot GetSnapshot() const;
+
+  const std::string& name() const { return name_; }
+
+  // Returns the index of the bucket counting |value|.
+  static size_t BucketIndex(uint64_t value);
+  // Returns the smallest value counted in bucket |index|.
+  static int64_t BucketLowerBound(size_t index);
+
+ private:
+  static constexpr size_t kNumShards = 8;
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kNumBuckets> counts = {};
+    std::atomic<uint64_t> sum{0};
+  };
+
+  // Returns the shard used by the calling thread.
+  static size_t ShardIndex();
+
+  const std::string name_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+// Histograms by name. Histograms are never destroyed, so pointers returned by
+// GetOrCreate() can be cached.
+class QUICHE_EXPORT_PRIVATE QuicheHistogramRegistryImpl {
+ public:
+  // Registries of the QUICHE_SERVER_HISTOGRAM_* and QUICHE_CLIENT_HISTOGRAM_*
+  // macros.
+  static QuicheHistogramRegistryImpl& Server();
+  static QuicheHistogramRegistryImpl& Client();
+
+  QuicheHistogramRegistryImpl() = default;
+  QuicheHistogramRegistryImpl(const QuicheHistogramRegistryImpl&) = delete;
+  QuicheHistogramRegistryImpl& operator=(const QuicheHistogramRegistryImpl&) =
+      delete;
+
+  QuicheHistogramImpl* GetOrCreate(absl::string_view name);
+
+  // Returns snapshots of all the histograms, ordered by name.
+  std::vector<QuicheHistogramImpl::Snapshot> GetSnapshots() const;
+
+  // Exports all the histograms, one per line, as
+  // "<name> count=<count> sum=<sum> <lower bound>:<count> ...".
+  std::string ExportText() const;
+  // Exports all the histograms as a JSON object keyed by name, with "count",
+  // "sum" and "buckets" members, the latter a list of [lower bound, count].
+  std::string ExportJson() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<QuicheHistogramImpl>>
+      histograms_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Converts a histogram sample to an integer. Durations, such as
+// QuicTime::Delta, are recorded in microseconds.
+template <typename T>
+std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                 int64_t>
+QuicheHistogramSampleImpl(T sample) {
+  return static_cast<int64_t>(sample);
+}
+template <typename T>
+auto QuicheHistogramSampleImpl(const T& sample)
+    -> decltype(static_cast<int64_t>(sample.ToMicroseconds())) {
+  return static_cast<int64_t>(sample.ToMicroseconds());
+}
+
+}  // namespace quiche
+
+// Records |sample| in the histogram |name| of |registry|. The histogram is
+// looked up once per call site, so |name| must be the same on every call.
+#define QUICHE_HISTOGRAM_ADD_IMPL(registry, name, sample)                 \
+  do {                                                                    \
+    static ::quiche::QuicheHistogramImpl* const quiche_histogram =        \
+        ::quiche::QuicheHistogramRegistryImpl::registry().GetOrCreate(    \
+            name);                                                        \
+    quiche_histogram->Add(::quiche::QuicheHistogramSampleImpl(sample));   \
+  } while (0)
+
+#endif  // QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_HISTOGRAM_IMPL_H_
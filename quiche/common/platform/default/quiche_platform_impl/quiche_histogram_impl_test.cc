@@ -0,0 +1,144 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche_platform_impl/quiche_histogram_impl.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "quiche/common/platform/api/quiche_client_stats.h"
+#include "quiche/common/platform/api/quiche_server_stats.h"
+#include "quiche/common/platform/api/quiche_test.h"
+
+namespace quiche {
+namespace test {
+namespace {
+
+using Bucket = QuicheHistogramImpl::Bucket;
+
+class QuicheHistogramImplTest : public QuicheTest {};
+
+TEST_F(QuicheHistogramImplTest, BucketBoundaries) {
+  for (uint64_t value = 0; value < 16; ++value) {
+    EXPECT_EQ(value, QuicheHistogramImpl::BucketIndex(value));
+  }
+  // Every power of two is split into 8 buckets.
+  EXPECT_EQ(16u, QuicheHistogramImpl::BucketIndex(16));
+  EXPECT_EQ(16u, QuicheHistogramImpl::BucketIndex(17));
+  EXPECT_EQ(17u, QuicheHistogramImpl::BucketIndex(18));
+  EXPECT_EQ(23u, QuicheHistogramImpl::BucketIndex(31));
+  EXPECT_EQ(24u, QuicheHistogramImpl::BucketIndex(32));
+  EXPECT_EQ(QuicheHistogramImpl::kNumBuckets - 1,
+            QuicheHistogramImpl::BucketIndex(
+                std::numeric_limits<int64_t>::max()));
+  EXPECT_EQ(QuicheHistogramImpl::kNumBuckets - 1,
+            QuicheHistogramImpl::BucketIndex(
+                std::numeric_limits<uint64_t>::max()));
+
+  // Lower bounds are increasing and map back to their own bucket.
+  int64_t previous = -1;
+  for (size_t i = 0; i < QuicheHistogramImpl::kNumBuckets; ++i) {
+    const int64_t lower_bound = QuicheHistogramImpl::BucketLowerBound(i);
+    EXPECT_LT(previous, lower_bound);
+    EXPECT_EQ(i, QuicheHistogramImpl::BucketIndex(lower_bound));
+    EXPECT_EQ(i - (i > 0 ? 1 : 0),
+              QuicheHistogramImpl::BucketIndex(lower_bound - (i > 0 ? 1 : 0)));
+    previous = lower_bound;
+  }
+}
+
+TEST_F(QuicheHistogramImplTest, Snapshot) {
+  QuicheHistogramImpl histogram("test");
+  histogram.Add(3);
+  histogram.Add(3);
+  histogram.Add(-5);
+  histogram.Add(1000);
+
+  QuicheHistogramImpl::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ("test", snapshot.name);
+  EXPECT_EQ(4u, snapshot.count);
+  EXPECT_EQ(1006u, snapshot.sum);
+  ASSERT_EQ(3u, snapshot.buckets.size());
+  EXPECT_EQ(0, snapshot.buckets[0].lower_bound);
+  EXPECT_EQ(1u, snapshot.buckets[0].count);
+  EXPECT_EQ(3, snapshot.buckets[1].lower_bound);
+  EXPECT_EQ(2u, snapshot.buckets[1].count);
+  EXPECT_EQ(960, snapshot.buckets[2].lower_bound);
+  EXPECT_EQ(1u, snapshot.buckets[2].count);
+}
+
+// Stands in for a benchmark of Add(): many threads hammering one histogram
+// must not lose any sample.
+TEST_F(QuicheHistogramImplTest, ConcurrentAdds) {
+  constexpr int kNumThreads = 8;
+  constexpr int kAddsPerThread = 100000;
+  QuicheHistogramImpl histogram("concurrent");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&histogram]() {
+      for (int j = 0; j < kAddsPerThread; ++j) {
+        histogram.Add(j % 100);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  QuicheHistogramImpl::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(uint64_t{kNumThreads} * kAddsPerThread, snapshot.count);
+  EXPECT_EQ(uint64_t{kNumThreads} * (kAddsPerThread / 100) * 4950,
+            snapshot.sum);
+}
+
+TEST_F(QuicheHistogramImplTest, Export) {
+  QuicheHistogramRegistryImpl registry;
+  EXPECT_EQ(registry.GetOrCreate("b"), registry.GetOrCreate("b"));
+  registry.GetOrCreate("b")->Add(20);
+  registry.GetOrCreate("a\"")->Add(1);
+  registry.GetOrCreate("a\"")->Add(1);
+
+  EXPECT_EQ("a\" count=2 sum=2 1:2\nb count=1 sum=20 20:1\n",
+            registry.ExportText());
+  EXPECT_EQ(
+      "{\"a\\\"\":{\"count\":2,\"sum\":2,\"buckets\":[[1,2]]},"
+      "\"b\":{\"count\":1,\"sum\":20,\"buckets\":[[20,1]]}}",
+      registry.ExportJson());
+}
+
+TEST_F(QuicheHistogramImplTest, StatsMacros) {
+  enum class TestEnum { kFirst, kSecond, kLast };
+  QUICHE_SERVER_HISTOGRAM_ENUM("QuicheHistogramImplTest.ServerEnum",
+                               TestEnum::kSecond, TestEnum::kLast, "");
+  QUICHE_SERVER_HISTOGRAM_BOOL("QuicheHistogramImplTest.ServerBool", true, "");
+  QUICHE_CLIENT_HISTOGRAM_COUNTS("QuicheHistogramImplTest.ClientCounts", 7, 1,
+                                 100, 50, "");
+  QuicheClientSparseHistogram("QuicheHistogramImplTest.ClientSparse", 9);
+
+  QuicheHistogramImpl::Snapshot snapshot =
+      QuicheHistogramRegistryImpl::Server()
+          .GetOrCreate("QuicheHistogramImplTest.ServerEnum")
+          ->GetSnapshot();
+  ASSERT_EQ(1u, snapshot.buckets.size());
+  EXPECT_EQ(1, snapshot.buckets[0].lower_bound);
+  EXPECT_EQ(1u, QuicheHistogramRegistryImpl::Server()
+                    .GetOrCreate("QuicheHistogramImplTest.ServerBool")
+                    ->GetSnapshot()
+                    .count);
+  EXPECT_EQ(7u, QuicheHistogramRegistryImpl::Client()
+                    .GetOrCreate("QuicheHistogramImplTest.ClientCounts")
+                    ->GetSnapshot()
+                    .sum);
+  EXPECT_EQ(9u, QuicheHistogramRegistryImpl::Client()
+                    .GetOrCreate("QuicheHistogramImplTest.ClientSparse")
+                    ->GetSnapshot()
+                    .sum);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quiche
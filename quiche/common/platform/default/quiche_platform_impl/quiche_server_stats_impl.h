@@ -5,22 +5,24 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SERVER_STATS_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SERVER_STATS_IMPL_H_
 
+#include "quiche_platform_impl/quiche_histogram_impl.h"
+
+// Samples are recorded in the histograms of
+// QuicheHistogramRegistryImpl::Server(). Bucket layouts are fixed, so |min|,
+// |max| and |bucket_count| are ignored.
+
 #define QUICHE_SERVER_HISTOGRAM_ENUM_IMPL(name, sample, enum_size, docstring) \
-  do {                                                                        \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Server, name, sample)
 
 #define QUICHE_SERVER_HISTOGRAM_BOOL_IMPL(name, sample, docstring) \
-  do {                                                             \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Server, name, sample)
 
 #define QUICHE_SERVER_HISTOGRAM_TIMES_IMPL(name, sample, min, max,  \
                                            bucket_count, docstring) \
-  do {                                                              \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Server, name, sample)
 
 #define QUICHE_SERVER_HISTOGRAM_COUNTS_IMPL(name, sample, min, max,  \
                                             bucket_count, docstring) \
-  do {                                                               \
-  } while (0)
+  QUICHE_HISTOGRAM_ADD_IMPL(Server, name, sample)
 
 #endif  // QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SERVER_STATS_IMPL_H_
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "quiche/epoll_server/platform/api/epoll_bug.h"
 
@@ -56,6 +57,10 @@
 // The size we use for buffers passed to strerror_r
 static const int kErrorBufferSize = 256;
 
+// Default threshold above which a callback is reported as slow while loop
+// stats are enabled.
+static const int64_t kDefaultSlowCallbackThresholdInUs = 10000;
+
 namespace epoll_server {
 
 template <typename T>
@@ -108,7 +113,13 @@ SimpleEpollServer::SimpleEpollServer()
       write_fd_(-1),
       in_wait_for_events_and_execute_callbacks_(false),
       in_shutdown_(false),
-      last_delay_in_usec_(0) {
+      last_delay_in_usec_(0),
+      last_wakeup_time_in_us_(0),
+      last_busy_time_in_usec_(0),
+      loop_stats_enabled_(false),
+      slow_callback_threshold_in_us_(kDefaultSlowCallbackThresholdInUs),
+      loop_stats_log_interval_in_us_(0),
+      last_loop_stats_log_time_in_us_(0) {
   // ensure that the epoll_fd_ is valid.
   CHECK_NE(epoll_fd_, -1);
   LIST_INIT(&ready_list_);
@@ -353,9 +364,16 @@ void SimpleEpollServer::WaitForEventsAndExecuteCallbacks() {
   }
   AutoReset<bool> recursion_guard(&in_wait_for_events_and_execute_callbacks_,
                                   true);
+  const bool record_loop_stats = loop_stats_enabled_;
+  if (record_loop_stats) {
+    ++loop_stats_.iterations;
+  }
   if (alarm_map_.empty()) {
     // no alarms, this is business as usual.
     WaitForEventsAndCallHandleEvents(timeout_in_us_, events_, events_size_);
+    if (record_loop_stats) {
+      RecordIterationEnd(NowInUsec());
+    }
     recorded_now_in_us_ = 0;
     return;
   }
@@ -392,6 +410,9 @@ void SimpleEpollServer::WaitForEventsAndExecuteCallbacks() {
 
   WaitForEventsAndCallHandleEvents(wait_time_in_us, events_, events_size_);
   CallAndReregisterAlarmEvents();
+  if (record_loop_stats) {
+    RecordIterationEnd(NowInUsec());
+  }
   recorded_now_in_us_ = 0;
 }
 
@@ -636,7 +657,11 @@ void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
     }
   }
   const int timeout_in_ms = timeout_in_us / 1000;
-  int64_t expected_wakeup_us = NowInUsec() + timeout_in_us;
+  const int64_t wait_start_us = NowInUsec();
+  int64_t expected_wakeup_us = wait_start_us + timeout_in_us;
+  if (last_wakeup_time_in_us_ != 0) {
+    last_busy_time_in_usec_ = wait_start_us - last_wakeup_time_in_us_;
+  }
 
   int nfds = epoll_wait_impl(epoll_fd_, events, events_size, timeout_in_ms);
   EPOLL_VLOG(3) << "nfds=" << nfds;
@@ -653,6 +678,10 @@ void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
   // done epoll_wait, which guarantees that the maximum error is the amount of
   // time it takes to process all the events generated by epoll_wait.
   recorded_now_in_us_ = NowInUsec();
+  last_wakeup_time_in_us_ = recorded_now_in_us_;
+  if (loop_stats_enabled_) {
+    loop_stats_.epoll_wait_time_in_us += recorded_now_in_us_ - wait_start_us;
+  }
 
   if (timeout_in_us > 0) {
     int64_t delta = NowInUsec() - expected_wakeup_us;
@@ -694,6 +723,10 @@ void SimpleEpollServer::CallReadyListCallbacks() {
   if (tmp_list_.lh_first) {
     tmp_list_.lh_first->entry.le_prev = &tmp_list_.lh_first;
     EpollEvent event(0);
+    // Sample the clock once per callback when recording stats: the end of one
+    // callback is the start of the next.
+    const bool record_loop_stats = loop_stats_enabled_;
+    int64_t callback_start_in_us = record_loop_stats ? NowInUsec() : 0;
     while (tmp_list_.lh_first != NULL) {
       DCHECK_GT(ready_list_size_, 0);
       CBAndEventMask* cb_and_mask = tmp_list_.lh_first;
@@ -713,6 +746,14 @@ void SimpleEpollServer::CallReadyListCallbacks() {
         AutoReset<bool> in_use_guard(&(cb_and_mask->in_use), true);
         cb_and_mask->cb->OnEvent(cb_and_mask->fd, &event);
       }
+      if (record_loop_stats) {
+        const int64_t now_in_us = NowInUsec();
+        // cb is NULL here if OnEvent() unregistered the fd, in which case the
+        // callback may already have been destroyed.
+        RecordCallbackTime(cb_and_mask->cb, cb_and_mask->fd,
+                           now_in_us - callback_start_in_us);
+        callback_start_in_us = now_in_us;
+      }
 
       // Since OnEvent may have called UnregisterFD, we must check here that
       // the callback is still valid. If it isn't, then UnregisterFD *was*
@@ -732,6 +773,9 @@ void SimpleEpollServer::CallAndReregisterAlarmEvents() {
   int64_t now_in_us = recorded_now_in_us_;
   DCHECK_NE(0, recorded_now_in_us_);
 
+  const bool record_loop_stats = loop_stats_enabled_;
+  const int64_t alarms_start_in_us = record_loop_stats ? NowInUsec() : 0;
+
   TimeToAlarmCBMap::iterator erase_it;
 
   // execute alarms.
@@ -749,6 +793,14 @@ void SimpleEpollServer::CallAndReregisterAlarmEvents() {
       ++i;
       continue;
     }
+    if (record_loop_stats) {
+      const int64_t lateness_in_us = now_in_us - i->first;
+      ++loop_stats_.alarms_fired;
+      const int bucket = LoopStats::AlarmLatenessBucket(lateness_in_us);
+      ++loop_stats_.alarm_lateness_histogram[bucket];
+      loop_stats_.max_alarm_lateness_in_us =
+          std::max(loop_stats_.max_alarm_lateness_in_us, lateness_in_us);
+    }
     all_alarms_.erase(cb);
     const int64_t new_timeout_time_in_us = cb->OnAlarm();
 
@@ -771,6 +823,84 @@ void SimpleEpollServer::CallAndReregisterAlarmEvents() {
     }
   }
   alarms_reregistered_and_should_be_skipped_.clear();
+  if (record_loop_stats) {
+    loop_stats_.alarm_time_in_us += NowInUsec() - alarms_start_in_us;
+  }
+}
+
+void SimpleEpollServer::RecordCallbackTime(const CB* cb, int fd,
+                                           int64_t elapsed_in_us) {
+  ++loop_stats_.callbacks_invoked;
+  loop_stats_.callback_time_in_us += elapsed_in_us;
+  if (slow_callback_threshold_in_us_ <= 0 ||
+      elapsed_in_us < slow_callback_threshold_in_us_) {
+    return;
+  }
+  ++loop_stats_.slow_callbacks;
+  // Name() returns a std::string, so only ask for it on the slow path.
+  std::string name = cb != NULL ? cb->Name() : "<unregistered>";
+  EPOLL_LOG(WARNING) << "Slow epoll callback " << name << " on fd " << fd
+                     << " took " << elapsed_in_us << "us";
+  if (elapsed_in_us > loop_stats_.slowest_callback_time_in_us) {
+    loop_stats_.slowest_callback_time_in_us = elapsed_in_us;
+    loop_stats_.slowest_callback_name = std::move(name);
+  }
+}
+
+void SimpleEpollServer::RecordIterationEnd(int64_t now_in_us) {
+  if (recorded_now_in_us_ != 0) {
+    loop_stats_.max_busy_time_per_iteration_in_us =
+        std::max(loop_stats_.max_busy_time_per_iteration_in_us,
+                 now_in_us - recorded_now_in_us_);
+  }
+  if (loop_stats_log_interval_in_us_ <= 0) {
+    return;
+  }
+  if (last_loop_stats_log_time_in_us_ == 0) {
+    last_loop_stats_log_time_in_us_ = now_in_us;
+    return;
+  }
+  if (now_in_us - last_loop_stats_log_time_in_us_ >=
+      loop_stats_log_interval_in_us_) {
+    last_loop_stats_log_time_in_us_ = now_in_us;
+    EPOLL_LOG(INFO) << "Epoll server " << this
+                    << " loop stats: " << loop_stats_.DebugString();
+  }
+}
+
+// static
+int SimpleEpollServer::LoopStats::AlarmLatenessBucket(int64_t lateness_in_us) {
+  int bucket = 0;
+  while (bucket < kNumAlarmLatenessBuckets - 1 &&
+         lateness_in_us >= kAlarmLatenessBucketBoundsInUs[bucket]) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+std::string SimpleEpollServer::LoopStats::DebugString() const {
+  std::string histogram;
+  for (int i = 0; i < kNumAlarmLatenessBuckets; ++i) {
+    if (i < kNumAlarmLatenessBuckets - 1) {
+      absl::StrAppend(&histogram, "<", kAlarmLatenessBucketBoundsInUs[i],
+                      "us:", alarm_lateness_histogram[i], " ");
+    } else {
+      absl::StrAppend(&histogram, ">=", kAlarmLatenessBucketBoundsInUs[i - 1],
+                      "us:", alarm_lateness_histogram[i]);
+    }
+  }
+  return absl::StrCat(
+      "{ iterations: ", iterations,
+      " epoll_wait_time_in_us: ", epoll_wait_time_in_us,
+      " callback_time_in_us: ", callback_time_in_us,
+      " alarm_time_in_us: ", alarm_time_in_us,
+      " max_busy_time_per_iteration_in_us: ", max_busy_time_per_iteration_in_us,
+      " callbacks_invoked: ", callbacks_invoked,
+      " alarms_fired: ", alarms_fired, " alarm_lateness: [", histogram, "]",
+      " max_alarm_lateness_in_us: ", max_alarm_lateness_in_us,
+      " slow_callbacks: ", slow_callbacks,
+      " slowest_callback: ", slowest_callback_name, " (",
+      slowest_callback_time_in_us, "us) }");
 }
 
 EpollAlarm::EpollAlarm() : eps_(NULL), registered_(false) {}
@@ -500,6 +500,80 @@ class SimpleEpollServer {
 
   int64_t LastDelayInUsec() const { return last_delay_in_usec_; }
 
+  // Summary:
+  //   Returns the time between the previous return from epoll_wait and the
+  //   latest call to it, i.e. how long the last complete iteration spent in
+  //   callbacks and alarms. Events which became ready during that time waited
+  //   up to this long. Unlike LoopStats, this is always tracked, as it needs no
+  //   extra clock reads.
+  int64_t LastBusyTimeInUsec() const { return last_busy_time_in_usec_; }
+
+  // Summary:
+  //   Counters describing where the event loop spends its time. They are only
+  //   updated while loop stats are enabled (see set_loop_stats_enabled()), so
+  //   that a disabled server pays a single branch per iteration and callback.
+  //   All durations are in microseconds as measured by NowInUsec().
+  struct LoopStats {
+    // Exclusive upper bounds of the alarm lateness histogram buckets. The
+    // final bucket of |alarm_lateness_histogram| counts everything larger.
+    static constexpr int kNumAlarmLatenessBuckets = 6;
+    static constexpr int64_t kAlarmLatenessBucketBoundsInUs
+        [kNumAlarmLatenessBuckets - 1] = {10, 100, 1000, 10000, 100000};
+
+    // Returns the histogram bucket |lateness_in_us| falls into.
+    static int AlarmLatenessBucket(int64_t lateness_in_us);
+
+    std::string DebugString() const;
+
+    // Number of calls to WaitForEventsAndExecuteCallbacks().
+    int64_t iterations = 0;
+    // Time spent blocked in epoll_wait_impl().
+    int64_t epoll_wait_time_in_us = 0;
+    // Time spent in EpollCallbackInterface::OnEvent(), including the ready
+    // list.
+    int64_t callback_time_in_us = 0;
+    // Time spent in EpollAlarmCallbackInterface::OnAlarm().
+    int64_t alarm_time_in_us = 0;
+    // Longest non-waiting portion (callbacks plus alarms) of one iteration.
+    int64_t max_busy_time_per_iteration_in_us = 0;
+    // Number of events delivered to callbacks, and alarms fired.
+    int64_t callbacks_invoked = 0;
+    int64_t alarms_fired = 0;
+    // How late alarms fired relative to their registered deadline.
+    int64_t alarm_lateness_histogram[kNumAlarmLatenessBuckets] = {};
+    int64_t max_alarm_lateness_in_us = 0;
+    // Callbacks whose OnEvent() took at least the slow callback threshold, and
+    // the Name() and duration of the slowest of them.
+    int64_t slow_callbacks = 0;
+    int64_t slowest_callback_time_in_us = 0;
+    std::string slowest_callback_name;
+  };
+
+  // Summary:
+  //   Enables or disables collection of LoopStats. Collection is off by
+  //   default because it adds clock reads to every iteration and callback.
+  void set_loop_stats_enabled(bool enabled) { loop_stats_enabled_ = enabled; }
+  bool loop_stats_enabled() const { return loop_stats_enabled_; }
+
+  // Summary:
+  //   Callbacks whose OnEvent() runs for at least this long are counted in
+  //   LoopStats::slow_callbacks and logged with their Name(). A non-positive
+  //   value disables the slow callback detector.
+  void set_slow_callback_threshold_in_us(int64_t threshold_in_us) {
+    slow_callback_threshold_in_us_ = threshold_in_us;
+  }
+
+  // Summary:
+  //   If positive, LoopStats::DebugString() is logged at INFO at most once per
+  //   interval while loop stats are enabled.
+  void set_loop_stats_log_interval_in_us(int64_t interval_in_us) {
+    loop_stats_log_interval_in_us_ = interval_in_us;
+  }
+
+  const LoopStats& loop_stats() const { return loop_stats_; }
+
+  void ResetLoopStats() { loop_stats_ = LoopStats(); }
+
  protected:
   virtual void SetNonblocking(int fd);
 
@@ -943,6 +1017,14 @@ class SimpleEpollServer {
   void CleanupFDToCBMap();
   void CleanupTimeToAlarmCBMap();
 
+  // Records the time spent in one OnEvent() call into loop_stats_ and reports
+  // the callback if it exceeded slow_callback_threshold_in_us_.
+  void RecordCallbackTime(const CB* cb, int fd, int64_t elapsed_in_us);
+
+  // Accounts for the busy time of the iteration which just completed at
+  // |now_in_us| and logs loop_stats_ if the log interval has passed.
+  void RecordIterationEnd(int64_t now_in_us);
+
   // The callback registered to the fds below.  As the purpose of their
   // registration is to wake the epoll server it just clears the pipe and
   // returns.
@@ -963,6 +1045,15 @@ class SimpleEpollServer {
   // Returns true when the SimpleEpollServer() is being destroyed.
   bool in_shutdown_;
   int64_t last_delay_in_usec_;
+  // Time at which epoll_wait last returned, and the busy time derived from it.
+  int64_t last_wakeup_time_in_us_;
+  int64_t last_busy_time_in_usec_;
+
+  LoopStats loop_stats_;
+  bool loop_stats_enabled_;
+  int64_t slow_callback_threshold_in_us_;
+  int64_t loop_stats_log_interval_in_us_;
+  int64_t last_loop_stats_log_time_in_us_;
 };
 
 class EpollAlarmCallbackInterface {
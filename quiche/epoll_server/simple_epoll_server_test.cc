@@ -2405,6 +2405,137 @@ TEST(EpollServerTest, TestLastDelay) {
   EXPECT_EQ(cb.last_delay, 0);
 }
 
+// A callback which takes a configurable amount of (fake) time in OnEvent().
+class SlowCB : public EpollCallbackInterface {
+ public:
+  SlowCB() : feps_(nullptr), time_(0) {}
+
+  void OnRegistration(SimpleEpollServer* /*eps*/, int /*fd*/,
+                      int /*event_mask*/) override {}
+  void OnModification(int /*fd*/, int /*event_mask*/) override {}
+  void OnEvent(int /*fd*/, EpollEvent* /*event*/) override {
+    feps_->AdvanceBy(time_);
+  }
+  void OnUnregistration(int /*fd*/, bool /*replaced*/) override {}
+  void OnShutdown(SimpleEpollServer* /*eps*/, int /*fd*/) override {}
+  std::string Name() const override { return "SlowCB"; }
+
+  void set_fakeepollserver(FakeSimpleEpollServer* feps) { feps_ = feps; }
+  void set_time(int64_t time) { time_ = time; }
+
+ private:
+  FakeSimpleEpollServer* feps_;
+  int64_t time_;
+};
+
+TEST(EpollServerTest, LastBusyTime) {
+  SlowCB cb;
+  FakeSimpleEpollServer epoll_server;
+  cb.set_fakeepollserver(&epoll_server);
+  cb.set_time(20000);
+  epoll_server.RegisterFD(0, &cb, EPOLLIN);
+  epoll_event ee;
+  ee.data.fd = 0;
+  ee.events = EPOLLIN;
+  epoll_server.AddEvent(0, ee);
+  epoll_server.AdvanceBy(1);
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+  // The busy time is only known once the next iteration starts waiting.
+  EXPECT_EQ(0, epoll_server.LastBusyTimeInUsec());
+
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(20000, epoll_server.LastBusyTimeInUsec());
+
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(0, epoll_server.LastBusyTimeInUsec());
+}
+
+TEST(EpollServerTest, LoopStatsDisabledByDefault) {
+  SlowCB cb;
+  FakeSimpleEpollServer epoll_server;
+  cb.set_fakeepollserver(&epoll_server);
+  cb.set_time(20000);
+  epoll_server.RegisterFD(0, &cb, EPOLLIN);
+  epoll_event ee;
+  ee.data.fd = 0;
+  ee.events = EPOLLIN;
+  epoll_server.AddEvent(0, ee);
+  epoll_server.AdvanceBy(1);
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+
+  EXPECT_FALSE(epoll_server.loop_stats_enabled());
+  EXPECT_EQ(0, epoll_server.loop_stats().iterations);
+  EXPECT_EQ(0, epoll_server.loop_stats().callbacks_invoked);
+  EXPECT_EQ(0, epoll_server.loop_stats().slow_callbacks);
+}
+
+TEST(EpollServerTest, LoopStatsRecordCallbackTimeAndSlowCallbacks) {
+  SlowCB fast_cb;
+  SlowCB slow_cb;
+  FakeSimpleEpollServer epoll_server;
+  epoll_server.set_loop_stats_enabled(true);
+  epoll_server.set_slow_callback_threshold_in_us(5000);
+  fast_cb.set_fakeepollserver(&epoll_server);
+  fast_cb.set_time(1000);
+  slow_cb.set_fakeepollserver(&epoll_server);
+  slow_cb.set_time(20000);
+  epoll_server.RegisterFD(0, &fast_cb, EPOLLIN);
+  epoll_server.RegisterFD(1, &slow_cb, EPOLLIN);
+
+  epoll_event ee;
+  ee.events = EPOLLIN;
+  ee.data.fd = 0;
+  epoll_server.AddEvent(0, ee);
+  ee.data.fd = 1;
+  epoll_server.AddEvent(0, ee);
+  epoll_server.AdvanceBy(1);
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+
+  const SimpleEpollServer::LoopStats& stats = epoll_server.loop_stats();
+  EXPECT_EQ(1, stats.iterations);
+  EXPECT_EQ(2, stats.callbacks_invoked);
+  EXPECT_EQ(21000, stats.callback_time_in_us);
+  EXPECT_EQ(21000, stats.max_busy_time_per_iteration_in_us);
+  EXPECT_EQ(1, stats.slow_callbacks);
+  EXPECT_EQ(20000, stats.slowest_callback_time_in_us);
+  EXPECT_EQ("SlowCB", stats.slowest_callback_name);
+
+  epoll_server.ResetLoopStats();
+  EXPECT_EQ(0, epoll_server.loop_stats().iterations);
+  EXPECT_TRUE(epoll_server.loop_stats().slowest_callback_name.empty());
+}
+
+TEST(EpollServerTest, LoopStatsRecordAlarmLateness) {
+  TestAlarm alarm;
+  FakeEpollServerWithDelay epoll_server;
+  epoll_server.set_loop_stats_enabled(true);
+  epoll_server.set_timeout_in_us(-1);
+  epoll_server.delay = 2000;
+
+  epoll_server.RegisterAlarm(epoll_server.NowInUsec() + 1000, &alarm);
+  epoll_server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_TRUE(alarm.was_called());
+
+  const SimpleEpollServer::LoopStats& stats = epoll_server.loop_stats();
+  EXPECT_EQ(1, stats.alarms_fired);
+  EXPECT_EQ(2000, stats.max_alarm_lateness_in_us);
+  EXPECT_EQ(3000, stats.epoll_wait_time_in_us);
+  EXPECT_EQ(1, stats.alarm_lateness_histogram
+                   [SimpleEpollServer::LoopStats::AlarmLatenessBucket(2000)]);
+}
+
+TEST(EpollServerTest, LoopStatsAlarmLatenessBuckets) {
+  using LoopStats = SimpleEpollServer::LoopStats;
+  EXPECT_EQ(0, LoopStats::AlarmLatenessBucket(0));
+  EXPECT_EQ(0, LoopStats::AlarmLatenessBucket(9));
+  EXPECT_EQ(1, LoopStats::AlarmLatenessBucket(10));
+  EXPECT_EQ(3, LoopStats::AlarmLatenessBucket(2000));
+  EXPECT_EQ(LoopStats::kNumAlarmLatenessBuckets - 1,
+            LoopStats::AlarmLatenessBucket(100000));
+  EXPECT_EQ(LoopStats::kNumAlarmLatenessBuckets - 1,
+            LoopStats::AlarmLatenessBucket(int64_t{1} << 40));
+}
+
 TEST(SimpleEpollServerAlarmTest, TestShutdown) {
   std::unique_ptr<SimpleEpollServer> eps(new SimpleEpollServer);
   EpollAlarm alarm1;
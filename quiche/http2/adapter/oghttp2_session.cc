@@ -34,6 +34,9 @@ const bool kTraceLoggingEnabled = false;
 const uint32_t kMaxAllowedMetadataFrameSize = 65536u;
 const uint32_t kDefaultHpackTableCapacity = 4096u;
 const uint32_t kMaximumHpackTableCapacity = 65536u;
+// The maximum number of PRIORITY_UPDATE values buffered for streams that have
+// not been opened yet.
+const size_t kMaxPendingPriorityUpdates = 100u;
 
 // Corresponds to NGHTTP2_ERR_CALLBACK_FAILURE.
 const int kSendError = -902;
@@ -255,6 +258,15 @@ void OgHttp2Session::PassthroughHeadersHandler::OnHeader(
     return;
   }
   result_ = visitor_.OnHeaderForStream(stream_id_, key, value);
+  if (result_ == Http2VisitorInterface::HEADER_OK &&
+      type_ == HeaderType::REQUEST && key == "priority" &&
+      session_.options_.enable_extensible_priorities) {
+    auto it = session_.stream_map_.find(stream_id_);
+    if (it != session_.stream_map_.end() &&
+        !it->second.received_priority_update) {
+      session_.UpdateStreamPriority(it->second, stream_id_, value);
+    }
+  }
 }
 
 void OgHttp2Session::PassthroughHeadersHandler::OnHeaderBlockEnd(
@@ -454,7 +466,10 @@ OgHttp2Session::ProcessBytesImpl(absl::string_view bytes) {
     return 0;
   }
   processing_bytes_ = true;
-  RunOnExit r{[this]() { processing_bytes_ = false; }};
+  RunOnExit r{[this]() {
+    processing_bytes_ = false;
+    ApplyDeferredConsumption();
+  }};
 
   if (options_.blackhole_data_on_connection_error && latched_error_) {
     return static_cast<int64_t>(bytes.size());
@@ -502,6 +517,23 @@ OgHttp2Session::ProcessBytesImpl(absl::string_view bytes) {
 }
 
 int OgHttp2Session::Consume(Http2StreamId stream_id, size_t num_bytes) {
+  if (options_.batch_window_updates && processing_bytes_) {
+    if (!stream_map_.contains(stream_id)) {
+      QUICHE_LOG(ERROR) << "Stream " << stream_id
+                        << " not found when consuming " << num_bytes
+                        << " bytes";
+    }
+    // Streams closed before ProcessBytes() returns still count against the
+    // connection window.
+    deferred_consumed_bytes_[stream_id] += num_bytes;
+    return 0;
+  }
+  MarkDataConsumed(stream_id, num_bytes);
+  return 0;  // Remove?
+}
+
+void OgHttp2Session::MarkDataConsumed(Http2StreamId stream_id,
+                                      size_t num_bytes) {
   auto it = stream_map_.find(stream_id);
   if (it == stream_map_.end()) {
     QUICHE_LOG(ERROR) << "Stream " << stream_id << " not found when consuming "
@@ -510,7 +542,22 @@ int OgHttp2Session::Consume(Http2StreamId stream_id, size_t num_bytes) {
     it->second.window_manager.MarkDataFlushed(num_bytes);
   }
   connection_window_manager_.MarkDataFlushed(num_bytes);
-  return 0;  // Remove?
+}
+
+void OgHttp2Session::ApplyDeferredConsumption() {
+  if (deferred_consumed_bytes_.empty()) {
+    return;
+  }
+  size_t connection_bytes = 0;
+  for (const auto& [stream_id, num_bytes] : deferred_consumed_bytes_) {
+    auto it = stream_map_.find(stream_id);
+    if (it != stream_map_.end()) {
+      it->second.window_manager.MarkDataFlushed(num_bytes);
+    }
+    connection_bytes += num_bytes;
+  }
+  deferred_consumed_bytes_.clear();
+  connection_window_manager_.MarkDataFlushed(connection_bytes);
 }
 
 void OgHttp2Session::StartGracefulShutdown() {
@@ -546,8 +593,12 @@ void OgHttp2Session::EnqueueFrame(std::unique_ptr<spdy::SpdyFrameIR> frame) {
       iter->second.half_closed_local = true;
     }
     if (frame->frame_type() == spdy::SpdyFrameType::RST_STREAM) {
-      // TODO(diannahu): Condition on existence in the stream map?
-      streams_reset_.insert(frame->stream_id());
+      if (iter != stream_map_.end()) {
+        iter->second.reset = true;
+      } else {
+        // TODO(diannahu): Condition on existence in the stream map?
+        streams_reset_without_state_.insert(frame->stream_id());
+      }
     }
   } else if (frame->frame_type() == spdy::SpdyFrameType::WINDOW_UPDATE) {
     UpdateReceiveWindow(
@@ -558,9 +609,9 @@ void OgHttp2Session::EnqueueFrame(std::unique_ptr<spdy::SpdyFrameIR> frame) {
         *reinterpret_cast<spdy::SpdySettingsIR*>(frame.get()));
   }
   if (frame->stream_id() != 0) {
-    auto result = queued_frames_.insert({frame->stream_id(), 1});
-    if (!result.second) {
-      ++(result.first->second);
+    auto iter = stream_map_.find(frame->stream_id());
+    if (iter != stream_map_.end()) {
+      ++iter->second.queued_frames;
     }
   }
   frames_.push_back(std::move(frame));
@@ -618,20 +669,20 @@ int OgHttp2Session::InterpretSendResult(SendResult result) {
 }
 
 bool OgHttp2Session::HasReadyStream() const {
-  return !metadata_ready_.empty() || !trailers_ready_.empty() ||
+  return metadata_ready_.num_ready > 0 || trailers_ready_.num_ready > 0 ||
          (write_scheduler_.HasReadyStreams() && connection_send_window_ > 0);
 }
 
 Http2StreamId OgHttp2Session::GetNextReadyStream() {
   QUICHE_DCHECK(HasReadyStream());
-  if (!metadata_ready_.empty()) {
-    const Http2StreamId stream_id = *metadata_ready_.begin();
+  if (metadata_ready_.num_ready > 0) {
+    const Http2StreamId stream_id = FrontReadyStream(metadata_ready_);
     // WriteForStream() will re-mark the stream as ready, if necessary.
     write_scheduler_.MarkStreamNotReady(stream_id);
     return stream_id;
   }
-  if (!trailers_ready_.empty()) {
-    const Http2StreamId stream_id = *trailers_ready_.begin();
+  if (trailers_ready_.num_ready > 0) {
+    const Http2StreamId stream_id = FrontReadyStream(trailers_ready_);
     // WriteForStream() will re-mark the stream as ready, if necessary.
     write_scheduler_.MarkStreamNotReady(stream_id);
     return stream_id;
@@ -639,6 +690,44 @@ Http2StreamId OgHttp2Session::GetNextReadyStream() {
   return write_scheduler_.PopNextReadyStream();
 }
 
+void OgHttp2Session::MarkReady(ReadyStreamList& list, Http2StreamId stream_id,
+                               StreamState& state) {
+  if (!(state.*list.flag)) {
+    state.*list.flag = true;
+    ++list.num_ready;
+    list.stream_ids.push_back(stream_id);
+  }
+}
+
+void OgHttp2Session::MarkNotReady(ReadyStreamList& list, StreamState& state) {
+  if (state.*list.flag) {
+    state.*list.flag = false;
+    --list.num_ready;
+  }
+}
+
+Http2StreamId OgHttp2Session::FrontReadyStream(ReadyStreamList& list) {
+  while (!list.stream_ids.empty()) {
+    const Http2StreamId stream_id = list.stream_ids.front();
+    auto it = stream_map_.find(stream_id);
+    if (it != stream_map_.end() && it->second.*list.flag) {
+      return stream_id;
+    }
+    list.stream_ids.pop_front();
+  }
+  QUICHE_BUG(oghttp2_no_ready_stream)
+      << "No ready stream among " << list.num_ready << " ready streams.";
+  return 0;
+}
+
+bool OgHttp2Session::IsStreamReset(Http2StreamId stream_id) const {
+  auto it = stream_map_.find(stream_id);
+  if (it != stream_map_.end()) {
+    return it->second.reset;
+  }
+  return streams_reset_without_state_.contains(stream_id);
+}
+
 OgHttp2Session::SendResult OgHttp2Session::MaybeSendBufferedData() {
   int64_t result = std::numeric_limits<int64_t>::max();
   while (result > 0 && !buffered_data_.empty()) {
@@ -672,7 +761,7 @@ OgHttp2Session::SendResult OgHttp2Session::SendQueuedFrames() {
     QUICHE_DCHECK_NE(c.frame_type(), 0);
 
     const bool stream_reset =
-        c.stream_id() != 0 && streams_reset_.count(c.stream_id()) > 0;
+        c.stream_id() != 0 && IsStreamReset(c.stream_id());
     if (stream_reset &&
         c.frame_type() != static_cast<uint8_t>(FrameType::RST_STREAM)) {
       // The stream has been reset, so any other remaining frames can be
@@ -760,10 +849,7 @@ bool OgHttp2Session::AfterFrameSent(uint8_t frame_type_int, uint32_t stream_id,
     // send a RST_STREAM NO_ERROR. See RFC 7540 Section 8.1.
     frames_.push_front(absl::make_unique<spdy::SpdyRstStreamIR>(
         stream_id, spdy::SpdyErrorCode::ERROR_CODE_NO_ERROR));
-    auto queued_result = queued_frames_.insert({stream_id, 1});
-    if (!queued_result.second) {
-      ++(queued_result.first->second);
-    }
+    ++it->second.queued_frames;
     it->second.half_closed_remote = true;
   }
 
@@ -780,8 +866,7 @@ OgHttp2Session::SendResult OgHttp2Session::WriteForStream(
     return SendResult::SEND_OK;
   }
   StreamState& state = it->second;
-  auto reset_it = streams_reset_.find(stream_id);
-  if (reset_it != streams_reset_.end()) {
+  if (state.reset) {
     // The stream has been reset; there's no point in sending DATA or trailing
     // HEADERS.
     state.outbound_body = nullptr;
@@ -811,9 +896,13 @@ OgHttp2Session::SendResult OgHttp2Session::WriteForStream(
     }
     return SendResult::SEND_OK;
   }
-  int32_t available_window =
-      std::min({connection_send_window_, state.send_window,
-                static_cast<int32_t>(max_frame_payload_)});
+  // The number of bytes the stream may write before yielding to other streams.
+  int64_t remaining_quantum = std::max<int64_t>(
+      1, options_.stream_write_quantum.value_or(
+             std::numeric_limits<int32_t>::max()));
+  int32_t available_window = static_cast<int32_t>(
+      std::min<int64_t>({connection_send_window_, state.send_window,
+                         max_frame_payload_, remaining_quantum}));
   while (connection_can_write == SendResult::SEND_OK && available_window > 0 &&
          state.outbound_body != nullptr && !state.data_deferred) {
     auto [length, end_data] =
@@ -851,8 +940,10 @@ OgHttp2Session::SendResult OgHttp2Session::WriteForStream(
       }
       connection_send_window_ -= length;
       state.send_window -= length;
-      available_window = std::min({connection_send_window_, state.send_window,
-                                   static_cast<int32_t>(max_frame_payload_)});
+      remaining_quantum -= length;
+      available_window = static_cast<int32_t>(
+          std::min<int64_t>({connection_send_window_, state.send_window,
+                             max_frame_payload_, remaining_quantum}));
       if (fin) {
         state.half_closed_local = true;
         MaybeFinWithRstStream(it);
@@ -886,10 +977,13 @@ OgHttp2Session::SendResult OgHttp2Session::WriteForStream(
     }
   }
   // If the stream still exists and has data to send, it should be marked as
-  // ready in the write scheduler.
+  // ready in the write scheduler. A non-incremental stream resumes ahead of the
+  // other streams of its urgency.
   if (stream_map_.contains(stream_id) && !state.data_deferred &&
       state.send_window > 0 && state.outbound_body != nullptr) {
-    write_scheduler_.MarkStreamReady(stream_id, false);
+    const bool add_to_front =
+        options_.enable_extensible_priorities && !state.incremental;
+    write_scheduler_.MarkStreamReady(stream_id, add_to_front);
   }
   // Streams can continue writing as long as the connection is not write-blocked
   // and there is additional flow control quota available.
@@ -922,7 +1016,9 @@ OgHttp2Session::SendResult OgHttp2Session::SendMetadata(
         std::string(payload)));
     if (end_metadata) {
       sequence.erase(sequence.begin());
-      metadata_ready_.erase(stream_id);
+      if (auto it = stream_map_.find(stream_id); it != stream_map_.end()) {
+        MarkNotReady(metadata_ready_, it->second);
+      }
     }
   }
   return SendQueuedFrames();
@@ -995,7 +1091,7 @@ int OgHttp2Session::SubmitTrailer(Http2StreamId stream_id,
     state.trailers =
         absl::make_unique<spdy::SpdyHeaderBlock>(ToHeaderBlock(trailers));
     if (!options_.trailers_require_end_data || !iter->second.data_deferred) {
-      trailers_ready_.insert(stream_id);
+      MarkReady(trailers_ready_, stream_id, state);
     }
   }
   return 0;
@@ -1008,7 +1104,7 @@ void OgHttp2Session::SubmitMetadata(Http2StreamId stream_id,
   } else {
     auto iter = CreateStream(stream_id);
     iter->second.outbound_metadata.push_back(std::move(source));
-    metadata_ready_.insert(stream_id);
+    MarkReady(metadata_ready_, stream_id, iter->second);
   }
 }
 
@@ -1030,7 +1126,7 @@ void OgHttp2Session::OnCommonHeader(spdy::SpdyStreamId stream_id, size_t length,
                                     uint8_t type, uint8_t flags) {
   highest_received_stream_id_ = std::max(static_cast<Http2StreamId>(stream_id),
                                          highest_received_stream_id_);
-  if (streams_reset_.contains(stream_id)) {
+  if (IsStreamReset(stream_id)) {
     return;
   }
   const bool result = visitor_.OnFrameHeader(stream_id, length, type, flags);
@@ -1043,7 +1139,7 @@ void OgHttp2Session::OnCommonHeader(spdy::SpdyStreamId stream_id, size_t length,
 void OgHttp2Session::OnDataFrameHeader(spdy::SpdyStreamId stream_id,
                                        size_t length, bool /*fin*/) {
   auto iter = stream_map_.find(stream_id);
-  if (iter == stream_map_.end() || streams_reset_.contains(stream_id)) {
+  if (iter == stream_map_.end() || iter->second.reset) {
     // The stream does not exist; it could be an error or a benign close, e.g.,
     // getting data for a stream this connection recently closed.
     if (static_cast<Http2StreamId>(stream_id) > highest_processed_stream_id_) {
@@ -1099,7 +1195,8 @@ void OgHttp2Session::OnStreamFrameData(spdy::SpdyStreamId stream_id,
   // Count the data against flow control, even if the stream is unknown.
   MarkDataBuffered(stream_id, len);
 
-  if (!stream_map_.contains(stream_id) || streams_reset_.contains(stream_id)) {
+  auto iter = stream_map_.find(stream_id);
+  if (iter == stream_map_.end() || iter->second.reset) {
     // If the stream was unknown due to a protocol error, the visitor was
     // informed in OnDataFrameHeader().
     return;
@@ -1117,7 +1214,7 @@ void OgHttp2Session::OnStreamEnd(spdy::SpdyStreamId stream_id) {
   auto iter = stream_map_.find(stream_id);
   if (iter != stream_map_.end()) {
     iter->second.half_closed_remote = true;
-    if (streams_reset_.contains(stream_id)) {
+    if (iter->second.reset) {
       return;
     }
 
@@ -1131,11 +1228,8 @@ void OgHttp2Session::OnStreamEnd(spdy::SpdyStreamId stream_id) {
     visitor_.OnEndStream(stream_id);
   }
 
-  auto queued_frames_iter = queued_frames_.find(stream_id);
-  const bool no_queued_frames = queued_frames_iter == queued_frames_.end() ||
-                                queued_frames_iter->second == 0;
   if (iter != stream_map_.end() && iter->second.half_closed_local &&
-      !IsServerSession() && no_queued_frames) {
+      !IsServerSession() && iter->second.queued_frames == 0) {
     // From the client's perspective, the stream can be closed if it's already
     // half_closed_local.
     CloseStream(stream_id, Http2ErrorCode::HTTP2_NO_ERROR);
@@ -1161,7 +1255,7 @@ void OgHttp2Session::OnStreamPadding(spdy::SpdyStreamId /*stream_id*/, size_t
 spdy::SpdyHeadersHandlerInterface* OgHttp2Session::OnHeaderFrameStart(
     spdy::SpdyStreamId stream_id) {
   auto it = stream_map_.find(stream_id);
-  if (it != stream_map_.end() && !streams_reset_.contains(stream_id)) {
+  if (it != stream_map_.end() && !it->second.reset) {
     headers_handler_.set_stream_id(stream_id);
     headers_handler_.set_header_type(
         NextHeaderType(it->second.received_header_type));
@@ -1206,7 +1300,7 @@ void OgHttp2Session::OnRstStream(spdy::SpdyStreamId stream_id,
                         ConnectionError::kWrongFrameSequence);
     return;
   }
-  if (streams_reset_.contains(stream_id)) {
+  if (IsStreamReset(stream_id)) {
     return;
   }
   visitor_.OnRstStream(stream_id, TranslateErrorCode(error_code));
@@ -1418,7 +1512,7 @@ void OgHttp2Session::OnWindowUpdate(spdy::SpdyStreamId stream_id,
       // Do not inform the visitor of a WINDOW_UPDATE for a non-existent stream.
       return;
     } else {
-      if (streams_reset_.contains(stream_id)) {
+      if (it->second.reset) {
         return;
       }
       if (it->second.send_window == 0) {
@@ -1453,9 +1547,47 @@ void OgHttp2Session::OnPriority(spdy::SpdyStreamId /*stream_id*/,
                                 spdy::SpdyStreamId /*parent_stream_id*/,
                                 int /*weight*/, bool /*exclusive*/) {}
 
-void OgHttp2Session::OnPriorityUpdate(
-    spdy::SpdyStreamId /*prioritized_stream_id*/,
-    absl::string_view /*priority_field_value*/) {}
+void OgHttp2Session::OnPriorityUpdate(spdy::SpdyStreamId prioritized_stream_id,
+                                      absl::string_view priority_field_value) {
+  if (!options_.enable_extensible_priorities || !IsServerSession()) {
+    return;
+  }
+  auto it = stream_map_.find(prioritized_stream_id);
+  if (it != stream_map_.end()) {
+    it->second.received_priority_update = true;
+    UpdateStreamPriority(it->second, prioritized_stream_id,
+                         priority_field_value);
+    return;
+  }
+  if (prioritized_stream_id % 2 == 0 ||
+      static_cast<Http2StreamId>(prioritized_stream_id) <=
+          highest_processed_stream_id_) {
+    // The stream is closed, or can never be opened by the client.
+    return;
+  }
+  absl::optional<StreamPriority> priority =
+      ParsePriorityFieldValue(priority_field_value);
+  if (!priority.has_value()) {
+    QUICHE_VLOG(1) << "Ignoring malformed priority for stream "
+                   << prioritized_stream_id << ": " << priority_field_value;
+    return;
+  }
+  if (pending_priority_updates_.size() >= kMaxPendingPriorityUpdates) {
+    // Drop the values for streams that were never opened.
+    for (auto it = pending_priority_updates_.begin();
+         it != pending_priority_updates_.end();) {
+      if (it->first <= highest_processed_stream_id_) {
+        pending_priority_updates_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (pending_priority_updates_.size() < kMaxPendingPriorityUpdates ||
+      pending_priority_updates_.contains(prioritized_stream_id)) {
+    pending_priority_updates_[prioritized_stream_id] = *priority;
+  }
+}
 
 bool OgHttp2Session::OnUnknownFrame(spdy::SpdyStreamId /*stream_id*/,
                                     uint8_t /*frame_type*/) {
@@ -1482,8 +1614,7 @@ void OgHttp2Session::OnHeaderStatus(
          result == Http2VisitorInterface::HEADER_FIELD_INVALID)
             ? Http2VisitorInterface::InvalidFrameError::kHttpHeader
             : Http2VisitorInterface::InvalidFrameError::kHttpMessaging;
-    auto it = streams_reset_.find(stream_id);
-    if (it == streams_reset_.end()) {
+    if (!IsStreamReset(stream_id)) {
       EnqueueFrame(
           absl::make_unique<spdy::SpdyRstStreamIR>(stream_id, spdy_error_code));
 
@@ -1508,7 +1639,7 @@ void OgHttp2Session::OnHeaderStatus(
 
 bool OgHttp2Session::OnFrameHeader(spdy::SpdyStreamId stream_id, size_t length,
                                    uint8_t type, uint8_t flags) {
-  if (streams_reset_.contains(stream_id)) {
+  if (IsStreamReset(stream_id)) {
     return false;
   }
   if (type == kMetadataFrameType) {
@@ -1531,7 +1662,7 @@ bool OgHttp2Session::OnFrameHeader(spdy::SpdyStreamId stream_id, size_t length,
 }
 
 void OgHttp2Session::OnFramePayload(const char* data, size_t len) {
-  if (streams_reset_.contains(metadata_stream_id_)) {
+  if (IsStreamReset(metadata_stream_id_)) {
     return;
   }
   if (metadata_length_ > 0) {
@@ -1650,6 +1781,20 @@ void OgHttp2Session::HandleOutboundSettings(
       });
 }
 
+bool OgHttp2Session::StreamWindowUpdateListener::ShouldWindowUpdate(
+    int64_t limit, int64_t size, int64_t delta) {
+  if (!session_.options_.should_window_update_fn) {
+    return WindowManager::SharedListener::ShouldWindowUpdate(limit, size,
+                                                             delta);
+  }
+  return session_.options_.should_window_update_fn(limit, size, delta);
+}
+
+void OgHttp2Session::StreamWindowUpdateListener::OnWindowUpdate(
+    uint32_t stream_id, int64_t delta) {
+  session_.SendWindowUpdate(stream_id, delta);
+}
+
 void OgHttp2Session::SendWindowUpdate(Http2StreamId stream_id,
                                       size_t update_delta) {
   EnqueueFrame(
@@ -1671,7 +1816,9 @@ void OgHttp2Session::SendTrailers(Http2StreamId stream_id,
       absl::make_unique<spdy::SpdyHeadersIR>(stream_id, std::move(trailers));
   frame->set_fin(true);
   EnqueueFrame(std::move(frame));
-  trailers_ready_.erase(stream_id);
+  if (auto it = stream_map_.find(stream_id); it != stream_map_.end()) {
+    MarkNotReady(trailers_ready_, it->second);
+  }
 }
 
 void OgHttp2Session::MaybeFinWithRstStream(StreamStateMap::iterator iter) {
@@ -1696,18 +1843,24 @@ void OgHttp2Session::MarkDataBuffered(Http2StreamId stream_id, size_t bytes) {
 
 OgHttp2Session::StreamStateMap::iterator OgHttp2Session::CreateStream(
     Http2StreamId stream_id) {
-  WindowManager::WindowUpdateListener listener =
-      [this, stream_id](size_t window_update_delta) {
-        SendWindowUpdate(stream_id, window_update_delta);
-      };
   auto [iter, inserted] = stream_map_.try_emplace(
-      stream_id,
-      StreamState(initial_stream_receive_window_, initial_stream_send_window_,
-                  std::move(listener), options_.should_window_update_fn));
+      stream_id, stream_id, initial_stream_receive_window_,
+      initial_stream_send_window_, &stream_window_update_listener_);
   if (inserted) {
+    if (streams_reset_without_state_.erase(stream_id) > 0) {
+      iter->second.reset = true;
+    }
+
     // Add the stream to the write scheduler.
-    const WriteScheduler::StreamPrecedenceType precedence(3);
+    const WriteScheduler::StreamPrecedenceType precedence(
+        StreamPriority::kDefaultUrgency);
     write_scheduler_.RegisterStream(stream_id, precedence);
+    auto pending_priority = pending_priority_updates_.find(stream_id);
+    if (pending_priority != pending_priority_updates_.end()) {
+      iter->second.received_priority_update = true;
+      ApplyStreamPriority(iter->second, stream_id, pending_priority->second);
+      pending_priority_updates_.erase(pending_priority);
+    }
 
     highest_processed_stream_id_ =
         std::max(highest_processed_stream_id_, stream_id);
@@ -1715,6 +1868,28 @@ OgHttp2Session::StreamStateMap::iterator OgHttp2Session::CreateStream(
   return iter;
 }
 
+void OgHttp2Session::UpdateStreamPriority(
+    StreamState& state, Http2StreamId stream_id,
+    absl::string_view priority_field_value) {
+  absl::optional<StreamPriority> priority =
+      ParsePriorityFieldValue(priority_field_value);
+  if (!priority.has_value()) {
+    QUICHE_VLOG(1) << "Ignoring malformed priority for stream " << stream_id
+                   << ": " << priority_field_value;
+    return;
+  }
+  ApplyStreamPriority(state, stream_id, *priority);
+}
+
+void OgHttp2Session::ApplyStreamPriority(StreamState& state,
+                                         Http2StreamId stream_id,
+                                         const StreamPriority& priority) {
+  state.incremental = priority.incremental;
+  write_scheduler_.UpdateStreamPrecedence(
+      stream_id, WriteScheduler::StreamPrecedenceType(
+                     static_cast<spdy::SpdyPriority>(priority.urgency)));
+}
+
 void OgHttp2Session::StartRequest(Http2StreamId stream_id,
                                   spdy::SpdyHeaderBlock headers,
                                   std::unique_ptr<DataFrameSource> data_source,
@@ -1726,6 +1901,12 @@ void OgHttp2Session::StartRequest(Http2StreamId stream_id,
   }
 
   auto iter = CreateStream(stream_id);
+  if (options_.enable_extensible_priorities) {
+    auto priority = headers.find("priority");
+    if (priority != headers.end()) {
+      UpdateStreamPriority(iter->second, stream_id, priority->second);
+    }
+  }
   const bool end_stream = data_source == nullptr;
   if (!end_stream) {
     iter->second.outbound_body = std::move(data_source);
@@ -1752,11 +1933,12 @@ void OgHttp2Session::CloseStream(Http2StreamId stream_id,
     latched_error_ = true;
     decoder_.StopProcessing();
   }
-  stream_map_.erase(stream_id);
-  trailers_ready_.erase(stream_id);
-  metadata_ready_.erase(stream_id);
-  streams_reset_.erase(stream_id);
-  queued_frames_.erase(stream_id);
+  if (auto it = stream_map_.find(stream_id); it != stream_map_.end()) {
+    MarkNotReady(trailers_ready_, it->second);
+    MarkNotReady(metadata_ready_, it->second);
+    stream_map_.erase(it);
+  }
+  streams_reset_without_state_.erase(stream_id);
   if (write_scheduler_.StreamRegistered(stream_id)) {
     write_scheduler_.UnregisterStream(stream_id);
   }
@@ -1866,16 +2048,16 @@ void OgHttp2Session::MaybeHandleMetadataEndForStream(Http2StreamId stream_id) {
 
 void OgHttp2Session::DecrementQueuedFrameCount(uint32_t stream_id,
                                                uint8_t frame_type) {
-  auto iter = queued_frames_.find(stream_id);
-  if (iter == queued_frames_.end()) {
-    QUICHE_LOG(ERROR) << "Unable to find a queued frame count for stream "
-                      << stream_id;
+  auto iter = stream_map_.find(stream_id);
+  if (iter == stream_map_.end()) {
+    // Frames queued for streams without a StreamState are not counted.
     return;
   }
-  if (static_cast<FrameType>(frame_type) != FrameType::DATA) {
-    --iter->second;
+  if (static_cast<FrameType>(frame_type) != FrameType::DATA &&
+      iter->second.queued_frames > 0) {
+    --iter->second.queued_frames;
   }
-  if (iter->second == 0) {
+  if (iter->second.queued_frames == 0) {
     // TODO(birenroy): Consider passing through `error_code` here.
     CloseStreamIfReady(frame_type, stream_id);
   }
@@ -17,11 +17,13 @@
 #include "quiche/http2/adapter/http2_session.h"
 #include "quiche/http2/adapter/http2_util.h"
 #include "quiche/http2/adapter/http2_visitor_interface.h"
+#include "quiche/http2/adapter/oghttp2_util.h"
 #include "quiche/http2/adapter/window_manager.h"
 #include "quiche/http2/core/http2_trace_logging.h"
 #include "quiche/http2/core/priority_write_scheduler.h"
 #include "quiche/common/platform/api/quiche_bug_tracker.h"
 #include "quiche/common/platform/api/quiche_export.h"
+#include "quiche/common/quiche_circular_deque.h"
 #include "quiche/common/quiche_linked_hash_map.h"
 #include "quiche/spdy/core/http2_frame_decoder_adapter.h"
 #include "quiche/spdy/core/no_op_headers_handler.h"
@@ -71,6 +73,21 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
     // Whether to allow `obs-text` (characters from hexadecimal 0x80 to 0xff) in
     // header field values.
     bool allow_obs_text = true;
+    // Whether to schedule stream writes by the urgency and incremental
+    // parameters of RFC 9218, as signaled in `priority` request header fields
+    // and, for servers, PRIORITY_UPDATE frames. If false, all streams are
+    // written with the default urgency.
+    bool enable_extensible_priorities = false;
+    // If set, the maximum number of DATA payload bytes that a stream writes
+    // before the write scheduler picks the next stream to write. Bounds the
+    // time that a bulk transfer can delay a more urgent stream. Must be
+    // positive.
+    absl::optional<uint32_t> stream_write_quantum = absl::nullopt;
+    // Whether to defer the flow control accounting for data consumed while
+    // processing bytes until ProcessBytes() returns. If true, consuming the
+    // DATA frames of a stream one at a time from visitor callbacks results in
+    // at most one WINDOW_UPDATE per stream for each call to ProcessBytes().
+    bool batch_window_updates = false;
   };
 
   OgHttp2Session(Http2VisitorInterface& visitor, Options options);
@@ -212,12 +229,11 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
   using MetadataSequence = std::vector<std::unique_ptr<MetadataSource>>;
 
   struct QUICHE_EXPORT_PRIVATE StreamState {
-    StreamState(int32_t stream_receive_window, int32_t stream_send_window,
-                WindowManager::WindowUpdateListener listener,
-                WindowManager::ShouldWindowUpdateFn should_window_update_fn)
-        : window_manager(stream_receive_window, std::move(listener),
-                         std::move(should_window_update_fn),
-                         /*update_window_on_notify=*/false),
+    StreamState(Http2StreamId stream_id, int32_t stream_receive_window,
+                int32_t stream_send_window,
+                WindowManager::SharedListener* window_update_listener)
+        : window_manager(stream_receive_window, window_update_listener,
+                         stream_id, /*update_window_on_notify=*/false),
           send_window(stream_send_window) {}
 
     WindowManager window_manager;
@@ -230,12 +246,53 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
     absl::optional<size_t> remaining_content_length;
     bool half_closed_local = false;
     bool half_closed_remote = false;
+    // The number of frames other than DATA currently queued for the stream.
+    int queued_frames = 0;
     // Indicates that `outbound_body` temporarily cannot produce data.
     bool data_deferred = false;
     bool can_receive_body = true;
+    // Indicates that the stream has been marked for reset.
+    bool reset = false;
+    // Indicates that the stream is ready to write trailers.
+    bool trailers_ready = false;
+    // Indicates that the stream is ready to write metadata.
+    bool metadata_ready = false;
+    // Whether the stream is written incrementally, i.e., interleaved with other
+    // streams of the same urgency, or in full before them.
+    bool incremental = false;
+    // Indicates that a PRIORITY_UPDATE has been received for the stream, which
+    // takes precedence over its `priority` header field.
+    bool received_priority_update = false;
   };
   using StreamStateMap = absl::flat_hash_map<Http2StreamId, StreamState>;
 
+  // Streams with `flag` set in their StreamState, in the order in which it was
+  // set. Entries of streams that have since been closed or have cleared the
+  // flag are only dropped when they reach the front.
+  struct QUICHE_EXPORT_PRIVATE ReadyStreamList {
+    explicit ReadyStreamList(bool StreamState::*flag) : flag(flag) {}
+
+    bool StreamState::*const flag;
+    quiche::QuicheCircularDeque<Http2StreamId> stream_ids;
+    // The number of streams with `flag` set.
+    size_t num_ready = 0;
+  };
+
+  // Sends WINDOW_UPDATEs on behalf of the stream receive windows.
+  class QUICHE_EXPORT_PRIVATE StreamWindowUpdateListener
+      : public WindowManager::SharedListener {
+   public:
+    explicit StreamWindowUpdateListener(OgHttp2Session& session)
+        : session_(session) {}
+
+    bool ShouldWindowUpdate(int64_t limit, int64_t size,
+                            int64_t delta) override;
+    void OnWindowUpdate(uint32_t stream_id, int64_t delta) override;
+
+   private:
+    OgHttp2Session& session_;
+  };
+
   struct QUICHE_EXPORT_PRIVATE PendingStreamState {
     spdy::SpdyHeaderBlock headers;
     std::unique_ptr<DataFrameSource> data_source;
@@ -341,6 +398,19 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
   // Returns true if at least one stream has data or control frames to write.
   bool HasReadyStream() const;
 
+  // Sets the flag of `list` for the stream, adding it to `list` if needed.
+  void MarkReady(ReadyStreamList& list, Http2StreamId stream_id,
+                 StreamState& state);
+
+  // Clears the flag of `list` for the stream.
+  void MarkNotReady(ReadyStreamList& list, StreamState& state);
+
+  // Returns the oldest stream in `list` that still has its flag set, or zero.
+  Http2StreamId FrontReadyStream(ReadyStreamList& list);
+
+  // Returns true if the stream has been marked for reset.
+  bool IsStreamReset(Http2StreamId stream_id) const;
+
   // Returns the next stream that has something to write. If there are no such
   // streams, returns zero.
   Http2StreamId GetNextReadyStream();
@@ -377,6 +447,21 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
   // iterator pointing to it.
   StreamStateMap::iterator CreateStream(Http2StreamId stream_id);
 
+  // Performs flow control accounting for data consumed by the application.
+  void MarkDataConsumed(Http2StreamId stream_id, size_t num_bytes);
+
+  // Applies the consumption deferred while processing bytes.
+  void ApplyDeferredConsumption();
+
+  // Applies the RFC 9218 `priority_field_value` to the write scheduling of
+  // `stream_id`. Malformed values are ignored.
+  void UpdateStreamPriority(StreamState& state, Http2StreamId stream_id,
+                            absl::string_view priority_field_value);
+
+  // Applies the parsed `priority` to the write scheduling of `stream_id`.
+  void ApplyStreamPriority(StreamState& state, Http2StreamId stream_id,
+                           const StreamPriority& priority);
+
   // Creates a stream for `stream_id`, stores the `data_source` and `user_data`
   // in the stream state, and sends the `headers`.
   void StartRequest(Http2StreamId stream_id, spdy::SpdyHeaderBlock headers,
@@ -479,19 +564,28 @@ class QUICHE_EXPORT_PRIVATE OgHttp2Session
 
   WindowManager connection_window_manager_;
 
-  // Tracks the streams that have been marked for reset. A stream is removed
-  // from this set once it is closed.
-  absl::flat_hash_set<Http2StreamId> streams_reset_;
+  // Receives window updates from the stream window managers.
+  StreamWindowUpdateListener stream_window_update_listener_{*this};
+
+  // Tracks the streams without a StreamState that have been marked for reset,
+  // e.g., refused streams. Other streams track this in StreamState::reset.
+  absl::flat_hash_set<Http2StreamId> streams_reset_without_state_;
 
-  // The number of frames currently queued per stream.
-  absl::flat_hash_map<Http2StreamId, int> queued_frames_;
   // Includes streams that are currently ready to write trailers.
-  absl::flat_hash_set<Http2StreamId> trailers_ready_;
+  ReadyStreamList trailers_ready_{&StreamState::trailers_ready};
   // Includes streams that are currently ready to write metadata.
-  absl::flat_hash_set<Http2StreamId> metadata_ready_;
+  ReadyStreamList metadata_ready_{&StreamState::metadata_ready};
   // Includes streams that will not be written due to receipt of GOAWAY.
   absl::flat_hash_set<Http2StreamId> goaway_rejected_streams_;
 
+  // Priorities parsed from PRIORITY_UPDATE frames received for streams the peer
+  // has not opened yet, applied when the stream is created.
+  absl::flat_hash_map<Http2StreamId, StreamPriority> pending_priority_updates_;
+
+  // The bytes consumed per stream while processing bytes, if
+  // `options_.batch_window_updates` is set.
+  absl::flat_hash_map<Http2StreamId, size_t> deferred_consumed_bytes_;
+
   MetadataSequence connection_metadata_;
 
   Http2StreamId next_stream_id_ = 1;
@@ -1,5 +1,8 @@
 #include "quiche/http2/adapter/oghttp2_session.h"
 
+#include <string>
+#include <vector>
+
 #include "quiche/http2/adapter/mock_http2_visitor.h"
 #include "quiche/http2/adapter/test_frame_sequence.h"
 #include "quiche/http2/adapter/test_utils.h"
@@ -25,6 +28,68 @@ enum FrameType {
   WINDOW_UPDATE,
 };
 
+using RequestHeaders =
+    std::vector<std::pair<absl::string_view, absl::string_view>>;
+
+// Expects the callbacks for the client preface, which carries an empty SETTINGS
+// frame.
+void ExpectClientPreface(DataSavingVisitor& visitor) {
+  EXPECT_CALL(visitor, OnFrameHeader(0, 0, SETTINGS, 0));
+  EXPECT_CALL(visitor, OnSettingsStart());
+  EXPECT_CALL(visitor, OnSettingsEnd());
+}
+
+// Expects the callbacks for a HEADERS frame carrying `headers` on `stream_id`.
+void ExpectRequestHeaders(DataSavingVisitor& visitor, Http2StreamId stream_id,
+                          const RequestHeaders& headers, bool fin) {
+  EXPECT_CALL(visitor, OnFrameHeader(stream_id, _, HEADERS, fin ? 5 : 4));
+  EXPECT_CALL(visitor, OnBeginHeadersForStream(stream_id));
+  for (const auto& [name, value] : headers) {
+    EXPECT_CALL(visitor, OnHeaderForStream(stream_id, name, value));
+  }
+  EXPECT_CALL(visitor, OnEndHeadersForStream(stream_id));
+  if (fin) {
+    EXPECT_CALL(visitor, OnEndStream(stream_id));
+  }
+}
+
+// Expects the server's initial SETTINGS and the SETTINGS ack to be sent.
+void ExpectServerSettingsSent(DataSavingVisitor& visitor) {
+  EXPECT_CALL(visitor, OnBeforeFrameSent(SETTINGS, 0, _, 0x0));
+  EXPECT_CALL(visitor, OnFrameSent(SETTINGS, 0, _, 0x0, 0));
+  EXPECT_CALL(visitor, OnBeforeFrameSent(SETTINGS, 0, _, 0x1));
+  EXPECT_CALL(visitor, OnFrameSent(SETTINGS, 0, _, 0x1, 0));
+}
+
+// Expects the response HEADERS on `stream_id` to be sent.
+void ExpectResponseHeadersSent(DataSavingVisitor& visitor,
+                               Http2StreamId stream_id) {
+  EXPECT_CALL(visitor, OnBeforeFrameSent(HEADERS, stream_id, _, 0x4));
+  EXPECT_CALL(visitor, OnFrameSent(HEADERS, stream_id, _, 0x4, 0));
+}
+
+// Expects a DATA frame on `stream_id` to be sent. A DATA frame with `fin`
+// closes the stream, as the request has already ended.
+void ExpectDataSent(DataSavingVisitor& visitor, Http2StreamId stream_id,
+                    bool fin) {
+  EXPECT_CALL(visitor, OnFrameSent(DATA, stream_id, _, fin ? 0x1 : 0x0, 0));
+  if (fin) {
+    EXPECT_CALL(visitor,
+                OnCloseStream(stream_id, Http2ErrorCode::HTTP2_NO_ERROR));
+  }
+}
+
+// Submits a response with a body of `body_size` bytes to `stream_id`.
+void SubmitResponseWithBody(OgHttp2Session& session, DataSavingVisitor& visitor,
+                            Http2StreamId stream_id, size_t body_size) {
+  auto body = absl::make_unique<TestDataFrameSource>(visitor, true);
+  body->AppendPayload(std::string(body_size, 'a'));
+  body->EndData();
+  EXPECT_EQ(0,
+            session.SubmitResponse(stream_id, ToHeaders({{":status", "200"}}),
+                                   std::move(body)));
+}
+
 }  // namespace
 
 TEST(OgHttp2SessionTest, ClientConstruction) {
@@ -931,6 +996,205 @@ TEST(OgHttp2SessionTest, ServerQueuesTrailersWithResponse) {
                             SpdyFrameType::HEADERS}));
 }
 
+// Tests that a more urgent stream is written ahead of a bulk response, even
+// when the bulk response was submitted first.
+TEST(OgHttp2SessionTest, ServerWritesUrgentStreamFirst) {
+  DataSavingVisitor visitor;
+  OgHttp2Session::Options options;
+  options.perspective = Perspective::kServer;
+  options.enable_extensible_priorities = true;
+  options.stream_write_quantum = 1000;
+  OgHttp2Session session(visitor, options);
+
+  const RequestHeaders bulk_request = {{":method", "GET"},
+                                       {":scheme", "https"},
+                                       {":authority", "example.com"},
+                                       {":path", "/bulk"}};
+  const RequestHeaders urgent_request = {{":method", "GET"},
+                                         {":scheme", "https"},
+                                         {":authority", "example.com"},
+                                         {":path", "/urgent"},
+                                         {"priority", "u=0"}};
+  const std::string frames = TestFrameSequence()
+                                 .ClientPreface()
+                                 .Headers(1, bulk_request, /*fin=*/true)
+                                 .Headers(3, urgent_request, /*fin=*/true)
+                                 .Serialize();
+  testing::InSequence s;
+  ExpectClientPreface(visitor);
+  ExpectRequestHeaders(visitor, 1, bulk_request, /*fin=*/true);
+  ExpectRequestHeaders(visitor, 3, urgent_request, /*fin=*/true);
+  const int64_t result = session.ProcessBytes(frames);
+  EXPECT_EQ(frames.size(), static_cast<size_t>(result));
+
+  SubmitResponseWithBody(session, visitor, 1, 3000);
+  SubmitResponseWithBody(session, visitor, 3, 2000);
+  ExpectServerSettingsSent(visitor);
+  ExpectResponseHeadersSent(visitor, 1);
+  ExpectResponseHeadersSent(visitor, 3);
+  ExpectDataSent(visitor, 3, /*fin=*/false);
+  ExpectDataSent(visitor, 3, /*fin=*/true);
+  ExpectDataSent(visitor, 1, /*fin=*/false);
+  ExpectDataSent(visitor, 1, /*fin=*/false);
+  ExpectDataSent(visitor, 1, /*fin=*/true);
+  EXPECT_EQ(0, session.Send());
+  EXPECT_FALSE(session.want_write());
+}
+
+// Tests that incremental streams of the same urgency are interleaved, and that
+// a PRIORITY_UPDATE received before the request takes precedence over its
+// priority header field.
+TEST(OgHttp2SessionTest, ServerInterleavesIncrementalStreams) {
+  DataSavingVisitor visitor;
+  OgHttp2Session::Options options;
+  options.perspective = Perspective::kServer;
+  options.enable_extensible_priorities = true;
+  options.stream_write_quantum = 1000;
+  OgHttp2Session session(visitor, options);
+
+  const RequestHeaders request_one = {{":method", "GET"},
+                                      {":scheme", "https"},
+                                      {":authority", "example.com"},
+                                      {":path", "/one"},
+                                      {"priority", "u=5, i"}};
+  const RequestHeaders request_two = {{":method", "GET"},
+                                      {":scheme", "https"},
+                                      {":authority", "example.com"},
+                                      {":path", "/two"},
+                                      {"priority", "u=5, i"}};
+  const RequestHeaders request_three = {{":method", "GET"},
+                                        {":scheme", "https"},
+                                        {":authority", "example.com"},
+                                        {":path", "/three"},
+                                        {"priority", "u=7"}};
+  const std::string frames = TestFrameSequence()
+                                 .ClientPreface()
+                                 .Headers(1, request_one, /*fin=*/true)
+                                 .Headers(3, request_two, /*fin=*/true)
+                                 .PriorityUpdate(5, "u=1")
+                                 .Headers(5, request_three, /*fin=*/true)
+                                 .Serialize();
+  testing::InSequence s;
+  ExpectClientPreface(visitor);
+  ExpectRequestHeaders(visitor, 1, request_one, /*fin=*/true);
+  ExpectRequestHeaders(visitor, 3, request_two, /*fin=*/true);
+  EXPECT_CALL(visitor, OnFrameHeader(0, _, /*PRIORITY_UPDATE=*/0x10, 0));
+  ExpectRequestHeaders(visitor, 5, request_three, /*fin=*/true);
+  const int64_t result = session.ProcessBytes(frames);
+  EXPECT_EQ(frames.size(), static_cast<size_t>(result));
+
+  SubmitResponseWithBody(session, visitor, 1, 2000);
+  SubmitResponseWithBody(session, visitor, 3, 2000);
+  SubmitResponseWithBody(session, visitor, 5, 1000);
+  ExpectServerSettingsSent(visitor);
+  ExpectResponseHeadersSent(visitor, 1);
+  ExpectResponseHeadersSent(visitor, 3);
+  ExpectResponseHeadersSent(visitor, 5);
+  ExpectDataSent(visitor, 5, /*fin=*/true);
+  ExpectDataSent(visitor, 1, /*fin=*/false);
+  ExpectDataSent(visitor, 3, /*fin=*/false);
+  ExpectDataSent(visitor, 1, /*fin=*/true);
+  ExpectDataSent(visitor, 3, /*fin=*/true);
+  EXPECT_EQ(0, session.Send());
+}
+
+// Tests that a malformed PRIORITY_UPDATE received before the request is
+// dropped, so that the priority header field of the request applies.
+TEST(OgHttp2SessionTest, ServerDropsMalformedPendingPriorityUpdate) {
+  DataSavingVisitor visitor;
+  OgHttp2Session::Options options;
+  options.perspective = Perspective::kServer;
+  options.enable_extensible_priorities = true;
+  options.stream_write_quantum = 1000;
+  OgHttp2Session session(visitor, options);
+
+  const RequestHeaders bulk_request = {{":method", "GET"},
+                                       {":scheme", "https"},
+                                       {":authority", "example.com"},
+                                       {":path", "/bulk"}};
+  const RequestHeaders urgent_request = {{":method", "GET"},
+                                         {":scheme", "https"},
+                                         {":authority", "example.com"},
+                                         {":path", "/urgent"},
+                                         {"priority", "u=0"}};
+  const std::string frames = TestFrameSequence()
+                                 .ClientPreface()
+                                 .Headers(1, bulk_request, /*fin=*/true)
+                                 .PriorityUpdate(3, "u=(")
+                                 .Headers(3, urgent_request, /*fin=*/true)
+                                 .Serialize();
+  testing::InSequence s;
+  ExpectClientPreface(visitor);
+  ExpectRequestHeaders(visitor, 1, bulk_request, /*fin=*/true);
+  EXPECT_CALL(visitor, OnFrameHeader(0, _, /*PRIORITY_UPDATE=*/0x10, 0));
+  ExpectRequestHeaders(visitor, 3, urgent_request, /*fin=*/true);
+  const int64_t result = session.ProcessBytes(frames);
+  EXPECT_EQ(frames.size(), static_cast<size_t>(result));
+
+  SubmitResponseWithBody(session, visitor, 1, 1000);
+  SubmitResponseWithBody(session, visitor, 3, 1000);
+  ExpectServerSettingsSent(visitor);
+  ExpectResponseHeadersSent(visitor, 1);
+  ExpectResponseHeadersSent(visitor, 3);
+  ExpectDataSent(visitor, 3, /*fin=*/true);
+  ExpectDataSent(visitor, 1, /*fin=*/true);
+  EXPECT_EQ(0, session.Send());
+}
+
+// Tests that data consumed from visitor callbacks while processing bytes
+// results in a single WINDOW_UPDATE for the stream and one for the connection.
+TEST(OgHttp2SessionTest, ServerBatchesWindowUpdates) {
+  DataSavingVisitor visitor;
+  OgHttp2Session::Options options;
+  options.perspective = Perspective::kServer;
+  options.should_window_update_fn = [](int64_t /*limit*/, int64_t /*size*/,
+                                       int64_t delta) { return delta > 0; };
+  options.batch_window_updates = true;
+  OgHttp2Session session(visitor, options);
+
+  const RequestHeaders request = {{":method", "POST"},
+                                  {":scheme", "https"},
+                                  {":authority", "example.com"},
+                                  {":path", "/upload"}};
+  const std::string body(1000, 'a');
+  const std::string frames = TestFrameSequence()
+                                 .ClientPreface()
+                                 .Headers(1, request, /*fin=*/false)
+                                 .Data(1, body)
+                                 .Data(1, body)
+                                 .Data(1, body)
+                                 .Serialize();
+  testing::InSequence s;
+  ExpectClientPreface(visitor);
+  ExpectRequestHeaders(visitor, 1, request, /*fin=*/false);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_CALL(visitor, OnFrameHeader(1, body.size(), DATA, 0));
+    EXPECT_CALL(visitor, OnBeginDataForStream(1, body.size()));
+    EXPECT_CALL(visitor, OnDataForStream(1, _))
+        .WillOnce([&session](Http2StreamId stream_id, absl::string_view data) {
+          session.Consume(stream_id, data.size());
+          return true;
+        });
+  }
+  const int64_t result = session.ProcessBytes(frames);
+  EXPECT_EQ(frames.size(), static_cast<size_t>(result));
+  EXPECT_EQ(kInitialFlowControlWindowSize,
+            session.GetStreamReceiveWindowSize(1));
+  EXPECT_EQ(kInitialFlowControlWindowSize, session.GetReceiveWindowSize());
+
+  // One WINDOW_UPDATE for the stream, then one for the connection.
+  ExpectServerSettingsSent(visitor);
+  EXPECT_CALL(visitor, OnBeforeFrameSent(WINDOW_UPDATE, 1, 4, 0x0));
+  EXPECT_CALL(visitor, OnFrameSent(WINDOW_UPDATE, 1, 4, 0x0, 0));
+  EXPECT_CALL(visitor, OnBeforeFrameSent(WINDOW_UPDATE, 0, 4, 0x0));
+  EXPECT_CALL(visitor, OnFrameSent(WINDOW_UPDATE, 0, 4, 0x0, 0));
+  EXPECT_EQ(0, session.Send());
+  EXPECT_THAT(visitor.data(),
+              EqualsFrames({SpdyFrameType::SETTINGS, SpdyFrameType::SETTINGS,
+                            SpdyFrameType::WINDOW_UPDATE,
+                            SpdyFrameType::WINDOW_UPDATE}));
+}
+
 }  // namespace test
 }  // namespace adapter
 }  // namespace http2
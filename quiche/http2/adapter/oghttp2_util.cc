@@ -1,5 +1,7 @@
 #include "quiche/http2/adapter/oghttp2_util.h"
 
+#include "quiche/common/structured_headers.h"
+
 namespace http2 {
 namespace adapter {
 
@@ -13,5 +15,30 @@ spdy::SpdyHeaderBlock ToHeaderBlock(absl::Span<const Header> headers) {
   return block;
 }
 
+absl::optional<StreamPriority> ParsePriorityFieldValue(
+    absl::string_view value) {
+  absl::optional<quiche::structured_headers::Dictionary> dictionary =
+      quiche::structured_headers::ParseDictionary(value);
+  if (!dictionary.has_value()) {
+    return absl::nullopt;
+  }
+  StreamPriority priority;
+  for (const auto& [key, member] : *dictionary) {
+    if (member.member_is_inner_list || member.member.size() != 1) {
+      continue;
+    }
+    const quiche::structured_headers::Item& item = member.member[0].item;
+    if (key == "u" && item.is_integer()) {
+      const int64_t urgency = item.GetInteger();
+      if (urgency >= 0 && urgency <= StreamPriority::kMaxUrgency) {
+        priority.urgency = static_cast<int>(urgency);
+      }
+    } else if (key == "i" && item.is_boolean()) {
+      priority.incremental = item.GetBoolean();
+    }
+  }
+  return priority;
+}
+
 }  // namespace adapter
 }  // namespace http2
@@ -1,6 +1,10 @@
 #ifndef QUICHE_HTTP2_ADAPTER_OGHTTP2_UTIL_H_
 #define QUICHE_HTTP2_ADAPTER_OGHTTP2_UTIL_H_
 
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "quiche/http2/adapter/http2_protocol.h"
 #include "quiche/common/platform/api/quiche_export.h"
@@ -12,6 +16,23 @@ namespace adapter {
 QUICHE_EXPORT_PRIVATE spdy::SpdyHeaderBlock ToHeaderBlock(
     absl::Span<const Header> headers);
 
+// The priority parameters of a stream, as defined in RFC 9218 Section 4.
+struct QUICHE_EXPORT_PRIVATE StreamPriority {
+  static constexpr int kDefaultUrgency = 3;
+  static constexpr int kMaxUrgency = 7;
+
+  // Lower values are more urgent.
+  int urgency = kDefaultUrgency;
+  bool incremental = false;
+};
+
+// Parses the value of a `priority` header field or PRIORITY_UPDATE frame.
+// Parameters that are unknown, out of range or of the wrong type keep their
+// default values. Returns absl::nullopt if `value` is not a Structured Fields
+// Dictionary.
+QUICHE_EXPORT_PRIVATE absl::optional<StreamPriority> ParsePriorityFieldValue(
+    absl::string_view value);
+
 }  // namespace adapter
 }  // namespace http2
 
@@ -77,6 +77,43 @@ TEST(ToHeaderBlock, RepeatedResponseHeaderNames) {
   EXPECT_THAT(block, testing::ElementsAreArray(expected));
 }
 
+TEST(ParsePriorityFieldValue, Defaults) {
+  absl::optional<StreamPriority> priority = ParsePriorityFieldValue("");
+  ASSERT_TRUE(priority.has_value());
+  EXPECT_EQ(StreamPriority::kDefaultUrgency, priority->urgency);
+  EXPECT_FALSE(priority->incremental);
+}
+
+TEST(ParsePriorityFieldValue, UrgencyAndIncremental) {
+  absl::optional<StreamPriority> priority = ParsePriorityFieldValue("u=0, i");
+  ASSERT_TRUE(priority.has_value());
+  EXPECT_EQ(0, priority->urgency);
+  EXPECT_TRUE(priority->incremental);
+
+  priority = ParsePriorityFieldValue("i=?0, u=7");
+  ASSERT_TRUE(priority.has_value());
+  EXPECT_EQ(7, priority->urgency);
+  EXPECT_FALSE(priority->incremental);
+}
+
+TEST(ParsePriorityFieldValue, IgnoresInvalidParameters) {
+  absl::optional<StreamPriority> priority =
+      ParsePriorityFieldValue("u=8, i=1, x=2");
+  ASSERT_TRUE(priority.has_value());
+  EXPECT_EQ(StreamPriority::kDefaultUrgency, priority->urgency);
+  EXPECT_FALSE(priority->incremental);
+
+  priority = ParsePriorityFieldValue("u=(1 2), i");
+  ASSERT_TRUE(priority.has_value());
+  EXPECT_EQ(StreamPriority::kDefaultUrgency, priority->urgency);
+  EXPECT_TRUE(priority->incremental);
+}
+
+TEST(ParsePriorityFieldValue, NotADictionary) {
+  EXPECT_FALSE(ParsePriorityFieldValue("u=").has_value());
+  EXPECT_FALSE(ParsePriorityFieldValue("U=1").has_value());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace adapter
@@ -151,6 +151,14 @@ TestFrameSequence& TestFrameSequence::Priority(Http2StreamId stream_id,
   return *this;
 }
 
+TestFrameSequence& TestFrameSequence::PriorityUpdate(
+    Http2StreamId prioritized_stream_id,
+    absl::string_view priority_field_value) {
+  frames_.push_back(absl::make_unique<spdy::SpdyPriorityUpdateIR>(
+      0, prioritized_stream_id, std::string(priority_field_value)));
+  return *this;
+}
+
 TestFrameSequence& TestFrameSequence::Metadata(Http2StreamId stream_id,
                                                absl::string_view payload,
                                                bool multiple_frames) {
@@ -53,6 +53,8 @@ class QUICHE_NO_EXPORT TestFrameSequence {
   TestFrameSequence& Priority(Http2StreamId stream_id,
                               Http2StreamId parent_stream_id, int weight,
                               bool exclusive);
+  TestFrameSequence& PriorityUpdate(Http2StreamId prioritized_stream_id,
+                                    absl::string_view priority_field_value);
   TestFrameSequence& Metadata(Http2StreamId stream_id,
                               absl::string_view payload,
                               bool multiple_frames = false);
@@ -1,5 +1,6 @@
 #include "quiche/http2/adapter/window_manager.h"
 
+#include <memory>
 #include <utility>
 
 #include "quiche/common/platform/api/quiche_bug_tracker.h"
@@ -25,6 +26,41 @@ bool DefaultShouldWindowUpdateFn(int64_t limit, int64_t window, int64_t delta) {
   return false;
 }
 
+namespace {
+
+// Adapts the std::function callbacks of a single window to a SharedListener.
+class FunctionListener : public WindowManager::SharedListener {
+ public:
+  FunctionListener(WindowManager::WindowUpdateListener listener,
+                   WindowManager::ShouldWindowUpdateFn should_window_update_fn)
+      : listener_(std::move(listener)),
+        should_window_update_fn_(std::move(should_window_update_fn)) {}
+
+  bool ShouldWindowUpdate(int64_t limit, int64_t size,
+                          int64_t delta) override {
+    if (!should_window_update_fn_) {
+      return SharedListener::ShouldWindowUpdate(limit, size, delta);
+    }
+    return should_window_update_fn_(limit, size, delta);
+  }
+
+  void OnWindowUpdate(uint32_t /*id*/, int64_t delta) override {
+    listener_(delta);
+  }
+
+ private:
+  WindowManager::WindowUpdateListener listener_;
+  WindowManager::ShouldWindowUpdateFn should_window_update_fn_;
+};
+
+}  // namespace
+
+bool WindowManager::SharedListener::ShouldWindowUpdate(int64_t limit,
+                                                      int64_t size,
+                                                      int64_t delta) {
+  return DefaultShouldWindowUpdateFn(limit, size, delta);
+}
+
 WindowManager::WindowManager(int64_t window_size_limit,
                              WindowUpdateListener listener,
                              ShouldWindowUpdateFn should_window_update_fn,
@@ -32,12 +68,21 @@ WindowManager::WindowManager(int64_t window_size_limit,
     : limit_(window_size_limit),
       window_(window_size_limit),
       buffered_(0),
-      listener_(std::move(listener)),
-      should_window_update_fn_(std::move(should_window_update_fn)),
+      owned_listener_(std::make_unique<FunctionListener>(
+          std::move(listener), std::move(should_window_update_fn))),
+      listener_(owned_listener_.get()),
+      update_window_on_notify_(update_window_on_notify) {}
+
+WindowManager::WindowManager(int64_t window_size_limit,
+                             SharedListener* shared_listener, uint32_t id,
+                             bool update_window_on_notify)
+    : limit_(window_size_limit),
+      window_(window_size_limit),
+      buffered_(0),
+      listener_(shared_listener),
+      id_(id),
       update_window_on_notify_(update_window_on_notify) {
-  if (!should_window_update_fn_) {
-    should_window_update_fn_ = DefaultShouldWindowUpdateFn;
-  }
+  QUICHE_DCHECK(listener_ != nullptr);
 }
 
 void WindowManager::OnWindowSizeLimitChange(const int64_t new_limit) {
@@ -89,10 +134,10 @@ void WindowManager::MarkDataFlushed(int64_t bytes) {
 
 void WindowManager::MaybeNotifyListener() {
   const int64_t delta = limit_ - (buffered_ + window_);
-  if (should_window_update_fn_(limit_, window_, delta) && delta > 0) {
+  if (listener_->ShouldWindowUpdate(limit_, window_, delta) && delta > 0) {
     QUICHE_VLOG(2) << "WindowManager@" << this
                    << " Informing listener of delta: " << delta;
-    listener_(delta);
+    listener_->OnWindowUpdate(id_, delta);
     if (update_window_on_notify_) {
       window_ += delta;
     }
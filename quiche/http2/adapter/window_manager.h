@@ -3,7 +3,9 @@
 
 #include <stddef.h>
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 
 #include "quiche/common/platform/api/quiche_export.h"
 
@@ -26,10 +28,30 @@ class QUICHE_EXPORT_PRIVATE WindowManager {
   using ShouldWindowUpdateFn =
       std::function<bool(int64_t limit, int64_t size, int64_t delta)>;
 
+  // Alternative to a WindowUpdateListener and ShouldWindowUpdateFn for owners
+  // of many windows, e.g., one per stream. A single SharedListener serves all
+  // the windows, which then do not need to store any std::function.
+  // Internally, the std::function callbacks are also adapted to this interface.
+  class QUICHE_EXPORT_PRIVATE SharedListener {
+   public:
+    virtual ~SharedListener() = default;
+
+    // Same as ShouldWindowUpdateFn. Uses the default policy unless overridden.
+    virtual bool ShouldWindowUpdate(int64_t limit, int64_t size,
+                                    int64_t delta);
+
+    // Same as WindowUpdateListener, for the window constructed with `id`.
+    virtual void OnWindowUpdate(uint32_t id, int64_t delta) = 0;
+  };
+
   WindowManager(int64_t window_size_limit, WindowUpdateListener listener,
                 ShouldWindowUpdateFn should_window_update_fn = {},
                 bool update_window_on_notify = true);
 
+  // Notifies `shared_listener`, which must outlive this object, with `id`.
+  WindowManager(int64_t window_size_limit, SharedListener* shared_listener,
+                uint32_t id, bool update_window_on_notify = true);
+
   int64_t CurrentWindowSize() const { return window_; }
   int64_t WindowSizeLimit() const { return limit_; }
 
@@ -79,9 +101,13 @@ class QUICHE_EXPORT_PRIVATE WindowManager {
   // control window upper bound.
   int64_t buffered_;
 
-  WindowUpdateListener listener_;
+  // Set only when constructed with std::function callbacks, which are held by
+  // this adapter so that a window using a shared listener stores none.
+  std::unique_ptr<SharedListener> owned_listener_;
 
-  ShouldWindowUpdateFn should_window_update_fn_;
+  // Always notified; either external or `owned_listener_.get()`.
+  SharedListener* listener_;
+  uint32_t id_ = 0;
 
   bool update_window_on_notify_;
 };
@@ -1,6 +1,7 @@
 #include "quiche/http2/adapter/window_manager.h"
 
 #include <list>
+#include <utility>
 
 #include "absl/functional/bind_front.h"
 #include "quiche/http2/test_tools/http2_random.h"
@@ -330,6 +331,38 @@ TEST(WindowManagerShouldUpdateTest, CustomShouldWindowUpdateFn) {
   EXPECT_THAT(call_sequence3, testing::ElementsAre(consumed, buffered));
 }
 
+class RecordingSharedListener : public WindowManager::SharedListener {
+ public:
+  void OnWindowUpdate(uint32_t id, int64_t delta) override {
+    calls_.push_back({id, delta});
+  }
+
+  std::list<std::pair<uint32_t, int64_t>> calls_;
+};
+
+// This test verifies that window managers constructed with a SharedListener
+// notify it with their id, using the default policy unless overridden.
+TEST(WindowManagerSharedListenerTest, NotifiesWithId) {
+  const int64_t kDefaultLimit = 65535;
+  RecordingSharedListener listener;
+  WindowManager wm1(kDefaultLimit, &listener, /*id=*/1);
+  WindowManager wm3(kDefaultLimit, &listener, /*id=*/3,
+                    /*update_window_on_notify=*/false);
+
+  const int64_t consumed = kDefaultLimit / 3 - 1;
+  wm1.MarkWindowConsumed(consumed);
+  wm3.MarkWindowConsumed(consumed);
+  EXPECT_TRUE(listener.calls_.empty());
+
+  wm3.MarkWindowConsumed(1);
+  wm1.MarkWindowConsumed(1);
+  EXPECT_THAT(listener.calls_,
+              testing::ElementsAre(std::make_pair(3u, consumed + 1),
+                                   std::make_pair(1u, consumed + 1)));
+  EXPECT_EQ(wm1.CurrentWindowSize(), kDefaultLimit);
+  EXPECT_EQ(wm3.CurrentWindowSize(), kDefaultLimit - (consumed + 1));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace adapter
@@ -4,25 +4,11 @@
 
 #include "quiche/http2/hpack/decoder/hpack_decoder_state.h"
 
-#include <utility>
-
+#include "absl/strings/string_view.h"
 #include "quiche/http2/http2_constants.h"
 #include "quiche/common/platform/api/quiche_logging.h"
 
 namespace http2 {
-namespace {
-
-std::string ExtractString(HpackDecoderStringBuffer* string_buffer) {
-  if (string_buffer->IsBuffered()) {
-    return string_buffer->ReleaseString();
-  } else {
-    auto result = std::string(string_buffer->str());
-    string_buffer->Reset();
-    return result;
-  }
-}
-
-}  // namespace
 
 HpackDecoderState::HpackDecoderState(HpackDecoderListener* listener)
     : listener_(listener),
@@ -111,11 +97,12 @@ void HpackDecoderState::OnNameIndexAndLiteralValue(
   allow_dynamic_table_size_update_ = false;
   const HpackStringPair* entry = decoder_tables_.Lookup(name_index);
   if (entry != nullptr) {
-    std::string value(ExtractString(value_buffer));
+    const absl::string_view value = value_buffer->str();
     listener_->OnHeader(entry->name, value);
     if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
-      decoder_tables_.Insert(entry->name, std::move(value));
+      decoder_tables_.Insert(entry->name, value);
     }
+    value_buffer->Reset();
   } else {
     ReportError(HpackDecodingError::kInvalidNameIndex, "");
   }
@@ -134,12 +121,14 @@ void HpackDecoderState::OnLiteralNameAndValue(
     return;
   }
   allow_dynamic_table_size_update_ = false;
-  std::string name(ExtractString(name_buffer));
-  std::string value(ExtractString(value_buffer));
+  const absl::string_view name = name_buffer->str();
+  const absl::string_view value = value_buffer->str();
   listener_->OnHeader(name, value);
   if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
-    decoder_tables_.Insert(std::move(name), std::move(value));
+    decoder_tables_.Insert(name, value);
   }
+  name_buffer->Reset();
+  value_buffer->Reset();
 }
 
 void HpackDecoderState::OnDynamicTableSizeUpdate(size_t size_limit) {
@@ -4,6 +4,10 @@
 
 #include "quiche/http2/hpack/decoder/hpack_decoder_tables.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
 #include "absl/strings/str_cat.h"
 #include "quiche/http2/hpack/http2_hpack_constants.h"
 #include "quiche/common/platform/api/quiche_logging.h"
@@ -35,8 +39,9 @@ const std::vector<HpackStringPair>* GetStaticTable() {
 
 }  // namespace
 
-HpackStringPair::HpackStringPair(std::string name, std::string value)
-    : name(std::move(name)), value(std::move(value)) {
+HpackStringPair::HpackStringPair(absl::string_view name,
+                                 absl::string_view value)
+    : name(name), value(value) {
   QUICHE_DVLOG(3) << DebugString() << " ctor";
 }
 
@@ -66,8 +71,7 @@ const HpackStringPair* HpackDecoderStaticTable::Lookup(size_t index) const {
   return nullptr;
 }
 
-HpackDecoderDynamicTable::HpackDecoderDynamicTable()
-    : insert_count_(kFirstDynamicTableIndex - 1) {}
+HpackDecoderDynamicTable::HpackDecoderDynamicTable() = default;
 HpackDecoderDynamicTable::~HpackDecoderDynamicTable() = default;
 
 void HpackDecoderDynamicTable::DynamicTableSizeUpdate(size_t size_limit) {
@@ -80,24 +84,45 @@ void HpackDecoderDynamicTable::DynamicTableSizeUpdate(size_t size_limit) {
 
 // TODO(jamessynge): Check somewhere before here that names received from the
 // peer are valid (e.g. are lower-case, no whitespace, etc.).
-void HpackDecoderDynamicTable::Insert(std::string name, std::string value) {
-  HpackStringPair entry(std::move(name), std::move(value));
-  size_t entry_size = entry.size();
+void HpackDecoderDynamicTable::Insert(absl::string_view name,
+                                      absl::string_view value) {
+  const size_t entry_size = HpackStringPair(name, value).size();
   QUICHE_DVLOG(2) << "InsertEntry of size=" << entry_size
-                  << "\n     name: " << entry.name
-                  << "\n    value: " << entry.value;
+                  << "\n     name: " << name << "\n    value: " << value;
   if (entry_size > size_limit_) {
     QUICHE_DVLOG(2) << "InsertEntry: entry larger than table, removing "
                     << table_.size() << " entries, of total size "
                     << current_size_ << " bytes.";
     table_.clear();
     current_size_ = 0;
+    write_offset_ = 0;
     return;
   }
-  ++insert_count_;
   size_t insert_limit = size_limit_ - entry_size;
+  // Evicting entries leaves their bytes in place, so name is still valid even
+  // if it refers to an evicted entry.
   EnsureSizeNoMoreThan(insert_limit);
-  table_.push_front(entry);
+  const size_t length = name.size() + value.size();
+  std::string name_copy;
+  if (buffer_.size() - write_offset_ < length) {
+    // MakeRoom moves the bytes name may refer to.
+    if (!name.empty() && !buffer_.empty() &&
+        std::less_equal<const char*>()(buffer_.data(), name.data()) &&
+        std::less<const char*>()(name.data(),
+                                 buffer_.data() + buffer_.size())) {
+      name_copy = std::string(name);
+      name = name_copy;
+    }
+    MakeRoom(length);
+  }
+  char* dest = &buffer_[write_offset_];
+  name.copy(dest, name.size());
+  value.copy(dest + name.size(), value.size());
+  table_.push_front(DynamicEntry{
+      write_offset_,
+      HpackStringPair(absl::string_view(dest, name.size()),
+                      absl::string_view(dest + name.size(), value.size()))});
+  write_offset_ += length;
   current_size_ += entry_size;
   QUICHE_DVLOG(2) << "InsertEntry: current_size_=" << current_size_;
   QUICHE_DCHECK_GE(current_size_, entry_size);
@@ -106,7 +131,7 @@ void HpackDecoderDynamicTable::Insert(std::string name, std::string value) {
 
 const HpackStringPair* HpackDecoderDynamicTable::Lookup(size_t index) const {
   if (index < table_.size()) {
-    return &table_[index];
+    return &table_[index].pair;
   }
   return nullptr;
 }
@@ -125,15 +150,47 @@ void HpackDecoderDynamicTable::RemoveLastEntry() {
   QUICHE_DCHECK(!table_.empty());
   if (!table_.empty()) {
     QUICHE_DVLOG(2) << "RemoveLastEntry current_size_=" << current_size_
-                    << ", last entry size=" << table_.back().size();
-    QUICHE_DCHECK_GE(current_size_, table_.back().size());
-    current_size_ -= table_.back().size();
+                    << ", last entry size=" << table_.back().pair.size();
+    QUICHE_DCHECK_GE(current_size_, table_.back().pair.size());
+    current_size_ -= table_.back().pair.size();
     table_.pop_back();
     // Empty IFF current_size_ == 0.
     QUICHE_DCHECK_EQ(table_.empty(), current_size_ == 0);
   }
 }
 
+void HpackDecoderDynamicTable::MakeRoom(size_t length) {
+  const size_t live_offset =
+      table_.empty() ? write_offset_ : table_.back().offset;
+  const size_t live_length = write_offset_ - live_offset;
+  QUICHE_DVLOG(2) << "MakeRoom length=" << length
+                  << ", live_length=" << live_length
+                  << ", buffer size=" << buffer_.size();
+  const size_t needed = live_length + length;
+  if (buffer_.size() < 2 * needed) {
+    // Entries never hold more bytes than the size limit, so twice the size
+    // limit is as large as the buffer needs to get.
+    QUICHE_DCHECK_LE(needed, size_limit_);
+    std::string buffer(
+        std::min(2 * size_limit_, std::max(2 * buffer_.size(), 2 * needed)),
+        '\0');
+    memcpy(&buffer[0], buffer_.data() + live_offset, live_length);
+    buffer_.swap(buffer);
+  } else if (live_offset > 0) {
+    memmove(&buffer_[0], buffer_.data() + live_offset, live_length);
+  }
+  // Rebuild the views, even if nothing moved: buffer_ may have been swapped.
+  for (DynamicEntry& entry : table_) {
+    entry.offset -= live_offset;
+    const char* name = buffer_.data() + entry.offset;
+    entry.pair.name = absl::string_view(name, entry.pair.name.size());
+    entry.pair.value = absl::string_view(name + entry.pair.name.size(),
+                                         entry.pair.value.size());
+  }
+  write_offset_ = live_length;
+  QUICHE_DCHECK_LE(write_offset_ + length, buffer_.size());
+}
+
 HpackDecoderTables::HpackDecoderTables() = default;
 HpackDecoderTables::~HpackDecoderTables() = default;
 
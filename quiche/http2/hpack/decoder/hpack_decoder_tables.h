@@ -21,9 +21,9 @@
 #include <cstdint>
 #include <iosfwd>
 #include <string>
-#include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "quiche/http2/http2_constants.h"
 #include "quiche/common/platform/api/quiche_export.h"
 #include "quiche/common/quiche_circular_deque.h"
@@ -33,8 +33,12 @@ namespace test {
 class HpackDecoderTablesPeer;
 }  // namespace test
 
+// A header name and value. Does not own the strings: entries of the static
+// table refer to string literals, and entries of the dynamic table refer to
+// its buffer, so they are only valid until the next call to Insert or
+// DynamicTableSizeUpdate on that table.
 struct QUICHE_EXPORT_PRIVATE HpackStringPair {
-  HpackStringPair(std::string name, std::string value);
+  HpackStringPair(absl::string_view name, absl::string_view value);
   ~HpackStringPair();
 
   // Returns the size of a header entry with this name and value, per the RFC:
@@ -43,8 +47,8 @@ struct QUICHE_EXPORT_PRIVATE HpackStringPair {
 
   std::string DebugString() const;
 
-  const std::string name;
-  const std::string value;
+  absl::string_view name;
+  absl::string_view value;
 };
 
 QUICHE_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
@@ -73,6 +77,14 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderStaticTable {
 // in the dynamic table. See these sections of the RFC:
 //   http://httpwg.org/specs/rfc7541.html#dynamic.table
 //   http://httpwg.org/specs/rfc7541.html#dynamic.table.management
+//
+// The names and values are stored back to back in a single buffer, in
+// insertion order. Evicting an entry only advances the start of the live
+// region, and the live region is moved back to the front of the buffer when
+// there is no room left at its end. The buffer grows as entries are inserted,
+// up to twice the size limit, and is kept at least twice as large as the live
+// region, so that moving happens at most once per live region worth of
+// inserted bytes.
 class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
  public:
   HpackDecoderDynamicTable();
@@ -87,9 +99,10 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
   // exceed the acknowledged value of SETTINGS_HEADER_TABLE_SIZE.
   void DynamicTableSizeUpdate(size_t size_limit);
 
-  // Insert entry if possible.
+  // Insert entry if possible, copying name and value into the table. name may
+  // refer to an entry of this table.
   // If entry is too large to insert, then dynamic table will be empty.
-  void Insert(std::string name, std::string value);
+  void Insert(absl::string_view name, absl::string_view value);
 
   // If index is valid, returns a pointer to the entry, otherwise returns
   // nullptr.
@@ -107,17 +120,32 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
   // Removes the oldest dynamic table entry.
   void RemoveLastEntry();
 
-  quiche::QuicheCircularDeque<HpackStringPair> table_;
+  // Moves the live region of buffer_ to its front, growing buffer_ if it is
+  // less than twice as large as the live region and |length| more bytes.
+  void MakeRoom(size_t length);
+
+  // Names and values of the entries in table_, from the oldest entry to
+  // write_offset_. Declared before table_, which refers to it.
+  std::string buffer_;
+  size_t write_offset_ = 0;
+
+  // A dynamic table entry. The views of |pair| are derived from |offset|, so
+  // that they can be rebuilt whenever buffer_ moves; they are never used to
+  // locate the entry in buffer_, as an empty view may point anywhere.
+  struct DynamicEntry {
+    // Offset of the name, followed by the value, in buffer_.
+    size_t offset;
+    HpackStringPair pair;
+  };
+
+  // Most recently inserted entry first.
+  quiche::QuicheCircularDeque<DynamicEntry> table_;
 
   // The last received DynamicTableSizeUpdate value, initialized to
   // SETTINGS_HEADER_TABLE_SIZE.
   size_t size_limit_ = Http2SettingsInfo::DefaultHeaderTableSize();
 
   size_t current_size_ = 0;
-
-  // insert_count_ and debug_listener_ are used by a QUIC experiment; remove
-  // when the experiment is done.
-  size_t insert_count_;
 };
 
 class QUICHE_EXPORT_PRIVATE HpackDecoderTables {
@@ -138,8 +166,8 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderTables {
 
   // Insert entry if possible.
   // If entry is too large to insert, then dynamic table will be empty.
-  void Insert(std::string name, std::string value) {
-    dynamic_table_.Insert(std::move(name), std::move(value));
+  void Insert(absl::string_view name, absl::string_view value) {
+    dynamic_table_.Insert(name, value);
   }
 
   // If index is valid, returns a pointer to the entry, otherwise returns
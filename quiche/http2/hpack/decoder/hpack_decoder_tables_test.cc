@@ -26,6 +26,9 @@ class HpackDecoderTablesPeer {
   static size_t num_dynamic_entries(const HpackDecoderTables& tables) {
     return tables.dynamic_table_.table_.size();
   }
+  static size_t dynamic_table_buffer_size(const HpackDecoderTables& tables) {
+    return tables.dynamic_table_.buffer_.size();
+  }
 };
 
 namespace {
@@ -128,6 +131,9 @@ class HpackDecoderTablesTest : public HpackDecoderStaticTableTest {
   size_t num_dynamic_entries() const {
     return HpackDecoderTablesPeer::num_dynamic_entries(tables_);
   }
+  size_t dynamic_table_buffer_size() const {
+    return HpackDecoderTablesPeer::dynamic_table_buffer_size(tables_);
+  }
 
   // Insert the name and value into fake_dynamic_table_.
   void FakeInsert(const std::string& name, const std::string& value) {
@@ -212,6 +218,22 @@ class HpackDecoderTablesTest : public HpackDecoderStaticTableTest {
     return VerifyDynamicTableContents();
   }
 
+  // Same as Insert, but with the name of the entry at index, which refers to
+  // the table itself if the entry is in the dynamic table.
+  AssertionResult InsertNameOf(size_t index, const std::string& value) {
+    const HpackStringPair* entry = Lookup(index);
+    VERIFY_NE(nullptr, entry);
+    const std::string name(entry->name);
+    size_t old_count = num_dynamic_entries();
+    tables_.Insert(entry->name, value);
+    FakeInsert(name, value);
+    VERIFY_EQ(old_count + 1, fake_dynamic_table_.size());
+    FakeTrim(dynamic_size_limit());
+    VERIFY_EQ(current_dynamic_size(), FakeSize());
+    VERIFY_EQ(num_dynamic_entries(), fake_dynamic_table_.size());
+    return VerifyDynamicTableContents();
+  }
+
  private:
   HpackDecoderTables tables_;
 
@@ -252,6 +274,52 @@ TEST_F(HpackDecoderTablesTest, RandomDynamicTable) {
   }
 }
 
+// Insert entries named after the oldest dynamic table entry, which is evicted
+// by the insert, and after the newest one, while the table moves its contents
+// around to make room.
+TEST_F(HpackDecoderTablesTest, InsertNameOfDynamicTableEntry) {
+  ASSERT_TRUE(Insert("first-name", "first-value"));
+  for (int insert_count = 0; insert_count < 100; ++insert_count) {
+    std::string value =
+        GenerateWebSafeString(random_.UniformInRange(500, 2000), RandomPtr());
+    ASSERT_TRUE(InsertNameOf(
+        kFirstDynamicTableIndex + num_dynamic_entries() - 1, value));
+    ASSERT_TRUE(InsertNameOf(kFirstDynamicTableIndex, value.substr(100)));
+  }
+  EXPECT_EQ("first-name", Lookup(kFirstDynamicTableIndex)->name);
+}
+
+// Regression test: empty entries, whose views don't point into the table's
+// buffer, must survive the buffer growing.
+TEST_F(HpackDecoderTablesTest, EmptyEntriesSurviveGrowingBuffer) {
+  ASSERT_TRUE(DynamicTableSizeUpdate(100));
+  ASSERT_TRUE(Insert("", ""));
+  ASSERT_TRUE(Insert("a", "b"));
+  ASSERT_TRUE(DynamicTableSizeUpdate(4096));
+  for (int insert_count = 0; insert_count < 5; ++insert_count) {
+    ASSERT_TRUE(Insert("n", std::string(150, 'v')));
+  }
+  EXPECT_EQ(7u, num_dynamic_entries());
+  EXPECT_EQ("", Lookup(kFirstDynamicTableIndex + 6)->name);
+  EXPECT_EQ("", Lookup(kFirstDynamicTableIndex + 6)->value);
+  EXPECT_EQ("a", Lookup(kFirstDynamicTableIndex + 5)->name);
+  EXPECT_EQ("b", Lookup(kFirstDynamicTableIndex + 5)->value);
+}
+
+// Tests that the buffer holding the dynamic table entries grows with the
+// entries, rather than being allocated for the size limit up front.
+TEST_F(HpackDecoderTablesTest, BufferGrowsLazily) {
+  EXPECT_EQ(0u, dynamic_table_buffer_size());
+  ASSERT_TRUE(Insert("name", "value"));
+  EXPECT_LE(9u, dynamic_table_buffer_size());
+  EXPECT_GT(100u, dynamic_table_buffer_size());
+
+  for (int insert_count = 0; insert_count < 100; ++insert_count) {
+    ASSERT_TRUE(Insert("name", std::string(100, 'v')));
+  }
+  EXPECT_GE(2 * dynamic_size_limit(), dynamic_table_buffer_size());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace http2
@@ -62,8 +62,8 @@ typedef std::vector<HpackHeaderEntry> HpackHeaderEntries;
 class MockHpackDecoderListener : public HpackDecoderListener {
  public:
   MOCK_METHOD(void, OnHeaderListStart, (), (override));
-  MOCK_METHOD(void, OnHeader,
-              (const std::string& name, const std::string& value), (override));
+  MOCK_METHOD(void, OnHeader, (absl::string_view name, absl::string_view value),
+              (override));
   MOCK_METHOD(void, OnHeaderListEnd, (), (override));
   MOCK_METHOD(void, OnHeaderErrorDetected, (absl::string_view error_message),
               (override));
@@ -91,7 +91,7 @@ class HpackDecoderTest : public QuicheTestWithParam<bool>,
   // Called for each header name-value pair that is decoded, in the order they
   // appear in the HPACK block. Multiple values for a given key will be emitted
   // as multiple calls to OnHeader.
-  void OnHeader(const std::string& name, const std::string& value) override {
+  void OnHeader(absl::string_view name, absl::string_view value) override {
     ASSERT_TRUE(saw_start_);
     ASSERT_FALSE(saw_end_);
     header_entries_.emplace_back(name, value);
@@ -278,6 +278,7 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
       configs_lock_(),
       primary_config_(nullptr),
       next_config_promotion_time_(QuicWallTime::Zero()),
+      snapshot_(std::make_shared<const ConfigSnapshot>()),
       proof_source_(std::move(proof_source)),
       key_exchange_source_(std::move(key_exchange_source)),
       ssl_ctx_(TlsServerConnection::CreateSslCtx(proof_source_.get())),
@@ -551,9 +552,10 @@ void QuicCryptoServerConfig::SetSourceAddressTokenKeys(
 }
 
 std::vector<std::string> QuicCryptoServerConfig::GetConfigIds() const {
-  QuicReaderMutexLock locked(&configs_lock_);
+  std::shared_ptr<const ConfigSnapshot> snapshot = GetSnapshot();
   std::vector<std::string> scids;
-  for (auto it = configs_.begin(); it != configs_.end(); ++it) {
+  for (auto it = snapshot->configs.begin(); it != snapshot->configs.end();
+       ++it) {
     scids.push_back(it->first);
   }
   return scids;
@@ -1101,14 +1103,34 @@ void QuicCryptoServerConfig::SendRejectWithFallbackConfigAfterGetProof(
                    std::move(proof_source_details));
 }
 
-quiche::QuicheReferenceCountedPointer<QuicCryptoServerConfig::Config>
-QuicCryptoServerConfig::GetConfigWithScid(
-    absl::string_view requested_scid) const {
-  configs_lock_.AssertReaderHeld();
+bool QuicCryptoServerConfig::ConfigSnapshot::IsNextConfigReady(
+    QuicWallTime now) const {
+  return !next_config_promotion_time.IsZero() &&
+         !next_config_promotion_time.IsAfter(now);
+}
+
+std::shared_ptr<const QuicCryptoServerConfig::ConfigSnapshot>
+QuicCryptoServerConfig::GetSnapshot() const {
+  QuicReaderMutexLock locked(&configs_lock_);
+  return snapshot_;
+}
+
+void QuicCryptoServerConfig::PublishSnapshot() const {
+  auto snapshot = std::make_shared<ConfigSnapshot>();
+  snapshot->configs = configs_;
+  snapshot->primary = primary_config_;
+  snapshot->fallback = fallback_config_;
+  snapshot->next_config_promotion_time = next_config_promotion_time_;
+  snapshot_ = std::move(snapshot);
+}
 
+// static
+quiche::QuicheReferenceCountedPointer<QuicCryptoServerConfig::Config>
+QuicCryptoServerConfig::GetConfigWithScid(const ConfigSnapshot& snapshot,
+                                          absl::string_view requested_scid) {
   if (!requested_scid.empty()) {
-    auto it = configs_.find((std::string(requested_scid)));
-    if (it != configs_.end()) {
+    auto it = snapshot.configs.find((std::string(requested_scid)));
+    if (it != snapshot.configs.end()) {
       // We'll use the config that the client requested in order to do
       // key-agreement.
       return quiche::QuicheReferenceCountedPointer<Config>(it->second);
@@ -1122,30 +1144,32 @@ bool QuicCryptoServerConfig::GetCurrentConfigs(
     const QuicWallTime& now, absl::string_view requested_scid,
     quiche::QuicheReferenceCountedPointer<Config> old_primary_config,
     Configs* configs) const {
-  QuicReaderMutexLock locked(&configs_lock_);
+  std::shared_ptr<const ConfigSnapshot> snapshot = GetSnapshot();
 
-  if (!primary_config_) {
+  if (!snapshot->primary) {
     return false;
   }
 
-  if (IsNextConfigReady(now)) {
-    configs_lock_.ReaderUnlock();
-    configs_lock_.WriterLock();
-    SelectNewPrimaryConfig(now);
-    QUICHE_DCHECK(primary_config_.get());
-    QUICHE_DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
-                     primary_config_.get());
-    configs_lock_.WriterUnlock();
-    configs_lock_.ReaderLock();
+  if (snapshot->IsNextConfigReady(now)) {
+    QuicWriterMutexLock locked(&configs_lock_);
+    // Another handshake may have promoted the config since |snapshot| was
+    // published.
+    if (snapshot_->IsNextConfigReady(now)) {
+      SelectNewPrimaryConfig(now);
+      QUICHE_DCHECK(primary_config_.get());
+      QUICHE_DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
+                       primary_config_.get());
+    }
+    snapshot = snapshot_;
   }
 
   if (old_primary_config != nullptr) {
     configs->primary = old_primary_config;
   } else {
-    configs->primary = primary_config_;
+    configs->primary = snapshot->primary;
   }
-  configs->requested = GetConfigWithScid(requested_scid);
-  configs->fallback = fallback_config_;
+  configs->requested = GetConfigWithScid(*snapshot, requested_scid);
+  configs->fallback = snapshot->fallback;
 
   return true;
 }
@@ -1227,6 +1251,7 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
                            absl::string_view(reinterpret_cast<const char*>(
                                                  primary_config_->orbit),
                                              kOrbitSize));
+    PublishSnapshot();
     if (primary_config_changed_cb_ != nullptr) {
       primary_config_changed_cb_->Run(primary_config_->id);
     }
@@ -1248,6 +1273,7 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
                          kOrbitSize))
                   << " scid: " << absl::BytesToHexString(primary_config_->id);
   next_config_promotion_time_ = QuicWallTime::Zero();
+  PublishSnapshot();
   if (primary_config_changed_cb_ != nullptr) {
     primary_config_changed_cb_->Run(primary_config_->id);
   }
@@ -1357,10 +1383,10 @@ void QuicCryptoServerConfig::BuildServerConfigUpdateMessage(
   std::string serialized;
   std::string source_address_token;
   {
-    QuicReaderMutexLock locked(&configs_lock_);
-    serialized = primary_config_->serialized;
+    std::shared_ptr<const ConfigSnapshot> snapshot = GetSnapshot();
+    serialized = snapshot->primary->serialized;
     source_address_token = NewSourceAddressToken(
-        *primary_config_->source_address_token_boxer,
+        *snapshot->primary->source_address_token_boxer,
         previous_source_address_tokens, client_address.host(), rand,
         clock->WallNow(), cached_network_params);
   }
@@ -1753,8 +1779,7 @@ std::string QuicCryptoServerConfig::NewSourceAddressToken(
 }
 
 int QuicCryptoServerConfig::NumberOfConfigs() const {
-  QuicReaderMutexLock locked(&configs_lock_);
-  return configs_.size();
+  return GetSnapshot()->configs.size();
 }
 
 ProofSource* QuicCryptoServerConfig::proof_source() const {
@@ -1872,11 +1897,6 @@ bool QuicCryptoServerConfig::ValidateExpectedLeafCertificate(
   return CryptoUtils::ComputeLeafCertHash(certs.at(0)) == hash_from_client;
 }
 
-bool QuicCryptoServerConfig::IsNextConfigReady(QuicWallTime now) const {
-  return !next_config_promotion_time_.IsZero() &&
-         !next_config_promotion_time_.IsAfter(now);
-}
-
 QuicCryptoServerConfig::Config::Config()
     : channel_id_enabled(false),
       is_primary(false),
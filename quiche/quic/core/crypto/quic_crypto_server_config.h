@@ -522,10 +522,31 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   using ConfigMap =
       std::map<ServerConfigID, quiche::QuicheReferenceCountedPointer<Config>>;
 
-  // Get a ref to the config with a given server config id.
-  quiche::QuicheReferenceCountedPointer<Config> GetConfigWithScid(
-      absl::string_view requested_scid) const
-      QUIC_SHARED_LOCKS_REQUIRED(configs_lock_);
+  // An immutable view of the config set. Writers build a new snapshot under
+  // configs_lock_ whenever the configs or the primary config change and
+  // publish it as a whole, so that handshakes can read the configs without
+  // taking configs_lock_.
+  struct QUIC_EXPORT_PRIVATE ConfigSnapshot {
+    // Returns true if the next config promotion should happen now.
+    bool IsNextConfigReady(QuicWallTime now) const;
+
+    ConfigMap configs;
+    quiche::QuicheReferenceCountedPointer<Config> primary;
+    quiche::QuicheReferenceCountedPointer<Config> fallback;
+    QuicWallTime next_config_promotion_time = QuicWallTime::Zero();
+  };
+
+  // Returns the most recently published snapshot. Never nullptr. Only holds
+  // configs_lock_ as a reader for the copy of the shared_ptr.
+  std::shared_ptr<const ConfigSnapshot> GetSnapshot() const
+      QUIC_LOCKS_EXCLUDED(configs_lock_);
+
+  // Publishes a snapshot of the current configs.
+  void PublishSnapshot() const QUIC_EXCLUSIVE_LOCKS_REQUIRED(configs_lock_);
+
+  // Get a ref to the config with a given server config id in |snapshot|.
+  static quiche::QuicheReferenceCountedPointer<Config> GetConfigWithScid(
+      const ConfigSnapshot& snapshot, absl::string_view requested_scid);
 
   // A snapshot of the configs associated with an in-progress handshake.
   struct QUIC_EXPORT_PRIVATE Configs {
@@ -827,10 +848,6 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
       CryptoHandshakeMessage message,
       std::unique_ptr<BuildServerConfigUpdateMessageResultCallback> cb) const;
 
-  // Returns true if the next config promotion should happen now.
-  bool IsNextConfigReady(QuicWallTime now) const
-      QUIC_SHARED_LOCKS_REQUIRED(configs_lock_);
-
   // replay_protection_ controls whether the server enforces that handshakes
   // aren't replays.
   bool replay_protection_;
@@ -844,6 +861,9 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   //   1) configs_.empty() <-> primary_config_ == nullptr
   //   2) primary_config_ != nullptr -> primary_config_->is_primary
   //   3) ∀ c∈configs_, c->is_primary <-> c == primary_config_
+  //
+  // Readers only hold configs_lock_ to copy |snapshot_|, and then read the
+  // configs from the snapshot without it.
   mutable QuicMutex configs_lock_;
 
   // configs_ contains all active server configs. It's expected that there are
@@ -872,6 +892,10 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   std::unique_ptr<PrimaryConfigChangedCallback> primary_config_changed_cb_
       QUIC_GUARDED_BY(configs_lock_);
 
+  // The last snapshot published by PublishSnapshot().
+  mutable std::shared_ptr<const ConfigSnapshot> snapshot_
+      QUIC_GUARDED_BY(configs_lock_);
+
   // Used to protect the source-address tokens that are given to clients.
   CryptoSecretBoxer source_address_token_boxer_;
 
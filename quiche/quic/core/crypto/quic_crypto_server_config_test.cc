@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
@@ -21,6 +22,7 @@
 #include "quiche/quic/core/quic_versions.h"
 #include "quiche/quic/platform/api/quic_socket_address.h"
 #include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/platform/api/quic_thread.h"
 #include "quiche/quic/test_tools/crypto_test_utils.h"
 #include "quiche/quic/test_tools/mock_clock.h"
 #include "quiche/quic/test_tools/quic_crypto_server_config_peer.h"
@@ -482,6 +484,84 @@ TEST_F(CryptoServerConfigsTest, AdvancePrimaryViaValidate) {
   test_peer_.CheckConfigs({{"a", false}, {"b", true}});
 }
 
+// Runs ValidateClientHello in a loop and checks that every handshake sees a
+// complete config set.
+class ValidateThread : public QuicThread {
+ public:
+  ValidateThread(const QuicCryptoServerConfig* config,
+                 QuicTransportVersion transport_version, int num_handshakes)
+      : QuicThread("ValidateThread"),
+        config_(config),
+        transport_version_(transport_version),
+        num_handshakes_(num_handshakes) {}
+
+  int num_handshakes_without_config() const {
+    return num_handshakes_without_config_;
+  }
+
+ protected:
+  void Run() override {
+    CryptoHandshakeMessage client_hello;
+    client_hello.SetStringPiece(kSCID, "b");
+    QuicSocketAddress client_address;
+    QuicSocketAddress server_address;
+    MockClock clock;
+    clock.AdvanceTime(QuicTime::Delta::FromSeconds(1000));
+    for (int i = 0; i < num_handshakes_; ++i) {
+      quiche::QuicheReferenceCountedPointer<QuicSignedServerConfig>
+          signed_config(new QuicSignedServerConfig);
+      config_->ValidateClientHello(client_hello, client_address,
+                                   server_address, transport_version_, &clock,
+                                   signed_config,
+                                   std::make_unique<ValidateCallback>());
+      if (signed_config->config == nullptr) {
+        ++num_handshakes_without_config_;
+      }
+    }
+  }
+
+ private:
+  const QuicCryptoServerConfig* config_;
+  const QuicTransportVersion transport_version_;
+  const int num_handshakes_;
+  int num_handshakes_without_config_ = 0;
+};
+
+// Stands in for a multi-threaded handshake benchmark: handshakes of QUIC
+// crypto clients on several threads must keep seeing a primary config while
+// the configs are rotated.
+TEST_F(CryptoServerConfigsTest, ConcurrentValidateDuringRotation) {
+  QuicTransportVersion transport_version = QUIC_VERSION_UNSUPPORTED;
+  for (const ParsedQuicVersion& version : AllSupportedVersions()) {
+    if (version.handshake_protocol == PROTOCOL_QUIC_CRYPTO) {
+      transport_version = version.transport_version;
+      break;
+    }
+  }
+  ASSERT_NE(transport_version, QUIC_VERSION_UNSUPPORTED);
+  SetConfigs({{"a", 900, 1}, {"b", 1100, 1}});
+
+  constexpr int kNumThreads = 4;
+  std::vector<std::unique_ptr<ValidateThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ValidateThread>(
+        &config_, transport_version, /*num_handshakes=*/200));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < 50; ++i) {
+    if (i % 2 == 0) {
+      SetConfigs({{"b", 900, 1}, {"c", 1100, 1}});
+    } else {
+      SetConfigs({{"a", 900, 1}, {"b", 1100, 1}});
+    }
+  }
+  for (const std::unique_ptr<ValidateThread>& thread : threads) {
+    thread->Join();
+    EXPECT_EQ(0, thread->num_handshakes_without_config());
+  }
+  EXPECT_EQ(2, config_.NumberOfConfigs());
+}
+
 TEST_F(CryptoServerConfigsTest, InvalidConfigs) {
   // Ensure that invalid configs don't change anything.
   SetConfigs({{"a", 800, 1}, {"b", 900, 1}, {"c", 1100, 1}});
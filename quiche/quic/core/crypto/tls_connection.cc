@@ -111,6 +111,9 @@ TlsConnection::TlsConnection(SSL_CTX* ssl_ctx,
       SSL_set_options(ssl(), SSL_OP_NO_TICKET);
     }
   }
+  if (ssl_config_.shed_handshake_config.value_or(false)) {
+    SSL_set_shed_handshake_config(ssl(), 1);
+  }
 }
 
 void TlsConnection::EnableInfoCallback() {
@@ -347,6 +347,8 @@ QuicSSLConfig QuicServerSessionBase::GetSSLConfig() const {
 
   ssl_config.disable_ticket_support =
       GetQuicFlag(FLAGS_quic_disable_server_tls_resumption);
+  ssl_config.shed_handshake_config =
+      GetQuicFlag(FLAGS_quic_shed_tls_server_handshake_config);
 
   if (!crypto_config_ || !crypto_config_->proof_source()) {
     return ssl_config;
@@ -283,6 +283,12 @@ size_t QuicSpdyStream::WriteHeaders(
     header_block["sec-webtransport-http3-draft"] = "draft02";
   }
 
+  if (web_transport_ != nullptr) {
+    // |header_block| may have been modified above, so a static encoding
+    // computed by the caller no longer matches it.
+    static_header_encoding_ = absl::string_view();
+  }
+
   size_t bytes_written =
       WriteHeadersImpl(std::move(header_block), fin, std::move(ack_listener));
   if (!VersionUsesHttp3(transport_version()) && fin) {
@@ -320,6 +326,19 @@ size_t QuicSpdyStream::WriteHeaders(
   return bytes_written;
 }
 
+size_t QuicSpdyStream::WriteHeadersWithStaticEncoding(
+    SpdyHeaderBlock header_block, absl::string_view static_header_encoding,
+    bool fin,
+    quiche::QuicheReferenceCountedPointer<QuicAckListenerInterface>
+        ack_listener) {
+  QUICHE_DCHECK(static_header_encoding_.empty());
+  static_header_encoding_ = static_header_encoding;
+  const size_t bytes_written =
+      WriteHeaders(std::move(header_block), fin, std::move(ack_listener));
+  static_header_encoding_ = absl::string_view();
+  return bytes_written;
+}
+
 void QuicSpdyStream::WriteOrBufferBody(absl::string_view data, bool fin) {
   if (!AssertNotWebTransportDataStream("writing body data")) {
     return;
@@ -1198,12 +1217,25 @@ size_t QuicSpdyStream::WriteHeadersImpl(
         std::move(ack_listener));
   }
 
+  if (!static_header_encoding_.empty() &&
+      !spdy_session_->qpack_encoder()->dynamic_table_in_use()) {
+    return WriteHeadersFrame(header_block, static_header_encoding_,
+                             /* encoder_stream_sent_byte_count = */ 0, fin);
+  }
+
   // Encode header list.
   QuicByteCount encoder_stream_sent_byte_count;
   std::string encoded_headers =
       spdy_session_->qpack_encoder()->EncodeHeaderList(
           id(), header_block, &encoder_stream_sent_byte_count);
+  return WriteHeadersFrame(header_block, encoded_headers,
+                           encoder_stream_sent_byte_count, fin);
+}
 
+size_t QuicSpdyStream::WriteHeadersFrame(
+    const spdy::SpdyHeaderBlock& header_block,
+    absl::string_view encoded_headers,
+    QuicByteCount encoder_stream_sent_byte_count, bool fin) {
   if (spdy_session_->debug_visitor()) {
     spdy_session_->debug_visitor()->OnHeadersFrameSent(id(), header_block);
   }
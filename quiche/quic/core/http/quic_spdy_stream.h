@@ -128,6 +128,18 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
       quiche::QuicheReferenceCountedPointer<QuicAckListenerInterface>
           ack_listener);
 
+  // Same as WriteHeaders(), but when using HTTP/3 and the QPACK encoder does
+  // not use the dynamic table, writes |static_header_encoding| instead of
+  // encoding |header_block|.  |static_header_encoding| must be the result of
+  // QpackEncoder::EncodeHeaderListWithStaticTable() for |header_block|.  It is
+  // ignored if WriteHeaders() adds WebTransport headers to |header_block|.
+  // Subclasses overriding WriteHeaders() must not modify |header_block|.
+  size_t WriteHeadersWithStaticEncoding(
+      spdy::SpdyHeaderBlock header_block,
+      absl::string_view static_header_encoding, bool fin,
+      quiche::QuicheReferenceCountedPointer<QuicAckListenerInterface>
+          ack_listener);
+
   // Sends |data| to the peer, or buffers if it can't be sent immediately.
   virtual void WriteOrBufferBody(absl::string_view data, bool fin);
 
@@ -333,6 +345,13 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
   friend class QuicStreamUtils;
   class HttpDecoderVisitor;
 
+  // Writes a HEADERS frame with |encoded_headers| as payload, and reports it to
+  // the debug visitor and the compression ratio histogram.
+  size_t WriteHeadersFrame(const spdy::SpdyHeaderBlock& header_block,
+                           absl::string_view encoded_headers,
+                           QuicByteCount encoder_stream_sent_byte_count,
+                           bool fin);
+
   struct QUIC_EXPORT_PRIVATE WebTransportDataStream {
     WebTransportDataStream(QuicSpdyStream* stream,
                            WebTransportSessionId session_id);
@@ -453,6 +472,11 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
   // Offset of unacked frame headers.
   QuicIntervalSet<QuicStreamOffset> unacked_frame_headers_offsets_;
 
+  // Set during WriteHeadersWithStaticEncoding(), so that WriteHeadersImpl()
+  // can use it while WriteHeaders() remains the single point where subclasses
+  // intercept header writes.
+  absl::string_view static_header_encoding_;
+
   // Urgency value sent in the last PRIORITY_UPDATE frame, or default urgency
   // defined by the spec if no PRIORITY_UPDATE frame has been sent.
   int last_sent_urgency_;
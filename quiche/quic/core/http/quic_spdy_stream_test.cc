@@ -19,6 +19,7 @@
 #include "quiche/quic/core/http/quic_spdy_session.h"
 #include "quiche/quic/core/http/spdy_utils.h"
 #include "quiche/quic/core/http/web_transport_http3.h"
+#include "quiche/quic/core/qpack/qpack_encoder.h"
 #include "quiche/quic/core/quic_connection.h"
 #include "quiche/quic/core/quic_stream_sequencer_buffer.h"
 #include "quiche/quic/core/quic_utils.h"
@@ -3024,6 +3025,74 @@ TEST_P(QuicSpdyStreamTest, WriteHeadersReturnValue) {
   EXPECT_EQ(headers_frame_payload_length, write_headers_return_value);
 }
 
+TEST_P(QuicSpdyStreamTest, WriteHeadersWithStaticEncoding) {
+  if (!UsesHttp3()) {
+    return;
+  }
+
+  Initialize(kShouldProcessData);
+  testing::InSequence s;
+
+  SpdyHeaderBlock response_headers;
+  response_headers[":status"] = "200";
+  response_headers["foo"] = "bar";
+  const std::string static_header_encoding =
+      QpackEncoder::EncodeHeaderListWithStaticTable(response_headers);
+
+  // The dynamic table is not used, so |static_header_encoding| is written
+  // through the WriteHeaders() override.
+  EXPECT_CALL(*stream_, WriteHeadersMock(true));
+  // HEADERS frame header.
+  EXPECT_CALL(*session_,
+              WritevData(stream_->id(), _, /* offset = */ 0, _, _, _));
+  // HEADERS frame payload.
+  EXPECT_CALL(*session_, WritevData(stream_->id(),
+                                    static_header_encoding.size(), _, _, _, _))
+      .WillOnce(Invoke(session_.get(), &MockQuicSpdySession::ConsumeData));
+
+  EXPECT_EQ(static_header_encoding.size(),
+            stream_->WriteHeadersWithStaticEncoding(std::move(response_headers),
+                                                    static_header_encoding,
+                                                    /*fin=*/true, nullptr));
+  EXPECT_TRUE(stream_->fin_sent());
+}
+
+// WebTransport negotiation adds a header in WriteHeaders(), so the headers are
+// encoded again instead of writing the caller's static encoding.
+TEST_P(QuicSpdyStreamTest, WriteHeadersWithStaticEncodingAndWebTransport) {
+  if (!UsesHttp3()) {
+    return;
+  }
+
+  InitializeWithPerspective(kShouldProcessData, Perspective::IS_CLIENT);
+  session_->set_local_http_datagram_support(HttpDatagramSupport::kDraft00And04);
+  session_->EnableWebTransport();
+  session_->OnSetting(SETTINGS_ENABLE_CONNECT_PROTOCOL, 1);
+  QuicSpdySessionPeer::EnableWebTransport(session_.get());
+  QuicSpdySessionPeer::SetHttpDatagramSupport(session_.get(),
+                                              HttpDatagramSupport::kDraft04);
+
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  EXPECT_CALL(*session_, WritevData(stream_->id(), _, _, _, _, _))
+      .Times(AnyNumber());
+
+  spdy::SpdyHeaderBlock headers;
+  headers[":method"] = "CONNECT";
+  headers[":protocol"] = "webtransport";
+  const std::string static_header_encoding =
+      QpackEncoder::EncodeHeaderListWithStaticTable(headers);
+  spdy::SpdyHeaderBlock sent_headers = headers.Clone();
+  sent_headers["sec-webtransport-http3-draft02"] = "1";
+  const std::string expected_encoding =
+      QpackEncoder::EncodeHeaderListWithStaticTable(sent_headers);
+
+  EXPECT_EQ(expected_encoding.size(),
+            stream_->WriteHeadersWithStaticEncoding(std::move(headers),
+                                                    static_header_encoding,
+                                                    /*fin=*/false, nullptr));
+  ASSERT_TRUE(stream_->web_transport() != nullptr);
+}
+
 // Regression test for https://crbug.com/1177662.
 // RESET_STREAM with QUIC_STREAM_NO_ERROR should not be treated in a special
 // way: it should close the read side but not the write side.
@@ -28,6 +28,17 @@ namespace {
 // TODO(bnc): Fine tune.
 const float kDrainingFraction = 0.25;
 
+// Used by EncodeHeaderListWithStaticTable(), which never reads the decoder
+// stream.
+class NoopDecoderStreamErrorDelegate
+    : public QpackEncoder::DecoderStreamErrorDelegate {
+ public:
+  ~NoopDecoderStreamErrorDelegate() override = default;
+
+  void OnDecoderStreamError(QuicErrorCode /*error_code*/,
+                            absl::string_view /*error_message*/) override {}
+};
+
 }  // anonymous namespace
 
 QpackEncoder::QpackEncoder(
@@ -387,6 +398,17 @@ std::string QpackEncoder::EncodeHeaderList(
   return SecondPassEncode(std::move(representations), required_insert_count);
 }
 
+// static
+std::string QpackEncoder::EncodeHeaderListWithStaticTable(
+    const spdy::Http2HeaderBlock& header_list) {
+  NoopDecoderStreamErrorDelegate decoder_stream_error_delegate;
+  // The dynamic table capacity of a new encoder is zero.
+  QpackEncoder encoder(&decoder_stream_error_delegate);
+  return encoder.EncodeHeaderList(
+      /* stream_id = */ 0, header_list,
+      /* encoder_stream_sent_byte_count = */ nullptr);
+}
+
 bool QpackEncoder::SetMaximumDynamicTableCapacity(
     uint64_t maximum_dynamic_table_capacity) {
   return header_table_.SetMaximumDynamicTableCapacity(
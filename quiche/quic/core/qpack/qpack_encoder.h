@@ -55,6 +55,12 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
                                const spdy::Http2HeaderBlock& header_list,
                                QuicByteCount* encoder_stream_sent_byte_count);
 
+  // Encode a header list referring to the static table only.  The result is
+  // the same as what EncodeHeaderList() returns while dynamic_table_in_use()
+  // is false, and can therefore be computed once and reused on any connection.
+  static std::string EncodeHeaderListWithStaticTable(
+      const spdy::Http2HeaderBlock& header_list);
+
   // Set maximum dynamic table capacity to |maximum_dynamic_table_capacity|,
   // measured in bytes.  Called when SETTINGS_QPACK_MAX_TABLE_CAPACITY is
   // received.  Encoder needs to know this value so that it can calculate
@@ -96,6 +102,12 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
     return header_table_.dynamic_table_entry_referenced();
   }
 
+  // True if the dynamic table capacity is not zero, that is, if header blocks
+  // may refer to dynamic table entries.
+  bool dynamic_table_in_use() const {
+    return header_table_.dynamic_table_capacity() != 0;
+  }
+
   uint64_t maximum_blocked_streams() const { return maximum_blocked_streams_; }
 
   uint64_t MaximumDynamicTableCapacity() const {
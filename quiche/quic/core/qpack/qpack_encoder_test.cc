@@ -157,6 +157,25 @@ TEST_F(QpackEncoderTest, StaticTable) {
   }
 }
 
+TEST_F(QpackEncoderTest, EncodeHeaderListWithStaticTable) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  spdy::Http2HeaderBlock header_list;
+  header_list[":status"] = "200";
+  header_list["content-type"] = "text/plain";
+  header_list["foo"] = "bar";
+
+  EXPECT_FALSE(encoder_.dynamic_table_in_use());
+  EXPECT_EQ(Encode(header_list),
+            QpackEncoder::EncodeHeaderListWithStaticTable(header_list));
+
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  EXPECT_FALSE(encoder_.dynamic_table_in_use());
+
+  encoder_.SetDynamicTableCapacity(4096);
+  EXPECT_TRUE(encoder_.dynamic_table_in_use());
+}
+
 TEST_F(QpackEncoderTest, DecoderStreamError) {
   EXPECT_CALL(decoder_stream_error_delegate_,
               OnDecoderStreamError(QUIC_QPACK_DECODER_STREAM_INTEGER_TOO_LARGE,
@@ -9,6 +9,7 @@
 #include <deque>
 
 #include "absl/strings/string_view.h"
+#include "quiche/quic/core/qpack/qpack_static_table.h"
 #include "quiche/quic/platform/api/quic_export.h"
 #include "quiche/common/quiche_circular_deque.h"
 #include "quiche/spdy/core/hpack/hpack_entry.h"
@@ -283,14 +284,9 @@ class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
 
   // Static Table
 
-  // |static_index_| and |static_name_index_| are owned by QpackStaticTable
-  // singleton.
-
-  // Tracks the unique static entry for a given header name and value.
-  const NameValueToEntryMap& static_index_;
-
-  // Tracks the first static entry for a given header name.
-  const NameToEntryMap& static_name_index_;
+  // Tracks the unique static entry for a given header name and value, and the
+  // first static entry for a given header name.  Built at compile time.
+  const QpackStaticIndex& static_index_;
 
   // Dynamic Table
 
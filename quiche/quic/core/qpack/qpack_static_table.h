@@ -5,10 +5,12 @@
 #ifndef QUICHE_QUIC_CORE_QPACK_QPACK_STATIC_TABLE_H_
 #define QUICHE_QUIC_CORE_QPACK_QPACK_STATIC_TABLE_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "quiche/quic/platform/api/quic_export.h"
 #include "quiche/spdy/core/hpack/hpack_constants.h"
+#include "quiche/spdy/core/hpack/hpack_static_index.h"
 #include "quiche/spdy/core/hpack/hpack_static_table.h"
 
 namespace quic {
@@ -16,6 +18,11 @@ namespace quic {
 using QpackStaticEntry = spdy::HpackStaticEntry;
 using QpackStaticTable = spdy::HpackStaticTable;
 
+// Number of entries in the QPACK static table.
+constexpr size_t kQpackStaticTableSize = 99;
+
+using QpackStaticIndex = spdy::HpackStaticIndex<kQpackStaticTableSize>;
+
 // QPACK static table defined at
 // https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#static-table.
 QUIC_EXPORT_PRIVATE const std::vector<QpackStaticEntry>&
@@ -26,6 +33,9 @@ QpackStaticTableVector();
 // threads. This function is thread-safe.
 QUIC_EXPORT_PRIVATE const QpackStaticTable& ObtainQpackStaticTable();
 
+// Returns the index of the QPACK static table, which is built at compile time.
+QUIC_EXPORT_PRIVATE const QpackStaticIndex& ObtainQpackStaticIndex();
+
 }  // namespace quic
 
 #endif  // QUICHE_QUIC_CORE_QPACK_QPACK_STATIC_TABLE_H_
@@ -4,14 +4,18 @@
 
 #include "quiche/quic/core/quic_coalesced_packet.h"
 
-#include "absl/memory/memory.h"
+#include <cstring>
+#include <memory>
+
 #include "absl/strings/str_cat.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 
 namespace quic {
 
 QuicCoalescedPacket::QuicCoalescedPacket()
-    : length_(0), max_packet_length_(0) {}
+    : length_(0), max_packet_length_(0), encrypted_buffer_length_(0) {
+  Clear();
+}
 
 QuicCoalescedPacket::~QuicCoalescedPacket() { Clear(); }
 
@@ -26,11 +30,11 @@ bool QuicCoalescedPacket::MaybeCoalescePacket(
   }
   if (length_ == 0) {
 #ifndef NDEBUG
-    for (const auto& buffer : encrypted_buffers_) {
-      QUICHE_DCHECK(buffer.empty());
+    for (QuicPacketLength length : encrypted_lengths_) {
+      QUICHE_DCHECK_EQ(0u, length);
     }
 #endif
-    QUICHE_DCHECK(initial_packet_ == nullptr);
+    QUICHE_DCHECK(!initial_packet_.has_value());
     // This is the first packet, set max_packet_length and self/peer
     // addresses.
     max_packet_length_ = current_max_packet_length;
@@ -58,6 +62,15 @@ bool QuicCoalescedPacket::MaybeCoalescePacket(
     // Packet does not fit.
     return false;
   }
+  if (packet.encryption_level != ENCRYPTION_INITIAL &&
+      encrypted_buffer_length_ + packet.encrypted_length >
+          kMaxOutgoingPacketSize) {
+    QUIC_BUG(quic_coalesced_packet_buffer_overflow)
+        << "Coalesced packets exceed kMaxOutgoingPacketSize, "
+           "max_packet_length: "
+        << max_packet_length_;
+    return false;
+  }
   QUIC_DVLOG(1) << "Successfully coalesced packet: encryption_level: "
                 << packet.encryption_level
                 << ", encrypted_length: " << packet.encrypted_length
@@ -71,13 +84,19 @@ bool QuicCoalescedPacket::MaybeCoalescePacket(
   if (packet.encryption_level == ENCRYPTION_INITIAL) {
     // Save a copy of ENCRYPTION_INITIAL packet (excluding encrypted buffer, as
     // the packet will be re-serialized later).
-    initial_packet_ = absl::WrapUnique<SerializedPacket>(
-        CopySerializedPacket(packet, allocator, /*copy_buffer=*/false));
+    initial_packet_.emplace(CopySerializedPacketByValue(
+        packet, allocator, /*copy_buffer=*/false));
     return true;
   }
   // Copy encrypted buffer of packets with other encryption levels.
-  encrypted_buffers_[packet.encryption_level] =
-      std::string(packet.encrypted_buffer, packet.encrypted_length);
+  if (encrypted_buffer_ == nullptr) {
+    encrypted_buffer_ = std::make_unique<char[]>(kMaxOutgoingPacketSize);
+  }
+  memcpy(encrypted_buffer_.get() + encrypted_buffer_length_,
+         packet.encrypted_buffer, packet.encrypted_length);
+  encrypted_offsets_[packet.encryption_level] = encrypted_buffer_length_;
+  encrypted_lengths_[packet.encryption_level] = packet.encrypted_length;
+  encrypted_buffer_length_ += packet.encrypted_length;
   return true;
 }
 
@@ -86,17 +105,18 @@ void QuicCoalescedPacket::Clear() {
   peer_address_ = QuicSocketAddress();
   length_ = 0;
   max_packet_length_ = 0;
-  for (auto& packet : encrypted_buffers_) {
-    packet.clear();
-  }
+  encrypted_buffer_.reset();
+  encrypted_buffer_length_ = 0;
   for (size_t i = ENCRYPTION_INITIAL; i < NUM_ENCRYPTION_LEVELS; ++i) {
+    encrypted_offsets_[i] = 0;
+    encrypted_lengths_[i] = 0;
     transmission_types_[i] = NOT_RETRANSMISSION;
   }
-  initial_packet_ = nullptr;
+  initial_packet_.reset();
 }
 
 void QuicCoalescedPacket::NeuterInitialPacket() {
-  if (initial_packet_ == nullptr) {
+  if (!initial_packet_.has_value()) {
     return;
   }
   if (length_ < initial_packet_->encrypted_length) {
@@ -112,31 +132,32 @@ void QuicCoalescedPacket::NeuterInitialPacket() {
     return;
   }
   transmission_types_[ENCRYPTION_INITIAL] = NOT_RETRANSMISSION;
-  initial_packet_ = nullptr;
+  initial_packet_.reset();
 }
 
 bool QuicCoalescedPacket::CopyEncryptedBuffers(char* buffer, size_t buffer_len,
                                                size_t* length_copied) const {
   *length_copied = 0;
-  for (const auto& packet : encrypted_buffers_) {
-    if (packet.empty()) {
+  for (int8_t i = ENCRYPTION_INITIAL; i < NUM_ENCRYPTION_LEVELS; ++i) {
+    const QuicPacketLength length = encrypted_lengths_[i];
+    if (length == 0) {
       continue;
     }
-    if (packet.length() > buffer_len) {
+    if (length > buffer_len) {
       return false;
     }
-    memcpy(buffer, packet.data(), packet.length());
-    buffer += packet.length();
-    buffer_len -= packet.length();
-    *length_copied += packet.length();
+    memcpy(buffer, encrypted_buffer_.get() + encrypted_offsets_[i], length);
+    buffer += length;
+    buffer_len -= length;
+    *length_copied += length;
   }
   return true;
 }
 
 bool QuicCoalescedPacket::ContainsPacketOfEncryptionLevel(
     EncryptionLevel level) const {
-  return !encrypted_buffers_[level].empty() ||
-         (level == ENCRYPTION_INITIAL && initial_packet_ != nullptr);
+  return encrypted_lengths_[level] != 0 ||
+         (level == ENCRYPTION_INITIAL && initial_packet_.has_value());
 }
 
 TransmissionType QuicCoalescedPacket::TransmissionTypeOfPacket(
@@ -180,12 +201,13 @@ std::string QuicCoalescedPacket::ToString(size_t serialized_length) const {
 
 std::vector<size_t> QuicCoalescedPacket::packet_lengths() const {
   std::vector<size_t> lengths;
-  for (const auto& packet : encrypted_buffers_) {
-    if (lengths.empty()) {
-      lengths.push_back(
-          initial_packet_ == nullptr ? 0 : initial_packet_->encrypted_length);
+  for (int8_t i = ENCRYPTION_INITIAL; i < NUM_ENCRYPTION_LEVELS; ++i) {
+    if (i == ENCRYPTION_INITIAL) {
+      lengths.push_back(initial_packet_.has_value()
+                            ? initial_packet_->encrypted_length
+                            : 0);
     } else {
-      lengths.push_back(packet.length());
+      lengths.push_back(encrypted_lengths_[i]);
     }
   }
   return lengths;
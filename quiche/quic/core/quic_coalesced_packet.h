@@ -5,6 +5,10 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_COALESCED_PACKET_H_
 #define QUICHE_QUIC_CORE_QUIC_COALESCED_PACKET_H_
 
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/core/quic_packets.h"
 
 namespace quic {
@@ -14,10 +18,15 @@ class QuicCoalescedPacketPeer;
 }
 
 // QuicCoalescedPacket is used to buffer multiple packets which can be coalesced
-// into the same UDP datagram.
+// into the same UDP datagram. Encrypted packets are copied into a single
+// buffer, which is only allocated while packets other than ENCRYPTION_INITIAL
+// are coalesced, so that connections that are not coalescing do not pay for
+// it. The ENCRYPTION_INITIAL packet is held inline.
 class QUIC_EXPORT_PRIVATE QuicCoalescedPacket {
  public:
   QuicCoalescedPacket();
+  QuicCoalescedPacket(const QuicCoalescedPacket&) = delete;
+  QuicCoalescedPacket& operator=(const QuicCoalescedPacket&) = delete;
   ~QuicCoalescedPacket();
 
   // Returns true if |packet| is successfully coalesced with existing packets.
@@ -34,9 +43,10 @@ class QUIC_EXPORT_PRIVATE QuicCoalescedPacket {
   // Clears all state associated with initial_packet_.
   void NeuterInitialPacket();
 
-  // Copies encrypted_buffers_ to |buffer| and sets |length_copied| to the
-  // copied amount. Returns false if copy fails (i.e., |buffer_len| is not
-  // enough).
+  // Copies the encrypted packets of all encryption levels but
+  // ENCRYPTION_INITIAL to |buffer|, in the order of their levels, and sets
+  // |length_copied| to the copied amount. Returns false if copy fails (i.e.,
+  // |buffer_len| is not enough).
   bool CopyEncryptedBuffers(char* buffer, size_t buffer_len,
                             size_t* length_copied) const;
 
@@ -53,7 +63,7 @@ class QUIC_EXPORT_PRIVATE QuicCoalescedPacket {
   size_t NumberOfPackets() const;
 
   const SerializedPacket* initial_packet() const {
-    return initial_packet_.get();
+    return initial_packet_.has_value() ? &*initial_packet_ : nullptr;
   }
 
   const QuicSocketAddress& self_address() const { return self_address_; }
@@ -78,17 +88,24 @@ class QUIC_EXPORT_PRIVATE QuicCoalescedPacket {
   // Max packet length. Do not try to coalesce packet when max packet length
   // changes (e.g., with MTU discovery).
   QuicPacketLength max_packet_length_;
-  // Copies of packets' encrypted buffers according to different encryption
-  // levels.
-  std::string encrypted_buffers_[NUM_ENCRYPTION_LEVELS];
+  // Encrypted packets of all encryption levels but ENCRYPTION_INITIAL, in the
+  // order they were coalesced. Allocated with kMaxOutgoingPacketSize bytes when
+  // the first such packet is coalesced, and released by Clear(). They always
+  // fit, as the coalesced packet never exceeds kMaxOutgoingPacketSize.
+  std::unique_ptr<char[]> encrypted_buffer_;
+  // Number of bytes used in encrypted_buffer_.
+  QuicPacketLength encrypted_buffer_length_;
+  // Offset in encrypted_buffer_ and length of the packet of each encryption
+  // level. The length is 0 if there is no such packet.
+  QuicPacketLength encrypted_offsets_[NUM_ENCRYPTION_LEVELS];
+  QuicPacketLength encrypted_lengths_[NUM_ENCRYPTION_LEVELS];
   // Recorded transmission type according to different encryption levels.
   TransmissionType transmission_types_[NUM_ENCRYPTION_LEVELS];
 
   // A copy of ENCRYPTION_INITIAL packet if this coalesced packet contains one.
-  // Null otherwise. Please note, the encrypted_buffer field is not copied. The
-  // frames are copied to allow it be re-serialized when this coalesced packet
-  // gets sent.
-  std::unique_ptr<SerializedPacket> initial_packet_;
+  // Please note, the encrypted_buffer field is not copied. The frames are
+  // copied to allow it be re-serialized when this coalesced packet gets sent.
+  absl::optional<SerializedPacket> initial_packet_;
 };
 
 }  // namespace quic
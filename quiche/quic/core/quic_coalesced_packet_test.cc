@@ -6,6 +6,7 @@
 
 #include "quiche/quic/platform/api/quic_expect_bug.h"
 #include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/quic_coalesced_packet_peer.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
 #include "quiche/common/test_tools/quiche_test_utils.h"
 
@@ -40,6 +41,8 @@ TEST(QuicCoalescedPacketTest, MaybeCoalescePacket) {
   EXPECT_EQ(
       "total_length: 1500 padding_size: 1000 packets: {ENCRYPTION_INITIAL}",
       coalesced.ToString(1500));
+  // The initial packet is not copied into the encrypted buffer.
+  EXPECT_FALSE(QuicCoalescedPacketPeer::HasEncryptedBuffer(coalesced));
 
   // Cannot coalesce packet of the same encryption level.
   SerializedPacket packet2(QuicPacketNumber(2), PACKET_4BYTE_PACKET_NUMBER,
@@ -130,6 +133,55 @@ TEST(QuicCoalescedPacketTest, CopyEncryptedBuffers) {
                                               length_copied, expected, 1000);
 }
 
+TEST(QuicCoalescedPacketTest, CopyEncryptedBuffersInLevelOrder) {
+  QuicCoalescedPacket coalesced;
+  quiche::SimpleBufferAllocator allocator;
+  QuicSocketAddress self_address(QuicIpAddress::Loopback4(), 1);
+  QuicSocketAddress peer_address(QuicIpAddress::Loopback4(), 2);
+  std::string buffer(300, 'a');
+  std::string buffer2(200, 'b');
+  SerializedPacket packet1(QuicPacketNumber(1), PACKET_4BYTE_PACKET_NUMBER,
+                           buffer.data(), 300,
+                           /*has_ack=*/false, /*has_stop_waiting=*/false);
+  packet1.encryption_level = ENCRYPTION_FORWARD_SECURE;
+  SerializedPacket packet2(QuicPacketNumber(2), PACKET_4BYTE_PACKET_NUMBER,
+                           buffer2.data(), 200,
+                           /*has_ack=*/false, /*has_stop_waiting=*/false);
+  packet2.encryption_level = ENCRYPTION_HANDSHAKE;
+
+  // Coalesce the packets out of the order of their encryption levels.
+  EXPECT_FALSE(QuicCoalescedPacketPeer::HasEncryptedBuffer(coalesced));
+  ASSERT_TRUE(coalesced.MaybeCoalescePacket(packet1, self_address, peer_address,
+                                            &allocator, 1500));
+  EXPECT_TRUE(QuicCoalescedPacketPeer::HasEncryptedBuffer(coalesced));
+  ASSERT_TRUE(coalesced.MaybeCoalescePacket(packet2, self_address, peer_address,
+                                            &allocator, 1500));
+  EXPECT_EQ(std::vector<size_t>({0, 200, 0, 300}), coalesced.packet_lengths());
+
+  char copy_buffer[500];
+  size_t length_copied = 0;
+  ASSERT_TRUE(
+      coalesced.CopyEncryptedBuffers(copy_buffer, 500, &length_copied));
+  EXPECT_EQ(500u, length_copied);
+  char expected[500];
+  memset(expected, 'b', 200);
+  memset(expected + 200, 'a', 300);
+  quiche::test::CompareCharArraysWithHexError("copied buffers", copy_buffer,
+                                              length_copied, expected, 500);
+
+  // Clearing releases the buffer, and coalescing allocates it again.
+  coalesced.Clear();
+  EXPECT_EQ(0u, coalesced.NumberOfPackets());
+  EXPECT_FALSE(QuicCoalescedPacketPeer::HasEncryptedBuffer(coalesced));
+  ASSERT_TRUE(coalesced.MaybeCoalescePacket(packet2, self_address, peer_address,
+                                            &allocator, 1500));
+  ASSERT_TRUE(
+      coalesced.CopyEncryptedBuffers(copy_buffer, 500, &length_copied));
+  EXPECT_EQ(200u, length_copied);
+  quiche::test::CompareCharArraysWithHexError("copied buffers", copy_buffer,
+                                              length_copied, expected, 200);
+}
+
 TEST(QuicCoalescedPacketTest, NeuterInitialPacket) {
   QuicCoalescedPacket coalesced;
   EXPECT_EQ("total_length: 0 padding_size: 0 packets: {}",
@@ -16,6 +16,7 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/optimization.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -388,6 +389,10 @@ void QuicConnection::InstallInitialCrypters(QuicConnectionId connection_id) {
 
 QuicConnection::~QuicConnection() {
   QUICHE_DCHECK_GE(stats_.max_egress_mtu, long_term_mtu_);
+  QUIC_BUG_IF(quic_bug_connection_destroyed_in_packet_batch,
+              packet_batch_flusher_ != nullptr)
+      << ENDPOINT << "Connection destroyed before its packet batch ended.";
+  packet_batch_flusher_.reset();
   if (owns_writer_) {
     delete writer_;
   }
@@ -2419,6 +2424,12 @@ void QuicConnection::MaybeSendInResponseToPacket() {
     return;
   }
 
+  if (packet_batch_flusher_ != nullptr) {
+    // Send once the whole batch has been processed.
+    send_in_response_to_packet_batch_ = true;
+    return;
+  }
+
   // Now that we have received an ack, we might be able to send packets which
   // are queued locally, or drain streams which are blocked.
   if (defer_send_in_response_to_packets_) {
@@ -2819,6 +2830,31 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   is_current_packet_connectivity_probing_ = false;
 }
 
+void QuicConnection::BeginPacketBatch() {
+  if (packet_batch_flusher_ != nullptr) {
+    QUIC_BUG(quic_bug_nested_packet_batch)
+        << ENDPOINT << "Nested packet batch.";
+    return;
+  }
+  packet_batch_flusher_ = std::make_unique<ScopedPacketFlusher>(this);
+}
+
+void QuicConnection::EndPacketBatch() {
+  if (packet_batch_flusher_ == nullptr) {
+    QUIC_BUG(quic_bug_no_packet_batch) << ENDPOINT << "No packet batch to end.";
+    return;
+  }
+  // Leave the batch first, so that sending in response is not deferred again.
+  // The ack alarm is set and packets are flushed when |flusher| goes out of
+  // scope.
+  std::unique_ptr<ScopedPacketFlusher> flusher =
+      std::move(packet_batch_flusher_);
+  if (send_in_response_to_packet_batch_) {
+    send_in_response_to_packet_batch_ = false;
+    MaybeSendInResponseToPacket();
+  }
+}
+
 void QuicConnection::OnBlockedWriterCanWrite() {
   writer_->SetWritable();
   OnCanWrite();
@@ -4503,6 +4539,12 @@ void QuicConnection::CloseConnection(
                     << error << "), and details:  " << error_details;
   }
 
+  if (error == QUIC_INTERNAL_ERROR && context_.trace_buffer != nullptr) {
+    for (const std::string& record : context_.trace_buffer->Dump()) {
+      QUIC_LOG(ERROR) << ENDPOINT << "Trace before internal error: " << record;
+    }
+  }
+
   if (connection_close_behavior != ConnectionCloseBehavior::SILENT_CLOSE) {
     SendConnectionClosePacket(error, ietf_error, error_details);
   }
@@ -6021,7 +6063,17 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
-  char buffer[kMaxOutgoingPacketSize];
+  // Serialize directly into the writer's buffer if it has one, so that batch
+  // writers do not copy the coalesced packet again.
+  ABSL_CACHELINE_ALIGNED char stack_buffer[kMaxOutgoingPacketSize];
+  QuicOwnedPacketBuffer packet_buffer(
+      writer_->GetNextWriteLocation(coalesced_packet_.self_address().host(),
+                                    coalesced_packet_.peer_address()));
+  if (packet_buffer.buffer == nullptr) {
+    packet_buffer.buffer = stack_buffer;
+    packet_buffer.release_buffer = nullptr;
+  }
+  char* buffer = packet_buffer.buffer;
   const size_t length = packet_creator_.SerializeCoalescedPacket(
       coalesced_packet_, buffer, coalesced_packet_.max_packet_length());
   if (length == 0) {
@@ -6051,6 +6103,8 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
+  // writer_->WritePacket transfers buffer ownership back to the writer.
+  packet_buffer.release_buffer = nullptr;
   WriteResult result = writer_->WritePacket(
       buffer, length, coalesced_packet_.self_address().host(),
       coalesced_packet_.peer_address(), per_packet_options_);
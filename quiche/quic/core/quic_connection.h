@@ -572,6 +572,13 @@ class QUIC_EXPORT_PRIVATE QuicConnection
                                 const QuicSocketAddress& peer_address,
                                 const QuicReceivedPacket& packet);
 
+  // Packets processed between BeginPacketBatch() and EndPacketBatch() do not
+  // each set the ack alarm, write in response and flush. EndPacketBatch() does
+  // so once for the whole batch.
+  void BeginPacketBatch();
+  void EndPacketBatch();
+  bool in_packet_batch() const { return packet_batch_flusher_ != nullptr; }
+
   // QuicBlockedWriterInterface
   // Called when the underlying connection becomes writable to allow queued
   // writes to happen.
@@ -1233,6 +1240,13 @@ class QUIC_EXPORT_PRIVATE QuicConnection
     context_.bug_listener.swap(bug_listener);
   }
 
+  // Keeps the most recent QUIC_TRACEEVENT records of this connection in
+  // |trace_buffer|, which is logged if the connection is closed with
+  // QUIC_INTERNAL_ERROR.
+  void set_trace_buffer(std::unique_ptr<QuicTraceRingBuffer> trace_buffer) {
+    context_.trace_buffer.swap(trace_buffer);
+  }
+
   absl::optional<QuicWallTime> quic_bug_10511_43_timestamp() const {
     return quic_bug_10511_43_timestamp_;
   }
@@ -1990,6 +2004,11 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // SendAlarm.
   bool defer_send_in_response_to_packets_;
 
+  // Outermost flusher of the current packet batch, if any.
+  std::unique_ptr<ScopedPacketFlusher> packet_batch_flusher_;
+  // True if a packet of the current batch asked to send in response.
+  bool send_in_response_to_packet_batch_ = false;
+
   // TODO(fayang): remove PING related fields below when deprecating
   // quic_use_ping_manager.
   // The timeout for keep-alive PING.
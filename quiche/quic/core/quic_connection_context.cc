@@ -4,6 +4,9 @@
 
 #include "quiche/quic/core/quic_connection_context.h"
 
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
 #include "quiche/common/platform/api/quiche_thread_local.h"
 
 namespace quic {
@@ -11,6 +14,75 @@ namespace {
 DEFINE_QUICHE_THREAD_LOCAL_POINTER(CurrentContext, QuicConnectionContext);
 }  // namespace
 
+void QuicTraceArg::AppendTo(std::string* output) const {
+  switch (type_) {
+    case Type::kNone:
+      break;
+    case Type::kInt:
+      absl::StrAppend(output, int_value_);
+      break;
+    case Type::kUint:
+      absl::StrAppend(output, uint_value_);
+      break;
+    case Type::kLiteral:
+      absl::StrAppend(output, literal_ == nullptr ? "(null)" : literal_);
+      break;
+  }
+}
+
+QuicTraceRecord::QuicTraceRecord(const char* event,
+                                 std::initializer_list<QuicTraceArg> args)
+    : event(event), num_args(std::min(args.size(), kMaxArgs)) {
+  std::copy_n(args.begin(), num_args, this->args);
+}
+
+std::string QuicTraceRecord::ToString() const {
+  std::string output;
+  if (event == nullptr) {
+    return output;
+  }
+  for (const char* p = event; *p != '\0'; ++p) {
+    if (*p == '$' && p[1] >= '0' && p[1] <= '9') {
+      const size_t index = p[1] - '0';
+      if (index < num_args) {
+        args[index].AppendTo(&output);
+      }
+      ++p;
+      continue;
+    }
+    output.push_back(*p);
+  }
+  return output;
+}
+
+QuicTraceRingBuffer::QuicTraceRingBuffer(size_t capacity)
+    : records_(std::max<size_t>(capacity, 1)) {}
+
+void QuicTraceRingBuffer::Record(const QuicTraceRecord& record) {
+  records_[next_] = record;
+  next_ = (next_ + 1) % records_.size();
+  size_ = std::min(size_ + 1, records_.size());
+}
+
+std::vector<std::string> QuicTraceRingBuffer::Dump() const {
+  std::vector<std::string> dump;
+  dump.reserve(size_);
+  const size_t oldest = (next_ + records_.size() - size_) % records_.size();
+  for (size_t i = 0; i < size_; ++i) {
+    dump.push_back(records_[(oldest + i) % records_.size()].ToString());
+  }
+  return dump;
+}
+
+void QuicConnectionContext::Trace(const QuicTraceRecord& record) {
+  if (tracer) {
+    tracer->PrintRecord(record);
+  }
+  if (trace_buffer) {
+    trace_buffer->Record(record);
+  }
+}
+
 // static
 QuicConnectionContext* QuicConnectionContext::Current() {
   return GET_QUICHE_THREAD_LOCAL_POINTER(CurrentContext);
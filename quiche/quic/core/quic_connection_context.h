@@ -5,6 +5,15 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_CONNECTION_CONTEXT_H_
 #define QUICHE_QUIC_CORE_QUIC_CONNECTION_CONTEXT_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/optimization.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "quiche/quic/platform/api/quic_export.h"
@@ -12,6 +21,84 @@
 
 namespace quic {
 
+// A typed argument of a QuicTraceRecord. Integral and enum arguments are
+// captured by value and string literals by address, so capturing an argument
+// never allocates.
+class QUIC_EXPORT_PRIVATE QuicTraceArg {
+ public:
+  QuicTraceArg() : type_(Type::kNone), uint_value_(0) {}
+
+  template <typename T,
+            typename = std::enable_if_t<std::is_integral<T>::value ||
+                                        std::is_enum<T>::value>>
+  QuicTraceArg(T value) {  // NOLINT(google-explicit-constructor)
+    if (std::is_signed<T>::value) {
+      type_ = Type::kInt;
+      int_value_ = static_cast<int64_t>(value);
+    } else {
+      type_ = Type::kUint;
+      uint_value_ = static_cast<uint64_t>(value);
+    }
+  }
+
+  // |literal| must outlive the record, which in practice means it must be a
+  // string literal.
+  QuicTraceArg(const char* literal)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kLiteral), literal_(literal) {}
+
+  // Appends the formatted argument to |output|.
+  void AppendTo(std::string* output) const;
+
+ private:
+  enum class Type : uint8_t { kNone, kInt, kUint, kLiteral };
+
+  Type type_;
+  union {
+    int64_t int_value_;
+    uint64_t uint_value_;
+    const char* literal_;
+  };
+};
+
+// A trace event captured without formatting it. |event| is a string literal
+// which both identifies the event and serves as its format, with $0..$3
+// standing for the arguments as in absl::Substitute.
+struct QUIC_EXPORT_PRIVATE QuicTraceRecord {
+  static constexpr size_t kMaxArgs = 4;
+
+  QuicTraceRecord() = default;
+  QuicTraceRecord(const char* event, std::initializer_list<QuicTraceArg> args);
+
+  // Formats the record. Only called when the record is consumed.
+  std::string ToString() const;
+
+  const char* event = nullptr;
+  size_t num_args = 0;
+  QuicTraceArg args[kMaxArgs];
+};
+
+// A fixed-capacity buffer of the most recent trace records of a connection.
+// All the records are allocated up front, and once full, each new record
+// overwrites the oldest one.
+class QUIC_EXPORT_PRIVATE QuicTraceRingBuffer {
+ public:
+  explicit QuicTraceRingBuffer(size_t capacity);
+
+  void Record(const QuicTraceRecord& record);
+
+  // Returns the formatted records, oldest first.
+  std::vector<std::string> Dump() const;
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return records_.size(); }
+
+ private:
+  std::vector<QuicTraceRecord> records_;
+  // Index of the slot the next record is written to.
+  size_t next_ = 0;
+  size_t size_ = 0;
+};
+
 // QuicConnectionTracer is responsible for emit trace messages for a single
 // QuicConnection.
 // QuicConnectionTracer is part of the QuicConnectionContext.
@@ -34,6 +121,13 @@ class QUIC_EXPORT_PRIVATE QuicConnectionTracer {
     PrintString(s);
   }
 
+  // Emit a structured trace record. The default implementation formats it
+  // with QuicTraceRecord::ToString; tracers may instead keep |record| and
+  // format it later, since it only refers to string literals.
+  virtual void PrintRecord(const QuicTraceRecord& record) {
+    PrintString(record.ToString());
+  }
+
  private:
   friend class QuicConnectionContextSwitcher;
 
@@ -76,8 +170,19 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionContext final {
   // function is not called from a 'top-level' QuicConnection function.
   static QuicConnectionContext* Current();
 
+  // Whether QUIC_TRACEEVENT records anything in this context.
+  bool IsTracing() const {
+    return tracer != nullptr || trace_buffer != nullptr;
+  }
+
+  // Sends |record| to |tracer| and |trace_buffer|, whichever are set.
+  void Trace(const QuicTraceRecord& record);
+
   std::unique_ptr<QuicConnectionTracer> tracer;
   std::unique_ptr<QuicBugListener> bug_listener;
+  // Most recent QUIC_TRACEEVENT records, dumped when the connection is closed
+  // because of an internal error.
+  std::unique_ptr<QuicTraceRingBuffer> trace_buffer;
 };
 
 // QuicConnectionContextSwitcher is a RAII object used for maintaining the
@@ -123,6 +228,23 @@ void QUIC_TRACEPRINTF(const absl::FormatSpec<Args...>& format,
   }
 }
 
+// Emit a structured trace event to the current tracer and trace buffer(if
+// any). |event| must be a string literal, see QuicTraceRecord. Nothing is
+// formatted or allocated here: when tracing is off this costs a single check,
+// and otherwise the arguments are copied into a fixed-size record, e.g.
+//   QUIC_TRACEEVENT("TLS compute signature done. ok:$0, len(signature):$1",
+//                   ok, signature.size());
+template <typename... Args>
+void QUIC_TRACEEVENT(const char* event, const Args&... args) {
+  static_assert(sizeof...(Args) <= QuicTraceRecord::kMaxArgs,
+                "Too many arguments for QUIC_TRACEEVENT");
+  QuicConnectionContext* current = QuicConnectionContext::Current();
+  if (ABSL_PREDICT_TRUE(current == nullptr || !current->IsTracing())) {
+    return;
+  }
+  current->Trace(QuicTraceRecord(event, {QuicTraceArg(args)...}));
+}
+
 inline QuicBugListener* CurrentBugListener() {
   QuicConnectionContext* current = QuicConnectionContext::Current();
   return (current != nullptr) ? current->bug_listener.get() : nullptr;
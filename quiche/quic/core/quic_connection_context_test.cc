@@ -157,6 +157,46 @@ TEST_F(QuicConnectionContextTest, NullTracerOK) {
               ElementsAre("msg 1 recorded"));
 }
 
+TEST_F(QuicConnectionContextTest, TraceEvent) {
+  FakeConnection connection;
+  QUIC_TRACEEVENT("ignored without a context: $0", 1);
+
+  {
+    QuicConnectionContextSwitcher switcher(&connection.context);
+    QUIC_TRACEEVENT("no args");
+    QUIC_TRACEEVENT("ok:$0, len:$1, delta:$2, name:$3", true, size_t{1200},
+                    -3, "literal");
+    QUIC_TRACEEVENT("$1 before $0, missing $2, trailing $", 1, 2);
+  }
+
+  EXPECT_THAT(connection.trace(),
+              ElementsAre("no args", "ok:1, len:1200, delta:-3, name:literal",
+                          "2 before 1, missing , trailing $"));
+}
+
+TEST_F(QuicConnectionContextTest, TraceEventToRingBuffer) {
+  QuicConnectionContext context;
+  {
+    QuicConnectionContextSwitcher switcher(&context);
+    // Dropped since there is neither a tracer nor a trace buffer.
+    QUIC_TRACEEVENT("dropped $0", 0);
+  }
+
+  context.trace_buffer = std::make_unique<QuicTraceRingBuffer>(3);
+  EXPECT_EQ(3u, context.trace_buffer->capacity());
+  {
+    QuicConnectionContextSwitcher switcher(&context);
+    for (int i = 0; i < 5; ++i) {
+      QUIC_TRACEEVENT("event $0", i);
+    }
+  }
+
+  // Only the most recent records are kept, oldest first.
+  EXPECT_EQ(3u, context.trace_buffer->size());
+  EXPECT_THAT(context.trace_buffer->Dump(),
+              ElementsAre("event 2", "event 3", "event 4"));
+}
+
 TEST_F(QuicConnectionContextTest, TestSimpleSwitch) {
   RunInThreads<SimpleSwitch>(10);
 }
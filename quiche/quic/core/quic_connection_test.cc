@@ -6151,6 +6151,26 @@ TEST_P(QuicConnectionTest, SendDelayedAckOnSecondPacket) {
   EXPECT_FALSE(connection_.HasPendingAcks());
 }
 
+TEST_P(QuicConnectionTest, PacketBatchSendsOneAck) {
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+  EXPECT_CALL(visitor_, OnStreamFrame(_)).Times(10);
+  // Without a batch, every second packet would be acked immediately.
+  connection_.BeginPacketBatch();
+  EXPECT_TRUE(connection_.in_packet_batch());
+  for (uint64_t i = 1; i <= 10; ++i) {
+    ProcessDataPacket(i);
+  }
+  EXPECT_EQ(0u, writer_->packets_write_attempts());
+
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _)).Times(1);
+  connection_.EndPacketBatch();
+  EXPECT_FALSE(connection_.in_packet_batch());
+  EXPECT_EQ(1u, writer_->packets_write_attempts());
+  ASSERT_FALSE(writer_->ack_frames().empty());
+  EXPECT_EQ(QuicPacketNumber(10u), LargestAcked(writer_->ack_frames().front()));
+  EXPECT_FALSE(connection_.HasPendingAcks());
+}
+
 TEST_P(QuicConnectionTest, NoAckOnOldNacks) {
   EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
   EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _)).Times(0);
@@ -9957,8 +9977,8 @@ TEST_P(QuicConnectionTest, FailToCoalescePacket) {
                                                 coalesced_packet.length());
 
     // Make the coalescer's FORWARD_SECURE packet longer.
-    *QuicCoalescedPacketPeer::GetMutableEncryptedBuffer(
-        coalesced_packet, ENCRYPTION_FORWARD_SECURE) += "!!! TEST !!!";
+    QuicCoalescedPacketPeer::ExtendEncryptedPacket(
+        coalesced_packet, ENCRYPTION_FORWARD_SECURE, 12);
 
     QUIC_LOG(INFO) << "Reduced coalesced_packet_max_length from "
                    << coalesced_packet_max_length << " to "
@@ -285,6 +285,9 @@ static const int kDefaultIetfLossDelayShift = 3;
 const QuicPacketCount kDefaultRetransmittablePacketsBeforeAck = 2;
 // Wait for up to 10 retransmittable packets before sending an ack.
 const QuicPacketCount kMaxRetransmittablePacketsBeforeAck = 10;
+// Upper bound of the number of retransmittable packets received before sending
+// an ack when ack decimation adapts to the packet rate.
+const QuicPacketCount kMaxAdaptiveRetransmittablePacketsBeforeAck = 128;
 // Minimum number of packets received before ack decimation is enabled.
 // This intends to avoid the beginning of slow start, when CWNDs may be
 // rapidly increasing.
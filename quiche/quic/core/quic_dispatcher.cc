@@ -4,6 +4,7 @@
 
 #include "quiche/quic/core/quic_dispatcher.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -39,6 +40,34 @@ namespace {
 // Minimal INITIAL packet length sent by clients is 1200.
 const QuicPacketLength kMinClientInitialPacketLength = 1200;
 
+// Minimal length of a long header: the type byte, the version and a connection
+// ID length byte.
+const size_t kMinLongHeaderPacketLength =
+    kPacketHeaderTypeSize + kQuicVersionSize + kConnectionIdLengthSize;
+
+// Returns true if the first byte and the length of |packet| already rule out a
+// valid public header, so that scanning traffic is dropped before parsing.
+// |min_short_header_length| is the minimal length of an IETF short header.
+bool FailsHeaderPreFilter(const QuicReceivedPacket& packet,
+                          size_t min_short_header_length) {
+  if (packet.length() == 0) {
+    return true;
+  }
+  const uint8_t first_byte = static_cast<uint8_t>(packet.data()[0]);
+  // Same first byte check as QuicFramer::ParsePublicHeaderDispatcher.
+  if ((first_byte & (FLAGS_LONG_HEADER | FLAGS_FIXED_BIT |
+                     FLAGS_DEMULTIPLEXING_BIT)) == 0) {
+    return true;
+  }
+  size_t min_length = kPacketHeaderTypeSize;
+  if (first_byte & FLAGS_LONG_HEADER) {
+    min_length = kMinLongHeaderPacketLength;
+  } else if (first_byte & FLAGS_FIXED_BIT) {
+    min_length = min_short_header_length;
+  }
+  return packet.length() < min_length;
+}
+
 // An alarm that informs the QuicDispatcher to delete old sessions.
 class DeleteSessionsAlarm : public QuicAlarm::DelegateWithoutContext {
  public:
@@ -381,6 +410,17 @@ void QuicDispatcher::ProcessPacket(const QuicSocketAddress& self_address,
                 << " bytes:" << std::endl
                 << quiche::QuicheTextUtils::HexDump(
                        absl::string_view(packet.data(), packet.length()));
+  ++packets_processed_in_current_read_event_;
+  const size_t min_short_header_length =
+      kPacketHeaderTypeSize +
+      (should_update_expected_server_connection_id_length_
+           ? 0
+           : expected_server_connection_id_length_);
+  if (FailsHeaderPreFilter(packet, min_short_header_length)) {
+    QUIC_CODE_COUNT(quic_dispatcher_packet_fails_header_pre_filter);
+    SetLastError(QUIC_INVALID_PACKET_HEADER);
+    return;
+  }
   ReceivedPacketInfo packet_info(self_address, peer_address, packet);
   std::string detailed_error;
   const QuicErrorCode error = QuicFramer::ParsePublicHeaderDispatcher(
@@ -597,8 +637,7 @@ bool QuicDispatcher::MaybeDispatchPacket(
         }
       }
     }
-    it->second->ProcessUdpPacket(packet_info.self_address,
-                                 packet_info.peer_address, packet_info.packet);
+    ProcessPacketForSession(it->second, packet_info);
     return true;
   }
   if (packet_info.version.IsKnown()) {
@@ -616,9 +655,7 @@ bool QuicDispatcher::MaybeDispatchPacket(
       if (it2 != reference_counted_session_map_.end()) {
         QUICHE_DCHECK(
             !buffered_packets_.HasBufferedPackets(replaced_connection_id));
-        it2->second->ProcessUdpPacket(packet_info.self_address,
-                                      packet_info.peer_address,
-                                      packet_info.packet);
+        ProcessPacketForSession(it2->second, packet_info);
         return true;
       }
     }
@@ -696,6 +733,14 @@ bool QuicDispatcher::MaybeDispatchPacket(
       QUIC_CODE_COUNT(quic_drop_small_initial_packets);
       return true;
     }
+
+    // Only shed packets which could create a connection, once they have been
+    // validated, so that shedding never responds to spoofed or tiny packets.
+    if ((packet_info.form != IETF_QUIC_LONG_HEADER_PACKET ||
+         packet_info.long_packet_type == INITIAL) &&
+        MaybeShedNewConnection(packet_info)) {
+      return true;
+    }
   }
 
   return false;
@@ -1189,8 +1234,17 @@ void QuicDispatcher::OnExpiredPackets(
 }
 
 void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
+  if (overload_controller_.level() >=
+      QuicOverloadController::kRejectNewConnections) {
+    // No session will be created at this level, so the buffered CHLOs would
+    // only wait to expire.
+    ShedBufferedChlos();
+    return;
+  }
   // Reset the counter before starting creating connections.
-  new_sessions_allowed_per_event_loop_ = max_connections_to_create;
+  new_sessions_allowed_per_event_loop_ =
+      overload_controller_.MaxNewSessionsPerEventLoop(
+          max_connections_to_create);
   for (; new_sessions_allowed_per_event_loop_ > 0;
        --new_sessions_allowed_per_event_loop_) {
     QuicConnectionId server_connection_id;
@@ -1236,10 +1290,85 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
   }
 }
 
+void QuicDispatcher::ShedBufferedChlos() {
+  new_sessions_allowed_per_event_loop_ = 0;
+  const bool reject = overload_controller_.level() ==
+                      QuicOverloadController::kRejectNewConnections;
+  while (buffered_packets_.HasChlosBuffered()) {
+    QuicConnectionId server_connection_id;
+    BufferedPacketList packet_list =
+        buffered_packets_.DeliverPacketsForNextConnection(
+            &server_connection_id);
+    if (packet_list.buffered_packets.empty()) {
+      return;
+    }
+    if (!reject) {
+      QUIC_CODE_COUNT(quic_dispatcher_dropped_buffered_chlo_on_overload);
+      overload_controller_.OnNewConnectionPacketDropped();
+      continue;
+    }
+    QUIC_CODE_COUNT(quic_dispatcher_rejected_buffered_chlo_on_overload);
+    overload_controller_.OnNewConnectionRejected();
+    const PacketHeaderFormat format = packet_list.ietf_quic
+                                          ? IETF_QUIC_LONG_HEADER_PACKET
+                                          : GOOGLE_QUIC_PACKET;
+    StatelesslyTerminateConnection(
+        server_connection_id, format, /*version_flag=*/true,
+        packet_list.version.HasLengthPrefixedConnectionIds(),
+        packet_list.version, QUIC_SERVER_OVERLOADED, "Server overloaded",
+        quic::QuicTimeWaitListManager::SEND_STATELESS_RESET);
+    // Answer the last buffered packet so that the client learns about the
+    // rejection without having to retransmit.
+    const BufferedPacket& packet = packet_list.buffered_packets.back();
+    time_wait_list_manager()->ProcessPacket(
+        packet.self_address, packet.peer_address, server_connection_id, format,
+        packet.packet->length(), GetPerPacketContext());
+    OnNewConnectionRejected();
+  }
+}
+
 bool QuicDispatcher::HasChlosBuffered() const {
   return buffered_packets_.HasChlosBuffered();
 }
 
+void QuicDispatcher::OnPacketBatchStart() {
+  QUICHE_DCHECK(!in_packet_batch_);
+  in_packet_batch_ = true;
+}
+
+void QuicDispatcher::OnPacketBatchEnd() {
+  in_packet_batch_ = false;
+  std::vector<std::shared_ptr<QuicSession>> sessions;
+  sessions.swap(packet_batch_sessions_);
+  for (const std::shared_ptr<QuicSession>& session : sessions) {
+    session->connection()->EndPacketBatch();
+  }
+}
+
+void QuicDispatcher::ProcessPacketForSession(
+    const std::shared_ptr<QuicSession>& session,
+    const ReceivedPacketInfo& packet_info) {
+  if (in_packet_batch_ && session->connection()->connected() &&
+      !session->connection()->in_packet_batch()) {
+    session->connection()->BeginPacketBatch();
+    packet_batch_sessions_.push_back(session);
+  }
+  session->ProcessUdpPacket(packet_info.self_address, packet_info.peer_address,
+                            packet_info.packet);
+}
+
+void QuicDispatcher::OnReadEventComplete() {
+  ++event_loop_stats_.read_events;
+  event_loop_stats_.packets_processed +=
+      packets_processed_in_current_read_event_;
+  event_loop_stats_.packets_processed_in_last_read_event =
+      packets_processed_in_current_read_event_;
+  event_loop_stats_.max_packets_processed_per_read_event =
+      std::max(event_loop_stats_.max_packets_processed_per_read_event,
+               packets_processed_in_current_read_event_);
+  packets_processed_in_current_read_event_ = 0;
+}
+
 bool QuicDispatcher::ShouldCreateOrBufferPacketForConnection(
     const ReceivedPacketInfo& packet_info) {
   QUIC_VLOG(1) << "Received packet from new connection "
@@ -1375,6 +1504,36 @@ void QuicDispatcher::DeliverPacketsToSession(
   }
 }
 
+bool QuicDispatcher::MaybeShedNewConnection(
+    const ReceivedPacketInfo& packet_info) {
+  switch (overload_controller_.level()) {
+    case QuicOverloadController::kNotOverloaded:
+    case QuicOverloadController::kLimitNewConnections:
+      return false;
+    case QuicOverloadController::kRejectNewConnections:
+      QUIC_CODE_COUNT(quic_dispatcher_rejected_new_connection_on_overload);
+      overload_controller_.OnNewConnectionRejected();
+      StatelesslyTerminateConnection(
+          packet_info.destination_connection_id, packet_info.form,
+          packet_info.version_flag, packet_info.use_length_prefix,
+          packet_info.version, QUIC_SERVER_OVERLOADED, "Server overloaded",
+          quic::QuicTimeWaitListManager::SEND_STATELESS_RESET);
+      time_wait_list_manager()->ProcessPacket(
+          packet_info.self_address, packet_info.peer_address,
+          packet_info.destination_connection_id, packet_info.form,
+          packet_info.packet.length(), GetPerPacketContext());
+      OnNewConnectionRejected();
+      return true;
+    case QuicOverloadController::kDropNewConnections:
+      // Responding costs a write; spend the event loop on established
+      // connections instead.
+      QUIC_CODE_COUNT(quic_dispatcher_dropped_new_connection_on_overload);
+      overload_controller_.OnNewConnectionPacketDropped();
+      return true;
+  }
+  return false;
+}
+
 bool QuicDispatcher::IsSupportedVersion(const ParsedQuicVersion version) {
   for (const ParsedQuicVersion& supported_version :
        version_manager_->GetSupportedVersions()) {
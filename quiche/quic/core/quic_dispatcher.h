@@ -22,6 +22,7 @@
 #include "quiche/quic/core/quic_connection.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_crypto_server_stream_base.h"
+#include "quiche/quic/core/quic_overload_controller.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/core/quic_process_packet_interface.h"
 #include "quiche/quic/core/quic_session.h"
@@ -69,6 +70,12 @@ class QUIC_NO_EXPORT QuicDispatcher
                      const QuicSocketAddress& peer_address,
                      const QuicReceivedPacket& packet) override;
 
+  // Packets of established sessions passed to ProcessPacket() between these
+  // calls are processed as one batch per connection, see
+  // QuicConnection::BeginPacketBatch().
+  void OnPacketBatchStart() override;
+  void OnPacketBatchEnd() override;
+
   // Called when the socket becomes writable to allow queued writes to happen.
   virtual void OnCanWrite();
 
@@ -140,7 +147,9 @@ class QUIC_NO_EXPORT QuicDispatcher
                         QuicBufferedPacketStore::BufferedPacketList
                             early_arrived_packets) override;
 
-  // Create connections for previously buffered CHLOs as many as allowed.
+  // Create connections for previously buffered CHLOs as many as allowed. While
+  // the overload controller rejects or drops new connections, the buffered
+  // CHLOs are rejected or dropped instead.
   virtual void ProcessBufferedChlos(size_t max_connections_to_create);
 
   // Return true if there is CHLO buffered.
@@ -162,6 +171,35 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   bool accept_new_connections() const { return accept_new_connections_; }
 
+  // Counters describing how many packets the dispatcher handles per event loop
+  // read event. Together with the event loop's own stats they show whether the
+  // loop keeps up with the socket.
+  struct QUIC_NO_EXPORT EventLoopStats {
+    // Number of completed read events, see OnReadEventComplete().
+    uint64_t read_events = 0;
+    // Total number of packets passed to ProcessPacket().
+    uint64_t packets_processed = 0;
+    // Packets processed during the most recent and the busiest read event.
+    uint64_t packets_processed_in_last_read_event = 0;
+    uint64_t max_packets_processed_per_read_event = 0;
+  };
+
+  // Called by the owner of the dispatcher once it is done reading packets for
+  // one event loop iteration. Folds the packets processed since the previous
+  // call into event_loop_stats().
+  void OnReadEventComplete();
+
+  const EventLoopStats& event_loop_stats() const { return event_loop_stats_; }
+
+  // Decides whether new connections are shed because the event loop is
+  // overloaded. Owners feed it one sample per event loop iteration.
+  QuicOverloadController* overload_controller() {
+    return &overload_controller_;
+  }
+  const QuicOverloadController& overload_controller() const {
+    return overload_controller_;
+  }
+
  protected:
   // Creates a QUIC session based on the given information.
   // |alpn| is the selected ALPN from |parsed_chlo.alpns|.
@@ -389,6 +427,18 @@ class QUIC_NO_EXPORT QuicDispatcher
   // Returns true if |version| is a supported protocol version.
   bool IsSupportedVersion(const ParsedQuicVersion version);
 
+  // Passes the packet in |packet_info| to the established |session|, as part
+  // of the current packet batch if there is one.
+  void ProcessPacketForSession(const std::shared_ptr<QuicSession>& session,
+                               const ReceivedPacketInfo& packet_info);
+
+  // Rejects or drops a packet of a new connection, as decided by
+  // overload_controller_. Returns true if the packet has been handled.
+  bool MaybeShedNewConnection(const ReceivedPacketInfo& packet_info);
+
+  // Rejects or drops all buffered CHLOs, as decided by overload_controller_.
+  void ShedBufferedChlos();
+
   const QuicConfig* config_;
 
   const QuicCryptoServerConfig* crypto_config_;
@@ -467,6 +517,20 @@ class QUIC_NO_EXPORT QuicDispatcher
   // If true, change expected_server_connection_id_length_ to be the received
   // destination connection ID length of all IETF long headers.
   bool should_update_expected_server_connection_id_length_;
+
+  EventLoopStats event_loop_stats_;
+
+  QuicOverloadController overload_controller_;
+
+  // Number of packets passed to ProcessPacket() since the last call to
+  // OnReadEventComplete().
+  uint64_t packets_processed_in_current_read_event_ = 0;
+
+  // True between OnPacketBatchStart() and OnPacketBatchEnd().
+  bool in_packet_batch_ = false;
+  // Sessions whose connection is in a packet batch, kept alive until
+  // OnPacketBatchEnd().
+  std::vector<std::shared_ptr<QuicSession>> packet_batch_sessions_;
 };
 
 }  // namespace quic
@@ -732,6 +732,39 @@ TEST_P(QuicDispatcherTestAllVersions, ProcessPackets) {
   ProcessPacket(client_address, TestConnectionId(1), false, "data");
 }
 
+TEST_P(QuicDispatcherTestAllVersions, ProcessPacketBatch) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+
+  EXPECT_CALL(
+      *dispatcher_,
+      CreateQuicSession(TestConnectionId(1), _, client_address,
+                        Eq(ExpectedAlpn()), _, Eq(ParsedClientHelloForTest())))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(1), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  MockQuicConnection* connection =
+      reinterpret_cast<MockQuicConnection*>(session1_->connection());
+  EXPECT_CALL(*connection, ProcessUdpPacket(_, _, _))
+      .WillOnce(WithoutArgs(Invoke(
+          [connection]() { EXPECT_FALSE(connection->in_packet_batch()); })));
+  EXPECT_CALL(*dispatcher_,
+              ShouldCreateOrBufferPacketForConnection(
+                  ReceivedPacketInfoConnectionIdEquals(TestConnectionId(1))));
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+
+  // Packets of an established session are processed in one batch.
+  EXPECT_CALL(*connection, ProcessUdpPacket(_, _, _))
+      .Times(2)
+      .WillRepeatedly(WithoutArgs(Invoke(
+          [connection]() { EXPECT_TRUE(connection->in_packet_batch()); })));
+  dispatcher_->OnPacketBatchStart();
+  ProcessPacket(client_address, TestConnectionId(1), false, "data");
+  ProcessPacket(client_address, TestConnectionId(1), false, "data");
+  dispatcher_->OnPacketBatchEnd();
+  EXPECT_FALSE(connection->in_packet_batch());
+}
+
 // Regression test of b/93325907.
 TEST_P(QuicDispatcherTestAllVersions, DispatcherDoesNotRejectPacketNumberZero) {
   QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
@@ -971,6 +1004,31 @@ TEST_P(QuicDispatcherTestOneVersion, DropPacketWithInvalidFlags) {
   dispatcher_->ProcessPacket(server_address_, client_address, packet);
 }
 
+TEST_P(QuicDispatcherTestOneVersion, EventLoopStats) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  CreateTimeWaitListManager();
+  uint8_t all_zero_packet[1200] = {};
+  QuicReceivedPacket packet(reinterpret_cast<char*>(all_zero_packet),
+                            sizeof(all_zero_packet), QuicTime::Zero());
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+
+  // Dropped packets still count as processed.
+  dispatcher_->ProcessPacket(server_address_, client_address, packet);
+  dispatcher_->ProcessPacket(server_address_, client_address, packet);
+  dispatcher_->ProcessPacket(server_address_, client_address, packet);
+  EXPECT_EQ(0u, dispatcher_->event_loop_stats().packets_processed);
+  dispatcher_->OnReadEventComplete();
+  dispatcher_->ProcessPacket(server_address_, client_address, packet);
+  dispatcher_->OnReadEventComplete();
+
+  const QuicDispatcher::EventLoopStats& stats =
+      dispatcher_->event_loop_stats();
+  EXPECT_EQ(2u, stats.read_events);
+  EXPECT_EQ(4u, stats.packets_processed);
+  EXPECT_EQ(1u, stats.packets_processed_in_last_read_event);
+  EXPECT_EQ(3u, stats.max_packets_processed_per_read_event);
+}
+
 TEST_P(QuicDispatcherTestAllVersions, LimitResetsToSameClientAddress) {
   CreateTimeWaitListManager();
 
@@ -1498,6 +1556,41 @@ static_assert(quic::SupportedVersions().size() == 6u,
               "Please add new RejectDeprecatedVersion tests above this assert "
               "when deprecating versions");
 
+TEST_P(QuicDispatcherTestOneVersion, DropPacketsFailingHeaderPreFilter) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  CreateTimeWaitListManager();
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(*time_wait_list_manager_, ProcessPacket(_, _, _, _, _, _))
+      .Times(0);
+  EXPECT_CALL(*time_wait_list_manager_,
+              SendVersionNegotiationPacket(_, _, _, _, _, _, _, _))
+      .Times(0);
+  EXPECT_CALL(*time_wait_list_manager_, SendPublicReset(_, _, _, _, _, _))
+      .Times(0);
+
+  // Long header too short to carry a version and connection IDs.
+  uint8_t long_header_packet[] = {0xC0, 0xFF, 0x00, 0x00, 28};
+  dispatcher_->ProcessPacket(
+      server_address_, client_address,
+      QuicReceivedPacket(reinterpret_cast<char*>(long_header_packet),
+                         ABSL_ARRAYSIZE(long_header_packet), QuicTime::Zero()));
+
+  // Short header too short to carry the server connection ID.
+  uint8_t short_header_packet[] = {0x40, 0x01, 0x02, 0x03};
+  dispatcher_->ProcessPacket(
+      server_address_, client_address,
+      QuicReceivedPacket(reinterpret_cast<char*>(short_header_packet),
+                         ABSL_ARRAYSIZE(short_header_packet),
+                         QuicTime::Zero()));
+
+  // Invalid first byte.
+  uint8_t invalid_packet[kMinPacketSizeForVersionNegotiation] = {0x00};
+  dispatcher_->ProcessPacket(
+      server_address_, client_address,
+      QuicReceivedPacket(reinterpret_cast<char*>(invalid_packet),
+                         ABSL_ARRAYSIZE(invalid_packet), QuicTime::Zero()));
+}
+
 TEST_P(QuicDispatcherTestOneVersion, VersionNegotiationProbe) {
   QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
   CreateTimeWaitListManager();
@@ -1785,6 +1878,111 @@ TEST_P(QuicDispatcherTestAllVersions, StopAcceptingNewConnections) {
   ProcessPacket(client_address, TestConnectionId(1), false, "data");
 }
 
+TEST_P(QuicDispatcherTestAllVersions, RejectNewConnectionsWhenOverloaded) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(TestConnectionId(1), _, client_address,
+                                Eq(ExpectedAlpn()), _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(1), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(WithArg<2>(Invoke([this](const QuicEncryptedPacket& packet) {
+        ValidatePacket(TestConnectionId(1), packet);
+      })));
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_loop_lag_threshold(
+      QuicTime::Delta::FromMilliseconds(10));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(20), 0));
+
+  // New connections are rejected.
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(TestConnectionId(2), _, client_address,
+                                Eq(ExpectedAlpn()), _, _))
+      .Times(0u);
+  ProcessFirstFlight(client_address, TestConnectionId(2));
+  EXPECT_EQ(1u, overload_controller->stats().new_connections_rejected);
+  EXPECT_TRUE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(2)));
+
+  // Existing connections should be able to continue.
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .Times(1u)
+      .WillOnce(WithArg<2>(Invoke([this](const QuicEncryptedPacket& packet) {
+        ValidatePacket(TestConnectionId(1), packet);
+      })));
+  ProcessPacket(client_address, TestConnectionId(1), false, "data");
+}
+
+// Only valid packets which could create a connection are shed, so overload
+// never makes the dispatcher respond to packets it would otherwise ignore.
+TEST_P(QuicDispatcherTestOneVersion, OverloadDoesNotShedInvalidPackets) {
+  CreateTimeWaitListManager();
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_loop_lag_threshold(
+      QuicTime::Delta::FromMilliseconds(10));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(20), 0));
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+
+  // Unsupported versions still get version negotiation.
+  EXPECT_CALL(
+      *time_wait_list_manager_,
+      SendVersionNegotiationPacket(TestConnectionId(1), _, _, _, _, _, _, _))
+      .Times(1);
+  ProcessFirstFlight(QuicVersionReservedForNegotiation(), client_address,
+                     TestConnectionId(1));
+
+  // Initial packets which are too small are still dropped silently.
+  std::string chlo = SerializeCHLO() + std::string(1200, 'a');
+  std::string truncated_chlo = chlo.substr(0, 1100);
+  ProcessPacket(client_address, TestConnectionId(2), true, version_,
+                truncated_chlo, false, CONNECTION_ID_PRESENT,
+                PACKET_4BYTE_PACKET_NUMBER, 1);
+
+  EXPECT_EQ(0u, overload_controller->stats().new_connections_rejected);
+  EXPECT_FALSE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(1)));
+  EXPECT_FALSE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(2)));
+}
+
+TEST_P(QuicDispatcherTestAllVersions, DropNewConnectionsWhenOverloaded) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_loop_lag_threshold(
+      QuicTime::Delta::FromMilliseconds(10));
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(40), 0));
+
+  // Packets of new connections are dropped without a response.
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0u);
+  EXPECT_CALL(*time_wait_list_manager_, ProcessPacket(_, _, _, _, _, _))
+      .Times(0u);
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+  EXPECT_EQ(1u, overload_controller->stats().new_connection_packets_dropped);
+  EXPECT_FALSE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(1)));
+}
+
 TEST_P(QuicDispatcherTestAllVersions, StartAcceptingNewConnections) {
   dispatcher_->StopAcceptingNewConnections();
   QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
@@ -2727,6 +2925,75 @@ TEST_P(BufferedPacketStoreTest, BufferDuplicatedCHLO) {
   dispatcher_->ProcessBufferedChlos(kMaxNumSessionsToCreate);
 }
 
+// Under kRejectNewConnections, CHLOs buffered while sessions were limited are
+// rejected instead of waiting in the store until they expire.
+TEST_P(BufferedPacketStoreTest, RejectBufferedChlosWhenOverloaded) {
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_loop_lag_threshold(
+      QuicTime::Delta::FromMilliseconds(10));
+  overload_controller->set_limited_sessions_per_event_loop(0);
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(10), 0));
+  dispatcher_->ProcessBufferedChlos(kMaxNumSessionsToCreate);
+
+  // No session is allowed in this event loop, so both CHLOs are buffered.
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+  ProcessFirstFlight(TestConnectionId(1));
+  ProcessFirstFlight(TestConnectionId(2));
+  QuicBufferedPacketStore* store =
+      QuicDispatcherPeer::GetBufferedPackets(dispatcher_.get());
+  EXPECT_TRUE(store->HasChlosBuffered());
+
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(20), 0));
+  EXPECT_CALL(*time_wait_list_manager_, ProcessPacket(_, _, _, _, _, _))
+      .Times(2);
+  dispatcher_->ProcessBufferedChlos(kMaxNumSessionsToCreate);
+  EXPECT_FALSE(store->HasChlosBuffered());
+  EXPECT_EQ(2u, overload_controller->stats().new_connections_rejected);
+  EXPECT_TRUE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(1)));
+  EXPECT_TRUE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(2)));
+}
+
+// Under kDropNewConnections, buffered CHLOs are dropped without a response.
+TEST_P(BufferedPacketStoreTest, DropBufferedChlosWhenOverloaded) {
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_loop_lag_threshold(
+      QuicTime::Delta::FromMilliseconds(10));
+  overload_controller->set_limited_sessions_per_event_loop(0);
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(10), 0));
+  dispatcher_->ProcessBufferedChlos(kMaxNumSessionsToCreate);
+
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+  ProcessFirstFlight(TestConnectionId(1));
+  QuicBufferedPacketStore* store =
+      QuicDispatcherPeer::GetBufferedPackets(dispatcher_.get());
+  EXPECT_TRUE(store->HasChlosBuffered());
+
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections,
+            overload_controller->OnEventLoopSample(
+                mock_helper_.GetClock()->Now(),
+                QuicTime::Delta::FromMilliseconds(40), 0));
+  EXPECT_CALL(*time_wait_list_manager_, ProcessPacket(_, _, _, _, _, _))
+      .Times(0);
+  dispatcher_->ProcessBufferedChlos(kMaxNumSessionsToCreate);
+  EXPECT_FALSE(store->HasChlosBuffered());
+  EXPECT_EQ(1u, overload_controller->stats().new_connection_packets_dropped);
+  EXPECT_FALSE(time_wait_list_manager_->IsConnectionIdInTimeWait(
+      TestConnectionId(1)));
+}
+
 TEST_P(BufferedPacketStoreTest, BufferNonChloPacketsUptoLimitWithChloBuffered) {
   uint64_t last_conn_id = kMaxNumSessionsToCreate + 1;
   QuicConnectionId last_connection_id = TestConnectionId(last_conn_id);
@@ -0,0 +1,140 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_overload_controller.h"
+
+#include <algorithm>
+
+#include "quiche/quic/platform/api/quic_flags.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Lag and drop thresholds of the higher levels are multiples of the
+// configured ones.
+constexpr int kRejectThresholdMultiplier = 2;
+constexpr int kDropThresholdMultiplier = 4;
+
+// Time the signals need to stay below a level before stepping down from it.
+constexpr QuicTime::Delta kDefaultCoolDownPeriod =
+    QuicTime::Delta::FromSeconds(1);
+
+// Sessions created per event loop while limiting new connections.
+constexpr size_t kDefaultLimitedSessionsPerEventLoop = 1;
+
+}  // namespace
+
+QuicOverloadController::QuicOverloadController()
+    : level_(kNotOverloaded),
+      last_level_change_time_(QuicTime::Zero()),
+      last_overloaded_sample_time_(QuicTime::Zero()),
+      last_total_packets_dropped_(0),
+      has_drop_baseline_(false),
+      loop_lag_threshold_(QuicTime::Delta::Infinite()),
+      kernel_drops_threshold_(
+          GetQuicFlag(FLAGS_quic_overload_kernel_drops_threshold)),
+      cool_down_period_(kDefaultCoolDownPeriod),
+      limited_sessions_per_event_loop_(kDefaultLimitedSessionsPerEventLoop) {
+  const int64_t lag_threshold_us =
+      GetQuicFlag(FLAGS_quic_overload_loop_lag_threshold_us);
+  if (lag_threshold_us > 0) {
+    loop_lag_threshold_ = QuicTime::Delta::FromMicroseconds(lag_threshold_us);
+  }
+}
+
+QuicOverloadController::Level QuicOverloadController::OnEventLoopSample(
+    QuicTime now, QuicTime::Delta loop_lag,
+    QuicPacketCount total_packets_dropped) {
+  QuicPacketCount packets_dropped = 0;
+  // The kernel counter is cumulative and may wrap; the first sample only
+  // establishes the baseline.
+  if (has_drop_baseline_ &&
+      total_packets_dropped >= last_total_packets_dropped_) {
+    packets_dropped = total_packets_dropped - last_total_packets_dropped_;
+  }
+  last_total_packets_dropped_ = total_packets_dropped;
+  has_drop_baseline_ = true;
+
+  const Level sample_level = LevelForSample(loop_lag, packets_dropped);
+  Level new_level = level_;
+  if (sample_level >= level_) {
+    last_overloaded_sample_time_ = now;
+    new_level = sample_level;
+  } else if (now - last_overloaded_sample_time_ >= cool_down_period_ &&
+             now - last_level_change_time_ >= cool_down_period_) {
+    // Step down one level at a time to avoid oscillating between accepting
+    // everything and rejecting everything.
+    new_level = static_cast<Level>(level_ - 1);
+  }
+
+  if (new_level != level_) {
+    QUIC_LOG(INFO) << "Overload level changed from " << LevelToString(level_)
+                   << " to " << LevelToString(new_level)
+                   << ", loop_lag: " << loop_lag
+                   << ", packets_dropped: " << packets_dropped;
+    level_ = new_level;
+    last_level_change_time_ = now;
+    ++stats_.level_changes;
+  }
+  return level_;
+}
+
+size_t QuicOverloadController::MaxNewSessionsPerEventLoop(
+    size_t max_sessions) const {
+  switch (level_) {
+    case kNotOverloaded:
+      return max_sessions;
+    case kLimitNewConnections:
+      return std::min(max_sessions, limited_sessions_per_event_loop_);
+    case kRejectNewConnections:
+    case kDropNewConnections:
+      return 0;
+  }
+  return max_sessions;
+}
+
+QuicOverloadController::Level QuicOverloadController::LevelForSample(
+    QuicTime::Delta loop_lag, QuicPacketCount packets_dropped) const {
+  Level lag_level = kNotOverloaded;
+  if (!loop_lag_threshold_.IsInfinite()) {
+    if (loop_lag >= kDropThresholdMultiplier * loop_lag_threshold_) {
+      lag_level = kDropNewConnections;
+    } else if (loop_lag >= kRejectThresholdMultiplier * loop_lag_threshold_) {
+      lag_level = kRejectNewConnections;
+    } else if (loop_lag >= loop_lag_threshold_) {
+      lag_level = kLimitNewConnections;
+    }
+  }
+
+  Level drop_level = kNotOverloaded;
+  if (kernel_drops_threshold_ > 0 && packets_dropped > 0) {
+    if (packets_dropped >= kDropThresholdMultiplier * kernel_drops_threshold_) {
+      drop_level = kDropNewConnections;
+    } else if (packets_dropped >= kernel_drops_threshold_) {
+      drop_level = kRejectNewConnections;
+    } else {
+      drop_level = kLimitNewConnections;
+    }
+  }
+  return std::max(lag_level, drop_level);
+}
+
+// static
+const char* QuicOverloadController::LevelToString(Level level) {
+  switch (level) {
+    case kNotOverloaded:
+      return "NOT_OVERLOADED";
+    case kLimitNewConnections:
+      return "LIMIT_NEW_CONNECTIONS";
+    case kRejectNewConnections:
+      return "REJECT_NEW_CONNECTIONS";
+    case kDropNewConnections:
+      return "DROP_NEW_CONNECTIONS";
+  }
+  return "INVALID_OVERLOAD_LEVEL";
+}
+
+}  // namespace quic
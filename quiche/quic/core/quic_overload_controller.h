@@ -0,0 +1,128 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_OVERLOAD_CONTROLLER_H_
+#define QUICHE_QUIC_CORE_QUIC_OVERLOAD_CONTROLLER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// QuicOverloadController decides how aggressively a server sheds new
+// connections when its event loop falls behind. It is fed one sample per event
+// loop iteration with the loop lag (how long the previous iteration was busy
+// with callbacks and alarms, so that new packets were not read) and the
+// kernel's cumulative receive queue drop count (SO_RXQ_OVFL). The level
+// escalates immediately when a signal crosses a threshold and steps down one
+// level at a time once the signals have stayed below the thresholds for the
+// cool down period.
+class QUIC_EXPORT_PRIVATE QuicOverloadController {
+ public:
+  enum Level : uint8_t {
+    // Normal operation.
+    kNotOverloaded = 0,
+    // Create at most limited_sessions_per_event_loop() sessions per event
+    // loop, leaving the rest of the CHLOs buffered.
+    kLimitNewConnections = 1,
+    // Statelessly reject new connections with a CONNECTION_CLOSE carrying
+    // QUIC_SERVER_OVERLOADED.
+    kRejectNewConnections = 2,
+    // Silently drop packets of new connections, so that the event loop is
+    // spent on established connections only.
+    kDropNewConnections = 3,
+  };
+
+  // Counters of the actions taken because of overload.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    // Number of times the level changed.
+    uint64_t level_changes = 0;
+    // Number of new connections rejected with a CONNECTION_CLOSE.
+    uint64_t new_connections_rejected = 0;
+    // Number of packets of new connections dropped without a response.
+    uint64_t new_connection_packets_dropped = 0;
+  };
+
+  // Thresholds are initialized from the quic_overload_* protocol flags.
+  QuicOverloadController();
+  QuicOverloadController(const QuicOverloadController&) = delete;
+  QuicOverloadController& operator=(const QuicOverloadController&) = delete;
+
+  // Called once per event loop iteration. |loop_lag| is how far the event loop
+  // is behind, |total_packets_dropped| is the cumulative number of packets
+  // dropped by the kernel because the socket receive buffer was full. Returns
+  // the new level.
+  Level OnEventLoopSample(QuicTime now, QuicTime::Delta loop_lag,
+                          QuicPacketCount total_packets_dropped);
+
+  // Returns the number of sessions the dispatcher may create in this event
+  // loop given that it would create |max_sessions| when not overloaded.
+  size_t MaxNewSessionsPerEventLoop(size_t max_sessions) const;
+
+  // Called by the dispatcher when it sheds a new connection.
+  void OnNewConnectionRejected() { ++stats_.new_connections_rejected; }
+  void OnNewConnectionPacketDropped() {
+    ++stats_.new_connection_packets_dropped;
+  }
+
+  // Loop lag at which kLimitNewConnections is entered. kRejectNewConnections
+  // and kDropNewConnections are entered at two and four times this value.
+  // Infinite disables lag based escalation.
+  void set_loop_lag_threshold(QuicTime::Delta threshold) {
+    loop_lag_threshold_ = threshold;
+  }
+
+  // Number of kernel drops within one sample at which kRejectNewConnections is
+  // entered; kDropNewConnections is entered at four times this value. Any drop
+  // at all enters kLimitNewConnections. Zero disables drop based escalation.
+  void set_kernel_drops_threshold(QuicPacketCount threshold) {
+    kernel_drops_threshold_ = threshold;
+  }
+
+  void set_cool_down_period(QuicTime::Delta period) {
+    cool_down_period_ = period;
+  }
+
+  void set_limited_sessions_per_event_loop(size_t sessions) {
+    limited_sessions_per_event_loop_ = sessions;
+  }
+
+  size_t limited_sessions_per_event_loop() const {
+    return limited_sessions_per_event_loop_;
+  }
+
+  Level level() const { return level_; }
+
+  const Stats& stats() const { return stats_; }
+
+  static const char* LevelToString(Level level);
+
+ private:
+  // Returns the level indicated by the signals of a single sample.
+  Level LevelForSample(QuicTime::Delta loop_lag,
+                       QuicPacketCount packets_dropped) const;
+
+  Level level_;
+  // The last time the level changed.
+  QuicTime last_level_change_time_;
+  // The last time a sample indicated a level at or above level_.
+  QuicTime last_overloaded_sample_time_;
+  QuicPacketCount last_total_packets_dropped_;
+  bool has_drop_baseline_;
+
+  QuicTime::Delta loop_lag_threshold_;
+  QuicPacketCount kernel_drops_threshold_;
+  QuicTime::Delta cool_down_period_;
+  size_t limited_sessions_per_event_loop_;
+
+  Stats stats_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_OVERLOAD_CONTROLLER_H_
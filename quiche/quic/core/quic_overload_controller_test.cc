@@ -0,0 +1,125 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_overload_controller.h"
+
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicOverloadControllerTest : public QuicTest {
+ protected:
+  QuicOverloadControllerTest() {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+    controller_.set_loop_lag_threshold(QuicTime::Delta::FromMilliseconds(10));
+    controller_.set_kernel_drops_threshold(100);
+    controller_.set_cool_down_period(QuicTime::Delta::FromSeconds(1));
+  }
+
+  QuicOverloadController::Level Sample(int64_t loop_lag_ms,
+                                       QuicPacketCount total_drops) {
+    return controller_.OnEventLoopSample(
+        clock_.Now(), QuicTime::Delta::FromMilliseconds(loop_lag_ms),
+        total_drops);
+  }
+
+  MockClock clock_;
+  QuicOverloadController controller_;
+};
+
+TEST_F(QuicOverloadControllerTest, DisabledByDefault) {
+  QuicOverloadController controller;
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded,
+            controller.OnEventLoopSample(
+                clock_.Now(), QuicTime::Delta::FromSeconds(10), 0));
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded,
+            controller.OnEventLoopSample(
+                clock_.Now(), QuicTime::Delta::FromSeconds(10), 1000000));
+  EXPECT_EQ(16u, controller.MaxNewSessionsPerEventLoop(16));
+}
+
+TEST_F(QuicOverloadControllerTest, EscalateOnLoopLag) {
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(5, 0));
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections, Sample(10, 0));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(20, 0));
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections, Sample(40, 0));
+  EXPECT_EQ(3u, controller_.stats().level_changes);
+}
+
+TEST_F(QuicOverloadControllerTest, EscalateImmediately) {
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections, Sample(100, 0));
+  EXPECT_EQ(1u, controller_.stats().level_changes);
+}
+
+TEST_F(QuicOverloadControllerTest, EscalateOnKernelDrops) {
+  // The first sample only establishes the baseline.
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(0, 1000));
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(0, 1000));
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections, Sample(0, 1001));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(0, 1101));
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections, Sample(0, 1501));
+}
+
+TEST_F(QuicOverloadControllerTest, KernelDropCounterWraps) {
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(0, 1000));
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(0, 10));
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections, Sample(0, 20));
+}
+
+TEST_F(QuicOverloadControllerTest, StepDownAfterCoolDown) {
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections, Sample(40, 0));
+
+  // Still within the cool down period.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_EQ(QuicOverloadController::kDropNewConnections, Sample(0, 0));
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(0, 0));
+
+  // Each step down needs another cool down period.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(0, 0));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections, Sample(0, 0));
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded, Sample(0, 0));
+  EXPECT_EQ(4u, controller_.stats().level_changes);
+}
+
+TEST_F(QuicOverloadControllerTest, OverloadedSampleRestartsCoolDown) {
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(20, 0));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(900));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(25, 0));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(900));
+  EXPECT_EQ(QuicOverloadController::kRejectNewConnections, Sample(0, 0));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(100));
+  EXPECT_EQ(QuicOverloadController::kLimitNewConnections, Sample(0, 0));
+}
+
+TEST_F(QuicOverloadControllerTest, MaxNewSessionsPerEventLoop) {
+  controller_.set_limited_sessions_per_event_loop(2);
+  EXPECT_EQ(16u, controller_.MaxNewSessionsPerEventLoop(16));
+  Sample(10, 0);
+  EXPECT_EQ(2u, controller_.MaxNewSessionsPerEventLoop(16));
+  EXPECT_EQ(1u, controller_.MaxNewSessionsPerEventLoop(1));
+  Sample(20, 0);
+  EXPECT_EQ(0u, controller_.MaxNewSessionsPerEventLoop(16));
+  Sample(40, 0);
+  EXPECT_EQ(0u, controller_.MaxNewSessionsPerEventLoop(16));
+}
+
+TEST_F(QuicOverloadControllerTest, LevelToString) {
+  EXPECT_STREQ("NOT_OVERLOADED", QuicOverloadController::LevelToString(
+                                     QuicOverloadController::kNotOverloaded));
+  EXPECT_STREQ("DROP_NEW_CONNECTIONS",
+               QuicOverloadController::LevelToString(
+                   QuicOverloadController::kDropNewConnections));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
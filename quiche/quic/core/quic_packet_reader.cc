@@ -19,7 +19,10 @@ namespace quic {
 
 QuicPacketReader::QuicPacketReader()
     : read_buffers_(kNumPacketsPerReadMmsgCall),
-      read_results_(kNumPacketsPerReadMmsgCall) {
+      read_results_(kNumPacketsPerReadMmsgCall),
+      prioritize_short_header_packets_(false),
+      max_long_header_packets_per_read_(kNumPacketsPerReadMmsgCall),
+      max_low_priority_packets_(kDefaultMaxLowPriorityPackets) {
   QUICHE_DCHECK_EQ(read_buffers_.size(), read_results_.size());
   for (size_t i = 0; i < read_results_.size(); ++i) {
     read_results_[i].packet_buffer.buffer = read_buffers_[i].packet_buffer;
@@ -36,7 +39,7 @@ QuicPacketReader::~QuicPacketReader() = default;
 
 bool QuicPacketReader::ReadAndDispatchPackets(
     int fd, int port, const QuicClock& clock, ProcessPacketInterface* processor,
-    QuicPacketCount* /*packets_dropped*/) {
+    QuicPacketCount* packets_dropped) {
   // Reset all read_results for reuse.
   for (size_t i = 0; i < read_results_.size(); ++i) {
     read_results_[i].Reset(
@@ -56,55 +59,147 @@ bool QuicPacketReader::ReadAndDispatchPackets(
                 QuicUdpPacketInfoBit::RECV_TIMESTAMP, QuicUdpPacketInfoBit::TTL,
                 QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER),
       &read_results_);
-  for (size_t i = 0; i < packets_read; ++i) {
-    auto& result = read_results_[i];
-    if (!result.ok) {
-      QUIC_CODE_COUNT(quic_packet_reader_read_failure);
-      continue;
+  if (packets_dropped != nullptr) {
+    // SO_RXQ_OVFL reports the socket's cumulative drop count with every
+    // packet, so the last packet read carries the latest value.
+    for (size_t i = packets_read; i > 0; --i) {
+      const QuicUdpSocketApi::ReadPacketResult& result = read_results_[i - 1];
+      if (result.ok &&
+          result.packet_info.HasValue(QuicUdpPacketInfoBit::DROPPED_PACKETS)) {
+        *packets_dropped = result.packet_info.dropped_packets();
+        break;
+      }
+    }
+  }
+  processor->OnPacketBatchStart();
+  const bool more_to_read =
+      DispatchReadResults(packets_read, port, now, processor);
+  processor->OnPacketBatchEnd();
+  return more_to_read;
+}
+
+bool QuicPacketReader::DispatchReadResults(size_t packets_read, int port,
+                                           QuicTime now,
+                                           ProcessPacketInterface* processor) {
+  if (!prioritize_short_header_packets_) {
+    for (size_t i = 0; i < packets_read; ++i) {
+      DispatchReadResult(read_results_[i], port, now, processor,
+                         /*defer=*/false);
     }
+    // We may not have read all of the packets available on the socket.
+    return packets_read == kNumPacketsPerReadMmsgCall;
+  }
 
-    if (!result.packet_info.HasValue(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
-      QUIC_BUG(quic_bug_10329_1) << "Unable to get peer socket address.";
+  size_t num_long_header_packets = 0;
+  bool is_long_header[kNumPacketsPerReadMmsgCall];
+  for (size_t i = 0; i < packets_read; ++i) {
+    is_long_header[i] = IsLongHeaderPacket(read_results_[i]);
+    if (is_long_header[i]) {
+      ++num_long_header_packets;
       continue;
     }
+    DispatchReadResult(read_results_[i], port, now, processor,
+                       /*defer=*/false);
+  }
 
-    QuicSocketAddress peer_address =
-        result.packet_info.peer_address().Normalized();
+  // Queued packets are older, dispatch them before the ones just read.
+  size_t long_header_quota = max_long_header_packets_per_read_;
+  while (long_header_quota > 0 && !low_priority_packets_.empty()) {
+    LowPriorityPacket low_priority_packet =
+        std::move(low_priority_packets_.front());
+    low_priority_packets_.pop_front();
+    processor->ProcessPacket(low_priority_packet.self_address,
+                             low_priority_packet.peer_address,
+                             *low_priority_packet.packet);
+    --long_header_quota;
+  }
 
-    QuicIpAddress self_ip = GetSelfIpFromPacketInfo(
-        result.packet_info, peer_address.host().IsIPv6());
-    if (!self_ip.IsInitialized()) {
-      QUIC_BUG(quic_bug_10329_2) << "Unable to get self IP address.";
+  for (size_t i = 0; i < packets_read && num_long_header_packets > 0; ++i) {
+    if (!is_long_header[i]) {
       continue;
     }
-
-    bool has_ttl = result.packet_info.HasValue(QuicUdpPacketInfoBit::TTL);
-    int ttl = has_ttl ? result.packet_info.ttl() : 0;
-    if (!has_ttl) {
-      QUIC_CODE_COUNT(quic_packet_reader_no_ttl);
+    --num_long_header_packets;
+    if (long_header_quota > 0) {
+      DispatchReadResult(read_results_[i], port, now, processor,
+                         /*defer=*/false);
+      --long_header_quota;
+      continue;
     }
-
-    char* headers = nullptr;
-    size_t headers_length = 0;
-    if (result.packet_info.HasValue(
-            QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER)) {
-      headers = result.packet_info.google_packet_headers().buffer;
-      headers_length = result.packet_info.google_packet_headers().buffer_len;
-    } else {
-      QUIC_CODE_COUNT(quic_packet_reader_no_google_packet_header);
+    if (low_priority_packets_.size() >= max_low_priority_packets_) {
+      QUIC_CODE_COUNT(quic_packet_reader_low_priority_queue_full);
+      ++stats_.long_header_packets_dropped;
+      continue;
     }
+    ++stats_.long_header_packets_deferred;
+    DispatchReadResult(read_results_[i], port, now, processor,
+                       /*defer=*/true);
+  }
+
+  // We may not have read all of the packets available on the socket.
+  return packets_read == kNumPacketsPerReadMmsgCall ||
+         !low_priority_packets_.empty();
+}
+
+// static
+bool QuicPacketReader::IsLongHeaderPacket(
+    const QuicUdpSocketApi::ReadPacketResult& result) {
+  // The first byte is enough to tell long and short headers apart, the rest of
+  // the header is left to the dispatcher.
+  return result.ok && result.packet_buffer.buffer_len > 0 &&
+         (result.packet_buffer.buffer[0] & FLAGS_LONG_HEADER) != 0;
+}
 
-    QuicReceivedPacket packet(
-        result.packet_buffer.buffer, result.packet_buffer.buffer_len, now,
-        /*owns_buffer=*/false, ttl, has_ttl, headers, headers_length,
-        /*owns_header_buffer=*/false);
+void QuicPacketReader::DispatchReadResult(
+    const QuicUdpSocketApi::ReadPacketResult& result, int port, QuicTime now,
+    ProcessPacketInterface* processor, bool defer) {
+  if (!result.ok) {
+    QUIC_CODE_COUNT(quic_packet_reader_read_failure);
+    return;
+  }
 
-    QuicSocketAddress self_address(self_ip, port);
-    processor->ProcessPacket(self_address, peer_address, packet);
+  if (!result.packet_info.HasValue(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
+    QUIC_BUG(quic_bug_10329_1) << "Unable to get peer socket address.";
+    return;
   }
 
-  // We may not have read all of the packets available on the socket.
-  return packets_read == kNumPacketsPerReadMmsgCall;
+  QuicSocketAddress peer_address =
+      result.packet_info.peer_address().Normalized();
+
+  QuicIpAddress self_ip = GetSelfIpFromPacketInfo(
+      result.packet_info, peer_address.host().IsIPv6());
+  if (!self_ip.IsInitialized()) {
+    QUIC_BUG(quic_bug_10329_2) << "Unable to get self IP address.";
+    return;
+  }
+
+  bool has_ttl = result.packet_info.HasValue(QuicUdpPacketInfoBit::TTL);
+  int ttl = has_ttl ? result.packet_info.ttl() : 0;
+  if (!has_ttl) {
+    QUIC_CODE_COUNT(quic_packet_reader_no_ttl);
+  }
+
+  char* headers = nullptr;
+  size_t headers_length = 0;
+  if (result.packet_info.HasValue(QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER)) {
+    headers = result.packet_info.google_packet_headers().buffer;
+    headers_length = result.packet_info.google_packet_headers().buffer_len;
+  } else {
+    QUIC_CODE_COUNT(quic_packet_reader_no_google_packet_header);
+  }
+
+  QuicReceivedPacket packet(
+      result.packet_buffer.buffer, result.packet_buffer.buffer_len, now,
+      /*owns_buffer=*/false, ttl, has_ttl, headers, headers_length,
+      /*owns_header_buffer=*/false);
+
+  QuicSocketAddress self_address(self_ip, port);
+  if (defer) {
+    // The read buffers are reused by the next read, so the packet is copied.
+    low_priority_packets_.push_back(
+        LowPriorityPacket{self_address, peer_address, packet.Clone()});
+    return;
+  }
+  processor->ProcessPacket(self_address, peer_address, packet);
 }
 
 // static
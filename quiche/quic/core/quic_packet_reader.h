@@ -7,6 +7,9 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_PACKET_READER_H_
 #define QUICHE_QUIC_CORE_QUIC_PACKET_READER_H_
 
+#include <cstddef>
+#include <memory>
+
 #include "absl/base/optimization.h"
 #include "quiche/quic/core/quic_clock.h"
 #include "quiche/quic/core/quic_packets.h"
@@ -14,12 +17,16 @@
 #include "quiche/quic/core/quic_udp_socket.h"
 #include "quiche/quic/platform/api/quic_flags.h"
 #include "quiche/quic/platform/api/quic_socket_address.h"
+#include "quiche/common/quiche_circular_deque.h"
 
 namespace quic {
 
 // Read in larger batches to minimize recvmmsg overhead.
 const int kNumPacketsPerReadMmsgCall = 16;
 
+// Default capacity of the low priority queue.
+const size_t kDefaultMaxLowPriorityPackets = 256;
+
 class QUIC_EXPORT_PRIVATE QuicPacketReader {
  public:
   QuicPacketReader();
@@ -35,11 +42,80 @@ class QUIC_EXPORT_PRIVATE QuicPacketReader {
   // to track dropped packets and some packets are read.
   // If the socket has timestamping enabled, the per packet timestamps will be
   // passed to the processor. Otherwise, |clock| will be used.
+  //
+  // If short header packets are prioritized, the short header packets of each
+  // batch are dispatched first and the long header packets (which are mostly
+  // Initial packets of new connections) last, at most
+  // max_long_header_packets_per_read() of them per call. The excess is kept in
+  // a bounded low priority queue and dispatched by later calls, so a flood of
+  // Initial packets does not delay packets of established connections. In
+  // that case the return value is also true while the queue is not empty.
   virtual bool ReadAndDispatchPackets(int fd, int port, const QuicClock& clock,
                                       ProcessPacketInterface* processor,
                                       QuicPacketCount* packets_dropped);
 
+  // Counters of the low priority queue.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    // Number of long header packets queued instead of being dispatched in the
+    // batch they were read in.
+    uint64_t long_header_packets_deferred = 0;
+    // Number of long header packets dropped because the low priority queue was
+    // full.
+    uint64_t long_header_packets_dropped = 0;
+  };
+
+  void set_prioritize_short_header_packets(bool prioritize) {
+    prioritize_short_header_packets_ = prioritize;
+  }
+
+  bool prioritize_short_header_packets() const {
+    return prioritize_short_header_packets_;
+  }
+
+  // Quota of long header packets dispatched per ReadAndDispatchPackets call,
+  // including the queued ones. Only used if short header packets are
+  // prioritized.
+  void set_max_long_header_packets_per_read(size_t quota) {
+    max_long_header_packets_per_read_ = quota;
+  }
+
+  size_t max_long_header_packets_per_read() const {
+    return max_long_header_packets_per_read_;
+  }
+
+  void set_max_low_priority_packets(size_t max_packets) {
+    max_low_priority_packets_ = max_packets;
+  }
+
+  size_t num_low_priority_packets() const {
+    return low_priority_packets_.size();
+  }
+
+  const Stats& stats() const { return stats_; }
+
  private:
+  // A long header packet waiting in the low priority queue.
+  struct QUIC_EXPORT_PRIVATE LowPriorityPacket {
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    std::unique_ptr<QuicReceivedPacket> packet;
+  };
+
+  // Returns true if |result| carries a long header packet.
+  static bool IsLongHeaderPacket(
+      const QuicUdpSocketApi::ReadPacketResult& result);
+
+  // Dispatches the first |packets_read| read results to |processor|. Returns
+  // true if there may be additional packets to dispatch.
+  bool DispatchReadResults(size_t packets_read, int port, QuicTime now,
+                           ProcessPacketInterface* processor);
+
+  // Dispatches the packet in |result| to |processor|, or appends a copy of it
+  // to the low priority queue if |defer| is true.
+  void DispatchReadResult(const QuicUdpSocketApi::ReadPacketResult& result,
+                          int port, QuicTime now,
+                          ProcessPacketInterface* processor, bool defer);
+
   // Return the self ip from |packet_info|.
   // For dual stack sockets, |packet_info| may contain both a v4 and a v6 ip, in
   // that case, |prefer_v6_ip| is used to determine which one is used as the
@@ -57,6 +133,12 @@ class QUIC_EXPORT_PRIVATE QuicPacketReader {
   QuicUdpSocketApi socket_api_;
   std::vector<ReadBuffer> read_buffers_;
   QuicUdpSocketApi::ReadPacketResults read_results_;
+
+  bool prioritize_short_header_packets_;
+  size_t max_long_header_packets_per_read_;
+  size_t max_low_priority_packets_;
+  quiche::QuicheCircularDeque<LowPriorityPacket> low_priority_packets_;
+  Stats stats_;
 };
 
 }  // namespace quic
@@ -0,0 +1,202 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_packet_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "quiche/quic/core/quic_udp_socket.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const uint8_t kLongHeaderByte = 0xc0;
+const uint8_t kShortHeaderByte = 0x40;
+
+// Records the first two bytes of each packet, the second byte identifies the
+// packet within a test.
+class RecordingProcessor : public ProcessPacketInterface {
+ public:
+  void ProcessPacket(const QuicSocketAddress& /*self_address*/,
+                     const QuicSocketAddress& /*peer_address*/,
+                     const QuicReceivedPacket& packet) override {
+    EXPECT_TRUE(in_batch_);
+    ASSERT_EQ(2u, packet.length());
+    packets_.push_back(std::string(packet.data(), packet.length()));
+  }
+
+  void OnPacketBatchStart() override {
+    EXPECT_FALSE(in_batch_);
+    in_batch_ = true;
+    ++num_batches_;
+  }
+
+  void OnPacketBatchEnd() override {
+    EXPECT_TRUE(in_batch_);
+    in_batch_ = false;
+  }
+
+  const std::vector<std::string>& packets() const { return packets_; }
+  bool in_batch() const { return in_batch_; }
+  int num_batches() const { return num_batches_; }
+
+ private:
+  std::vector<std::string> packets_;
+  bool in_batch_ = false;
+  int num_batches_ = 0;
+};
+
+class QuicPacketReaderTest : public QuicTest {
+ protected:
+  QuicPacketReaderTest() {
+    server_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                    kDefaultSocketReceiveBuffer);
+    client_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                    kDefaultSocketReceiveBuffer);
+    QUICHE_CHECK(socket_api_.Bind(
+        server_fd_, QuicSocketAddress(QuicIpAddress::Loopback4(), 0)));
+    QUICHE_CHECK_EQ(0, server_address_.FromSocket(server_fd_));
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  ~QuicPacketReaderTest() override {
+    socket_api_.Destroy(server_fd_);
+    socket_api_.Destroy(client_fd_);
+  }
+
+  void SendPacket(uint8_t first_byte, char id) {
+    const char packet[] = {static_cast<char>(first_byte), id};
+    QuicUdpPacketInfo packet_info;
+    packet_info.SetPeerAddress(server_address_);
+    ASSERT_EQ(WRITE_STATUS_OK,
+              socket_api_
+                  .WritePacket(client_fd_, packet, sizeof(packet), packet_info)
+                  .status);
+  }
+
+  // Returns the ids of the packets dispatched by one read.
+  std::string ReadAndDispatch(bool* more_to_read = nullptr) {
+    socket_api_.WaitUntilReadable(server_fd_,
+                                  QuicTime::Delta::FromMilliseconds(100));
+    RecordingProcessor processor;
+    bool result = reader_.ReadAndDispatchPackets(
+        server_fd_, server_address_.port(), clock_, &processor, nullptr);
+    if (more_to_read != nullptr) {
+      *more_to_read = result;
+    }
+    // Each read is dispatched as one batch.
+    EXPECT_FALSE(processor.in_batch());
+    EXPECT_EQ(1, processor.num_batches());
+    std::string ids;
+    for (const std::string& packet : processor.packets()) {
+      ids.push_back(packet[1]);
+    }
+    return ids;
+  }
+
+  QuicUdpSocketApi socket_api_;
+  QuicUdpSocketFd server_fd_;
+  QuicUdpSocketFd client_fd_;
+  QuicSocketAddress server_address_;
+  MockClock clock_;
+  QuicPacketReader reader_;
+};
+
+TEST_F(QuicPacketReaderTest, DispatchInArrivalOrderByDefault) {
+  SendPacket(kLongHeaderByte, 'a');
+  SendPacket(kShortHeaderByte, 'b');
+  SendPacket(kLongHeaderByte, 'c');
+  SendPacket(kShortHeaderByte, 'd');
+  EXPECT_EQ("abcd", ReadAndDispatch());
+}
+
+TEST_F(QuicPacketReaderTest, PrioritizeShortHeaderPackets) {
+  reader_.set_prioritize_short_header_packets(true);
+  SendPacket(kLongHeaderByte, 'a');
+  SendPacket(kShortHeaderByte, 'b');
+  SendPacket(kLongHeaderByte, 'c');
+  SendPacket(kShortHeaderByte, 'd');
+  bool more_to_read = true;
+  EXPECT_EQ("bdac", ReadAndDispatch(&more_to_read));
+  EXPECT_FALSE(more_to_read);
+  EXPECT_EQ(0u, reader_.stats().long_header_packets_deferred);
+}
+
+TEST_F(QuicPacketReaderTest, LongHeaderQuota) {
+  reader_.set_prioritize_short_header_packets(true);
+  reader_.set_max_long_header_packets_per_read(1);
+  SendPacket(kLongHeaderByte, 'a');
+  SendPacket(kLongHeaderByte, 'b');
+  SendPacket(kShortHeaderByte, 'c');
+  SendPacket(kLongHeaderByte, 'd');
+  bool more_to_read = false;
+  EXPECT_EQ("ca", ReadAndDispatch(&more_to_read));
+  EXPECT_TRUE(more_to_read);
+  EXPECT_EQ(2u, reader_.num_low_priority_packets());
+  EXPECT_EQ(2u, reader_.stats().long_header_packets_deferred);
+
+  // Newly read short header packets go ahead of the queued packets, which go
+  // ahead of newly read long header packets.
+  SendPacket(kLongHeaderByte, 'e');
+  SendPacket(kShortHeaderByte, 'f');
+  EXPECT_EQ("fb", ReadAndDispatch(&more_to_read));
+  EXPECT_TRUE(more_to_read);
+  EXPECT_EQ("d", ReadAndDispatch(&more_to_read));
+  EXPECT_TRUE(more_to_read);
+  EXPECT_EQ("e", ReadAndDispatch(&more_to_read));
+  EXPECT_FALSE(more_to_read);
+  EXPECT_EQ(0u, reader_.num_low_priority_packets());
+}
+
+TEST_F(QuicPacketReaderTest, LowPriorityQueueFull) {
+  reader_.set_prioritize_short_header_packets(true);
+  reader_.set_max_long_header_packets_per_read(1);
+  reader_.set_max_low_priority_packets(1);
+  SendPacket(kLongHeaderByte, 'a');
+  SendPacket(kLongHeaderByte, 'b');
+  SendPacket(kLongHeaderByte, 'c');
+  EXPECT_EQ("a", ReadAndDispatch());
+  EXPECT_EQ(1u, reader_.stats().long_header_packets_deferred);
+  EXPECT_EQ(1u, reader_.stats().long_header_packets_dropped);
+  EXPECT_EQ("b", ReadAndDispatch());
+}
+
+TEST_F(QuicPacketReaderTest, ReportsDroppedPackets) {
+  if (!socket_api_.EnableDroppedPacketCount(server_fd_)) {
+    return;
+  }
+  int receive_buffer_size = 1024;
+  ASSERT_EQ(0, setsockopt(server_fd_, SOL_SOCKET, SO_RCVBUF,
+                          &receive_buffer_size, sizeof(receive_buffer_size)));
+  // Overflow the receive buffer.
+  for (int i = 0; i < 100; ++i) {
+    SendPacket(kShortHeaderByte, 'a');
+  }
+
+  QuicPacketCount packets_dropped = 0;
+  RecordingProcessor processor;
+  while (reader_.ReadAndDispatchPackets(server_fd_, server_address_.port(),
+                                        clock_, &processor,
+                                        &packets_dropped)) {
+  }
+  // Each packet carries the drop count at the time it was queued, which is
+  // zero for the packets queued before the buffer filled up.
+  SendPacket(kShortHeaderByte, 'b');
+  socket_api_.WaitUntilReadable(server_fd_,
+                                QuicTime::Delta::FromMilliseconds(100));
+  reader_.ReadAndDispatchPackets(server_fd_, server_address_.port(), clock_,
+                                 &processor, &packets_dropped);
+  ASSERT_FALSE(processor.packets().empty());
+  EXPECT_EQ('b', processor.packets().back()[1]);
+  EXPECT_LT(0u, packets_dropped);
+  EXPECT_GE(100u, packets_dropped);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -474,32 +474,40 @@ SerializedPacket::~SerializedPacket() {
 SerializedPacket* CopySerializedPacket(const SerializedPacket& serialized,
                                        quiche::QuicheBufferAllocator* allocator,
                                        bool copy_buffer) {
-  SerializedPacket* copy = new SerializedPacket(
-      serialized.packet_number, serialized.packet_number_length,
-      serialized.encrypted_buffer, serialized.encrypted_length,
-      serialized.has_ack, serialized.has_stop_waiting);
-  copy->has_crypto_handshake = serialized.has_crypto_handshake;
-  copy->encryption_level = serialized.encryption_level;
-  copy->transmission_type = serialized.transmission_type;
-  copy->largest_acked = serialized.largest_acked;
-  copy->has_ack_frequency = serialized.has_ack_frequency;
-  copy->has_message = serialized.has_message;
-  copy->fate = serialized.fate;
-  copy->peer_address = serialized.peer_address;
+  return new SerializedPacket(
+      CopySerializedPacketByValue(serialized, allocator, copy_buffer));
+}
+
+SerializedPacket CopySerializedPacketByValue(
+    const SerializedPacket& serialized,
+    quiche::QuicheBufferAllocator* allocator, bool copy_buffer) {
+  SerializedPacket copy(serialized.packet_number,
+                        serialized.packet_number_length,
+                        serialized.encrypted_buffer,
+                        serialized.encrypted_length, serialized.has_ack,
+                        serialized.has_stop_waiting);
+  copy.has_crypto_handshake = serialized.has_crypto_handshake;
+  copy.encryption_level = serialized.encryption_level;
+  copy.transmission_type = serialized.transmission_type;
+  copy.largest_acked = serialized.largest_acked;
+  copy.has_ack_frequency = serialized.has_ack_frequency;
+  copy.has_message = serialized.has_message;
+  copy.fate = serialized.fate;
+  copy.peer_address = serialized.peer_address;
 
   if (copy_buffer) {
-    copy->encrypted_buffer = CopyBuffer(serialized);
-    copy->release_encrypted_buffer = [](const char* p) { delete[] p; };
+    copy.encrypted_buffer = CopyBuffer(serialized);
+    copy.release_encrypted_buffer = [](const char* p) { delete[] p; };
   }
   // Copy underlying frames.
-  copy->retransmittable_frames =
+  copy.retransmittable_frames =
       CopyQuicFrames(allocator, serialized.retransmittable_frames);
-  QUICHE_DCHECK(copy->nonretransmittable_frames.empty());
+  QUICHE_DCHECK(copy.nonretransmittable_frames.empty());
   for (const auto& frame : serialized.nonretransmittable_frames) {
     if (frame.type == ACK_FRAME) {
-      copy->has_ack_frame_copy = true;
+      copy.has_ack_frame_copy = true;
     }
-    copy->nonretransmittable_frames.push_back(CopyQuicFrame(allocator, frame));
+    copy.nonretransmittable_frames.push_back(CopyQuicFrame(allocator, frame));
   }
   return copy;
 }
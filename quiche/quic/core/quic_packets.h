@@ -383,6 +383,11 @@ struct QUIC_EXPORT_PRIVATE SerializedPacket {
 QUIC_EXPORT_PRIVATE SerializedPacket* CopySerializedPacket(
     const SerializedPacket& serialized,
     quiche::QuicheBufferAllocator* allocator, bool copy_buffer);
+// Same as above, but returns the copy by value so that it can be held without
+// a separate allocation.
+QUIC_EXPORT_PRIVATE SerializedPacket CopySerializedPacketByValue(
+    const SerializedPacket& serialized,
+    quiche::QuicheBufferAllocator* allocator, bool copy_buffer);
 
 // Allocates a new char[] of size |packet.encrypted_length| and copies in
 // |packet.encrypted_buffer|.
@@ -17,6 +17,11 @@ class QUIC_NO_EXPORT ProcessPacketInterface {
   virtual void ProcessPacket(const QuicSocketAddress& self_address,
                              const QuicSocketAddress& peer_address,
                              const QuicReceivedPacket& packet) = 0;
+
+  // Called before and after the packets read together, e.g. by one recvmmsg
+  // call, are passed to ProcessPacket().
+  virtual void OnPacketBatchStart() {}
+  virtual void OnPacketBatchEnd() {}
 };
 
 }  // namespace quic
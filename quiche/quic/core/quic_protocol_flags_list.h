@@ -15,6 +15,25 @@ QUIC_PROTOCOL_FLAG(
     "future CHLO, and allow CHLO packets to be buffered until next "
     "iteration of the event loop.")
 
+// See QuicOverloadController for how these thresholds drive load shedding.
+QUIC_PROTOCOL_FLAG(
+    int64_t, quic_overload_loop_lag_threshold_us, 0,
+    "If positive, the event loop lag in microseconds at which the dispatcher "
+    "starts limiting new connections. New connections are rejected at twice "
+    "and dropped at four times this lag.")
+
+QUIC_PROTOCOL_FLAG(
+    uint64_t, quic_overload_kernel_drops_threshold, 0,
+    "If positive, the number of packets dropped by the kernel within one event "
+    "loop iteration at which the dispatcher rejects new connections. New "
+    "connections are dropped at four times this number.")
+
+QUIC_PROTOCOL_FLAG(
+    int32_t, quic_server_long_header_packets_per_read, 0,
+    "If positive, QuicServer dispatches the short header packets of each read "
+    "batch first and at most this many long header packets per read, queueing "
+    "the rest.")
+
 QUIC_PROTOCOL_FLAG(bool, quic_disable_pacing_for_perf_tests, false,
                    "If true, disable pacing in QUIC")
 
@@ -200,6 +219,11 @@ QUIC_PROTOCOL_FLAG(bool, quic_disable_server_tls_resumption, false,
                    "If true, QUIC server will disable TLS resumption by not "
                    "issuing or processing session tickets.")
 
+QUIC_PROTOCOL_FLAG(bool, quic_shed_tls_server_handshake_config, false,
+                   "If true, QUIC server with TLS will release the handshake "
+                   "configuration and state of the SSL object once the "
+                   "handshake is complete.")
+
 QUIC_PROTOCOL_FLAG(bool, quic_defer_send_in_response, true,
                    "If true, QUIC servers will defer sending in response to "
                    "incoming packets by default.")
@@ -45,6 +45,10 @@ QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
       ack_frequency_(kDefaultRetransmittablePacketsBeforeAck),
       ack_decimation_delay_(kAckDecimationDelay),
       unlimited_ack_decimation_(false),
+      adaptive_ack_decimation_(false),
+      adaptive_ack_frequency_(kMaxRetransmittablePacketsBeforeAck),
+      packet_rate_sample_start_(QuicTime::Zero()),
+      packets_received_in_rate_sample_(0),
       one_immediate_ack_(false),
       ignore_order_(false),
       local_max_ack_delay_(
@@ -64,6 +68,9 @@ void QuicReceivedPacketManager::SetFromConfig(const QuicConfig& config,
   if (config.HasClientSentConnectionOption(kAKDU, perspective)) {
     unlimited_ack_decimation_ = true;
   }
+  if (config.HasClientSentConnectionOption(kAKDA, perspective)) {
+    adaptive_ack_decimation_ = true;
+  }
   if (config.HasClientSentConnectionOption(k1ACK, perspective)) {
     one_immediate_ack_ = true;
   }
@@ -95,11 +102,24 @@ void QuicReceivedPacketManager::RecordPacketReceived(
     stats_->max_time_reordering_us =
         std::max(stats_->max_time_reordering_us, reordering_time_us);
   }
-  if (!LargestAcked(ack_frame_).IsInitialized() ||
-      packet_number > LargestAcked(ack_frame_)) {
+  const QuicPacketNumber largest_received = LargestAcked(ack_frame_);
+  if (!largest_received.IsInitialized() || packet_number > largest_received) {
+    // Slide the window forward, the packets skipped over are missing.
+    if (!largest_received.IsInitialized() ||
+        packet_number - largest_received >= kRecentPacketWindowSize) {
+      recent_packets_.reset();
+    } else {
+      for (uint64_t skipped = largest_received.ToUint64() + 1;
+           skipped < packet_number.ToUint64(); ++skipped) {
+        recent_packets_.reset(skipped % kRecentPacketWindowSize);
+      }
+    }
     ack_frame_.largest_acked = packet_number;
     time_largest_observed_ = receipt_time;
   }
+  if (IsInRecentPacketWindow(packet_number)) {
+    recent_packets_.set(packet_number.ToUint64() % kRecentPacketWindowSize);
+  }
   ack_frame_.packets.Add(packet_number);
 
   if (save_timestamps_) {
@@ -130,13 +150,49 @@ void QuicReceivedPacketManager::RecordPacketReceived(
 bool QuicReceivedPacketManager::IsMissing(QuicPacketNumber packet_number) {
   return LargestAcked(ack_frame_).IsInitialized() &&
          packet_number < LargestAcked(ack_frame_) &&
-         !ack_frame_.packets.Contains(packet_number);
+         !HasReceived(packet_number);
 }
 
 bool QuicReceivedPacketManager::IsAwaitingPacket(
     QuicPacketNumber packet_number) const {
-  return quic::IsAwaitingPacket(ack_frame_, packet_number,
-                                peer_least_packet_awaiting_ack_);
+  QUICHE_DCHECK(packet_number.IsInitialized());
+  return (!peer_least_packet_awaiting_ack_.IsInitialized() ||
+          packet_number >= peer_least_packet_awaiting_ack_) &&
+         !HasReceived(packet_number);
+}
+
+bool QuicReceivedPacketManager::HasReceived(
+    QuicPacketNumber packet_number) const {
+  if (IsInRecentPacketWindow(packet_number)) {
+    return recent_packets_.test(packet_number.ToUint64() %
+                                kRecentPacketWindowSize);
+  }
+  return ack_frame_.packets.Contains(packet_number);
+}
+
+bool QuicReceivedPacketManager::IsInRecentPacketWindow(
+    QuicPacketNumber packet_number) const {
+  const QuicPacketNumber largest_received = LargestAcked(ack_frame_);
+  return largest_received.IsInitialized() &&
+         packet_number <= largest_received &&
+         largest_received - packet_number < kRecentPacketWindowSize;
+}
+
+void QuicReceivedPacketManager::ClearRecentPackets(QuicPacketNumber lower,
+                                                   QuicPacketNumber higher) {
+  const QuicPacketNumber largest_received = LargestAcked(ack_frame_);
+  if (!largest_received.IsInitialized()) {
+    return;
+  }
+  const uint64_t window_end = largest_received.ToUint64() + 1;
+  const uint64_t window_begin = window_end > kRecentPacketWindowSize
+                                    ? window_end - kRecentPacketWindowSize
+                                    : 0;
+  const uint64_t end = std::min(higher.ToUint64(), window_end);
+  for (uint64_t packet_number = std::max(lower.ToUint64(), window_begin);
+       packet_number < end; ++packet_number) {
+    recent_packets_.reset(packet_number % kRecentPacketWindowSize);
+  }
 }
 
 const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
@@ -152,7 +208,10 @@ const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
   }
   while (max_ack_ranges_ > 0 &&
          ack_frame_.packets.NumIntervals() > max_ack_ranges_) {
+    const QuicInterval<QuicPacketNumber> smallest_interval =
+        *ack_frame_.packets.begin();
     ack_frame_.packets.RemoveSmallestInterval();
+    ClearRecentPackets(smallest_interval.min(), smallest_interval.max());
   }
   // Clear all packet times if any are too far from largest observed.
   // It's expected this is extremely rare.
@@ -186,8 +245,12 @@ void QuicReceivedPacketManager::DontWaitForPacketsBefore(
   if (!peer_least_packet_awaiting_ack_.IsInitialized() ||
       least_unacked > peer_least_packet_awaiting_ack_) {
     peer_least_packet_awaiting_ack_ = least_unacked;
+    const QuicPacketNumber previous_min = ack_frame_.packets.Empty()
+                                              ? least_unacked
+                                              : ack_frame_.packets.Min();
     bool packets_updated = ack_frame_.packets.RemoveUpTo(least_unacked);
     if (packets_updated) {
+      ClearRecentPackets(previous_min, least_unacked);
       // Ack frame gets updated because packets set is updated because of stop
       // waiting frame.
       ack_frame_updated_ = true;
@@ -225,9 +288,43 @@ void QuicReceivedPacketManager::MaybeUpdateAckFrequency(
       PeerFirstSendingPacketNumber() + min_received_before_ack_decimation_) {
     return;
   }
-  ack_frequency_ = unlimited_ack_decimation_
-                       ? std::numeric_limits<size_t>::max()
-                       : kMaxRetransmittablePacketsBeforeAck;
+  if (unlimited_ack_decimation_) {
+    ack_frequency_ = std::numeric_limits<size_t>::max();
+  } else if (adaptive_ack_decimation_) {
+    ack_frequency_ = adaptive_ack_frequency_;
+  } else {
+    ack_frequency_ = kMaxRetransmittablePacketsBeforeAck;
+  }
+}
+
+void QuicReceivedPacketManager::UpdateAdaptiveAckFrequency(
+    QuicPacketNumber last_received_packet_number, QuicTime now,
+    const RttStats& rtt_stats) {
+  if (!adaptive_ack_decimation_) {
+    return;
+  }
+  if (!packet_rate_sample_start_.IsInitialized()) {
+    packet_rate_sample_start_ = now;
+    return;
+  }
+  ++packets_received_in_rate_sample_;
+  const QuicTime::Delta elapsed = now - packet_rate_sample_start_;
+  if (elapsed < std::max(rtt_stats.min_rtt(), kAlarmGranularity)) {
+    return;
+  }
+  // Acking more rarely than once per max ack delay does not save anything,
+  // as the ack alarm fires by then anyway.
+  const QuicTime::Delta max_ack_delay =
+      GetMaxAckDelay(last_received_packet_number, rtt_stats);
+  const QuicPacketCount packets_per_max_ack_delay =
+      packets_received_in_rate_sample_ * max_ack_delay.ToMicroseconds() /
+      elapsed.ToMicroseconds();
+  adaptive_ack_frequency_ = std::clamp(
+      packets_per_max_ack_delay, kMaxRetransmittablePacketsBeforeAck,
+      kMaxAdaptiveRetransmittablePacketsBeforeAck);
+  QUIC_DVLOG(1) << "Adaptive ack frequency: " << adaptive_ack_frequency_;
+  packet_rate_sample_start_ = now;
+  packets_received_in_rate_sample_ = 0;
 }
 
 void QuicReceivedPacketManager::MaybeUpdateAckTimeout(
@@ -255,6 +352,7 @@ void QuicReceivedPacketManager::MaybeUpdateAckTimeout(
 
   ++num_retransmittable_packets_received_since_last_ack_sent_;
 
+  UpdateAdaptiveAckFrequency(last_received_packet_number, now, *rtt_stats);
   MaybeUpdateAckFrequency(last_received_packet_number);
   if (num_retransmittable_packets_received_since_last_ack_sent_ >=
       ack_frequency_) {
@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_RECEIVED_PACKET_MANAGER_H_
 #define QUICHE_QUIC_CORE_QUIC_RECEIVED_PACKET_MANAGER_H_
 
+#include <bitset>
 #include <cstddef>
 
 #include "quiche/quic/core/frames/quic_ack_frequency_frame.h"
@@ -140,6 +141,12 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // Maybe update ack_frequency_ when condition meets.
   void MaybeUpdateAckFrequency(QuicPacketNumber last_received_packet_number);
 
+  // Counts an ack-instigating packet received at |now| towards the packet rate
+  // and, once a sample spans min_rtt, sets adaptive_ack_frequency_ to the
+  // number of packets received within the max ack delay at that rate.
+  void UpdateAdaptiveAckFrequency(QuicPacketNumber last_received_packet_number,
+                                  QuicTime now, const RttStats& rtt_stats);
+
   QuicTime::Delta GetMaxAckDelay(QuicPacketNumber last_received_packet_number,
                                  const RttStats& rtt_stats) const;
 
@@ -147,6 +154,20 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
     return last_ack_frequency_frame_sequence_number_ >= 0;
   }
 
+  // Returns true if |packet_number| is in ack_frame_.packets.
+  bool HasReceived(QuicPacketNumber packet_number) const;
+
+  // Returns true if |packet_number| is tracked by |recent_packets_|.
+  bool IsInRecentPacketWindow(QuicPacketNumber packet_number) const;
+
+  // Clears the bits of [lower, higher) in |recent_packets_|, called when these
+  // packets are removed from ack_frame_.packets.
+  void ClearRecentPackets(QuicPacketNumber lower, QuicPacketNumber higher);
+
+  // Number of packet numbers, ending with the largest received one, tracked
+  // by |recent_packets_|. One cache line worth of bits.
+  static constexpr uint64_t kRecentPacketWindowSize = 512;
+
   // Least packet number of the the packet sent by the peer for which it
   // hasn't received an ack.
   QuicPacketNumber peer_least_packet_awaiting_ack_;
@@ -154,6 +175,12 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // Received packet information used to produce acks.
   QuicAckFrame ack_frame_;
 
+  // Whether the last kRecentPacketWindowSize packet numbers up to the largest
+  // received one are in ack_frame_.packets, indexed by packet number modulo
+  // the window size. Lets duplicate and missing packet checks of recent
+  // packets skip searching the intervals of ack_frame_.packets.
+  std::bitset<kRecentPacketWindowSize> recent_packets_;
+
   // True if |ack_frame_| has been updated since UpdateReceivedPacketInfo was
   // last called.
   bool ack_frame_updated_;
@@ -189,6 +216,17 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // When true, removes ack decimation's max number of packets(10) before
   // sending an ack.
   bool unlimited_ack_decimation_;
+  // When true, ack decimation acks every adaptive_ack_frequency_ packets
+  // instead of every kMaxRetransmittablePacketsBeforeAck packets.
+  bool adaptive_ack_decimation_;
+  // Ack frequency scaled with the packet rate, between
+  // kMaxRetransmittablePacketsBeforeAck and
+  // kMaxAdaptiveRetransmittablePacketsBeforeAck.
+  QuicPacketCount adaptive_ack_frequency_;
+  // Start of the current packet rate sample, and the number of
+  // ack-instigating packets received since.
+  QuicTime packet_rate_sample_start_;
+  QuicPacketCount packets_received_in_rate_sample_;
   // When true, only send 1 immediate ACK when reordering is detected.
   bool one_immediate_ack_;
   // When true, do not ack immediately upon observation of packet reordering.
@@ -32,6 +32,11 @@ class QuicReceivedPacketManagerPeer {
                                     float ack_decimation_delay) {
     manager->ack_decimation_delay_ = ack_decimation_delay;
   }
+
+  static void SetAdaptiveAckDecimation(QuicReceivedPacketManager* manager,
+                                       bool adaptive_ack_decimation) {
+    manager->adaptive_ack_decimation_ = adaptive_ack_decimation;
+  }
 };
 
 namespace {
@@ -178,6 +183,76 @@ TEST_F(QuicReceivedPacketManagerTest, LimitAckRanges) {
   }
 }
 
+TEST_F(QuicReceivedPacketManagerTest, RecentPacketWindow) {
+  RecordPacketReceipt(1);
+  RecordPacketReceipt(3);
+  // Slides the window past all the previously received packets.
+  RecordPacketReceipt(2000);
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(1)));
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(2)));
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(3)));
+  EXPECT_TRUE(received_manager_.IsMissing(QuicPacketNumber(1000)));
+  EXPECT_TRUE(received_manager_.IsMissing(QuicPacketNumber(1999)));
+  EXPECT_FALSE(received_manager_.IsMissing(QuicPacketNumber(2000)));
+
+  RecordPacketReceipt(1999);
+  RecordPacketReceipt(1500);
+  RecordPacketReceipt(2002);
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(1500)));
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(1999)));
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(2001)));
+  EXPECT_FALSE(received_manager_.IsMissing(QuicPacketNumber(1999)));
+
+  // Packets dropped from the ack frame are no longer considered received.
+  received_manager_.DontWaitForPacketsBefore(QuicPacketNumber(1600));
+  EXPECT_TRUE(received_manager_.IsMissing(QuicPacketNumber(1500)));
+  received_manager_.set_max_ack_ranges(1);
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(QuicPacketNumber(2002),
+            received_manager_.ack_frame().packets.Min());
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(1999)));
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(2000)));
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(2002)));
+}
+
+// Stands in for a benchmark of receiving at a high packet rate: packets with
+// losses and reordering, acked every other packet, must agree with the ack
+// frame on which packets have been received.
+TEST_F(QuicReceivedPacketManagerTest, ManyPacketsWithLossAndReordering) {
+  const uint64_t kNumPackets = 200000;
+  received_manager_.set_max_ack_ranges(255);
+  uint64_t num_received = 0;
+  auto receive = [this, &num_received](uint64_t packet_number) {
+    ASSERT_TRUE(
+        received_manager_.IsAwaitingPacket(QuicPacketNumber(packet_number)));
+    RecordPacketReceipt(packet_number);
+    if (++num_received % 2 == 0) {
+      received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+      received_manager_.ResetAckStates();
+    }
+    for (uint64_t distance : {0, 1, 5, 600}) {
+      if (distance >= packet_number) {
+        continue;
+      }
+      const QuicPacketNumber earlier(packet_number - distance);
+      ASSERT_EQ(!received_manager_.ack_frame().packets.Contains(earlier),
+                received_manager_.IsAwaitingPacket(earlier))
+          << earlier;
+    }
+  };
+  for (uint64_t i = 1; i <= kNumPackets; ++i) {
+    // Every 1000th packet is lost, and every 100th arrives 5 packets late.
+    if (i % 1000 != 0 && i % 100 != 50) {
+      receive(i);
+    }
+    if (i % 100 == 55) {
+      receive(i - 5);
+    }
+  }
+  EXPECT_EQ(QuicPacketNumber(kNumPackets - 1),
+            received_manager_.GetLargestObserved());
+}
+
 TEST_F(QuicReceivedPacketManagerTest, IgnoreOutOfOrderTimestamps) {
   EXPECT_FALSE(received_manager_.ack_frame_updated());
   RecordPacketReceipt(1, QuicTime::Zero());
@@ -485,6 +560,80 @@ TEST_F(QuicReceivedPacketManagerTest,
   CheckAckTimeout(ack_time);
 }
 
+TEST_F(QuicReceivedPacketManagerTest, AdaptiveAckDecimation) {
+  QuicReceivedPacketManagerPeer::SetAdaptiveAckDecimation(&received_manager_,
+                                                          true);
+  // The max ack delay is min_rtt/4 = 10ms, during which 100 packets arrive at
+  // one packet per 100us.
+  const QuicTime::Delta kPacketInterval =
+      QuicTime::Delta::FromMicroseconds(100);
+  uint64_t packet_number = 1;
+  // Receive packets for more than one min_rtt, acking when due.
+  for (; packet_number <= 500; ++packet_number) {
+    clock_.AdvanceTime(kPacketInterval);
+    RecordPacketReceipt(packet_number, clock_.ApproximateNow());
+    MaybeUpdateAckTimeout(kInstigateAck, packet_number);
+    if (received_manager_.ack_timeout() <= clock_.ApproximateNow()) {
+      received_manager_.ResetAckStates();
+    }
+  }
+  // Flush the pending ack, then the next ack is sent after 100 packets.
+  received_manager_.ResetAckStates();
+  for (uint64_t i = 1; i < 100; ++i, ++packet_number) {
+    clock_.AdvanceTime(kPacketInterval);
+    RecordPacketReceipt(packet_number, clock_.ApproximateNow());
+    MaybeUpdateAckTimeout(kInstigateAck, packet_number);
+    EXPECT_LT(clock_.ApproximateNow(), received_manager_.ack_timeout());
+  }
+  clock_.AdvanceTime(kPacketInterval);
+  RecordPacketReceipt(packet_number, clock_.ApproximateNow());
+  MaybeUpdateAckTimeout(kInstigateAck, packet_number);
+  CheckAckTimeout(clock_.ApproximateNow());
+}
+
+// Stands in for a simulation of a fast download: the receiver sends 5 times
+// fewer acks with adaptive ack decimation, and never waits for longer than
+// the max ack delay to ack.
+TEST_F(QuicReceivedPacketManagerTest, AdaptiveAckDecimationReducesAcks) {
+  // 1 Gbps of 1250 byte packets.
+  const QuicTime::Delta kPacketInterval = QuicTime::Delta::FromMicroseconds(10);
+  const uint64_t kNumPackets = 100000;
+  auto count_acks = [&](QuicReceivedPacketManager* manager) {
+    uint64_t num_acks = 0;
+    for (uint64_t i = 1; i <= kNumPackets; ++i) {
+      clock_.AdvanceTime(kPacketInterval);
+      if (manager->ack_timeout().IsInitialized() &&
+          manager->ack_timeout() <= clock_.ApproximateNow()) {
+        manager->ResetAckStates();
+        ++num_acks;
+      }
+      QuicPacketHeader header;
+      header.packet_number = QuicPacketNumber(i);
+      manager->RecordPacketReceived(header, clock_.ApproximateNow());
+      manager->MaybeUpdateAckTimeout(kInstigateAck, QuicPacketNumber(i),
+                                     clock_.ApproximateNow(),
+                                     clock_.ApproximateNow(), &rtt_stats_);
+      EXPECT_GE(clock_.ApproximateNow() + kDelayedAckTime,
+                manager->ack_timeout());
+      if (manager->ack_timeout() <= clock_.ApproximateNow()) {
+        manager->ResetAckStates();
+        ++num_acks;
+      }
+    }
+    return num_acks;
+  };
+
+  QuicConnectionStats stats;
+  QuicReceivedPacketManager fixed_manager(&stats);
+  const uint64_t fixed_acks = count_acks(&fixed_manager);
+  QuicReceivedPacketManager adaptive_manager(&stats);
+  QuicReceivedPacketManagerPeer::SetAdaptiveAckDecimation(&adaptive_manager,
+                                                          true);
+  const uint64_t adaptive_acks = count_acks(&adaptive_manager);
+  EXPECT_LE(kNumPackets / kMaxRetransmittablePacketsBeforeAck, fixed_acks);
+  EXPECT_GE(fixed_acks / 5, adaptive_acks);
+}
+
 TEST_F(QuicReceivedPacketManagerTest, SendDelayedAckDecimationEighthRtt) {
   EXPECT_FALSE(HasPendingAck());
   QuicReceivedPacketManagerPeer::SetAckDecimationDelay(&received_manager_,
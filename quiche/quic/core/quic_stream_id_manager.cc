@@ -108,6 +108,26 @@ void QuicStreamIdManager::MaybeSendMaxStreamsFrame() {
   SendMaxStreamsFrame();
 }
 
+void QuicStreamIdManager::MaybeSendMaxStreamsFrameOnNewStream() {
+  if (incoming_advertised_max_streams_ >= incoming_actual_max_streams_) {
+    // No stream has closed since the last MAX_STREAMS.
+    return;
+  }
+  // MAX_STREAMS frames are normally sent when streams close. If the peer opens
+  // streams faster than they close, it may run out of stream ids before the
+  // next one closes, so advertise the streams closed so far once half of the
+  // usual window is left. The threshold does not depend on how fast the peer
+  // opens streams: the manager has no clock, and the window is already sized
+  // for the number of streams the peer may open in a round trip.
+  int divisor = GetQuicFlag(FLAGS_quic_max_streams_window_divisor);
+  if (divisor > 0 &&
+      (incoming_advertised_max_streams_ - incoming_stream_count_) >
+          (incoming_initial_max_open_streams_ / divisor / 2)) {
+    return;
+  }
+  SendMaxStreamsFrame();
+}
+
 void QuicStreamIdManager::SendMaxStreamsFrame() {
   QUIC_BUG_IF(quic_bug_12413_2,
               incoming_advertised_max_streams_ >= incoming_actual_max_streams_);
@@ -159,8 +179,10 @@ bool QuicStreamIdManager::MaybeIncreaseLargestPeerStreamId(
   QUICHE_DCHECK_NE(QuicUtils::IsServerInitiatedStreamId(
                        version_.transport_version, stream_id),
                    perspective_ == Perspective::IS_SERVER);
-  if (available_streams_.erase(stream_id) == 1) {
+  if (IsSkippedIncomingStream(stream_id)) {
     // stream_id is available.
+    const QuicStreamCount index = GetIncomingStreamIndex(stream_id);
+    available_streams_.Difference(index, index + 1);
     return true;
   }
 
@@ -192,11 +214,14 @@ bool QuicStreamIdManager::MaybeIncreaseLargestPeerStreamId(
     return false;
   }
 
-  for (QuicStreamId id = least_new_stream_id; id < stream_id; id += delta) {
-    available_streams_.insert(id);
+  if (stream_count_increment > 1) {
+    // The stream ids skipped by the peer remain available.
+    available_streams_.Add(incoming_stream_count_,
+                           incoming_stream_count_ + stream_count_increment - 1);
   }
   incoming_stream_count_ += stream_count_increment;
   largest_peer_created_stream_id_ = stream_id;
+  MaybeSendMaxStreamsFrameOnNewStream();
   return true;
 }
 
@@ -211,8 +236,7 @@ bool QuicStreamIdManager::IsAvailableStream(QuicStreamId id) const {
   // For peer created streams, we also need to consider available streams.
   return largest_peer_created_stream_id_ ==
              QuicUtils::GetInvalidStreamId(version_.transport_version) ||
-         id > largest_peer_created_stream_id_ ||
-         available_streams_.contains(id);
+         id > largest_peer_created_stream_id_ || IsSkippedIncomingStream(id);
 }
 
 QuicStreamId QuicStreamIdManager::GetFirstOutgoingStreamId() const {
@@ -231,6 +255,21 @@ QuicStreamId QuicStreamIdManager::GetFirstIncomingStreamId() const {
                                  QuicUtils::InvertPerspective(perspective_));
 }
 
+QuicStreamCount QuicStreamIdManager::GetIncomingStreamIndex(
+    QuicStreamId id) const {
+  QUICHE_DCHECK_GE(id, GetFirstIncomingStreamId());
+  return (id - GetFirstIncomingStreamId()) /
+         QuicUtils::StreamIdDelta(version_.transport_version);
+}
+
+bool QuicStreamIdManager::IsSkippedIncomingStream(QuicStreamId id) const {
+  return !available_streams_.Empty() && id >= GetFirstIncomingStreamId() &&
+         (id - GetFirstIncomingStreamId()) %
+                 QuicUtils::StreamIdDelta(version_.transport_version) ==
+             0 &&
+         available_streams_.Contains(GetIncomingStreamIndex(id));
+}
+
 QuicStreamCount QuicStreamIdManager::available_incoming_streams() const {
   return incoming_advertised_max_streams_ - incoming_stream_count_;
 }
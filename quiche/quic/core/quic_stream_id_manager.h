@@ -4,9 +4,9 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_STREAM_ID_MANAGER_H_
 #define QUICHE_QUIC_CORE_QUIC_STREAM_ID_MANAGER_H_
 
-#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "quiche/quic/core/frames/quic_frame.h"
+#include "quiche/quic/core/quic_interval_set.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/core/quic_versions.h"
 #include "quiche/quic/platform/api/quic_logging.h"
@@ -50,7 +50,7 @@ class QUIC_EXPORT_PRIVATE QuicStreamIdManager {
         ", incoming_advertised_max_streams_: ",
         incoming_advertised_max_streams_,
         ", incoming_stream_count_: ", incoming_stream_count_,
-        ", available_streams_.size(): ", available_streams_.size(),
+        ", available_streams_: ", available_streams_.ToString(),
         ", largest_peer_created_stream_id_: ", largest_peer_created_stream_id_,
         " }");
   }
@@ -125,12 +125,25 @@ class QUIC_EXPORT_PRIVATE QuicStreamIdManager {
   // generate and send a MAX_STREAMS frame.
   void MaybeSendMaxStreamsFrame();
 
+  // Called when the peer creates new streams. Sends a MAX_STREAMS frame if the
+  // peer is about to run out of stream ids while streams closed since the
+  // last one are not advertised yet.
+  void MaybeSendMaxStreamsFrameOnNewStream();
+
   // Get what should be the first incoming/outgoing stream ID that
   // this stream id manager will manage, taking into account directionality and
   // client/server perspective.
   QuicStreamId GetFirstOutgoingStreamId() const;
   QuicStreamId GetFirstIncomingStreamId() const;
 
+  // Returns the index of incoming stream |id| in the order of creation, i.e.,
+  // the number of incoming streams with lower ids.
+  QuicStreamCount GetIncomingStreamIndex(QuicStreamId id) const;
+
+  // Returns true if incoming stream |id| is less than the largest stream id
+  // that has been received but has not been created yet.
+  bool IsSkippedIncomingStream(QuicStreamId id) const;
+
   // Back reference to the session containing this Stream ID Manager.
   DelegateInterface* delegate_;
 
@@ -173,9 +186,11 @@ class QUIC_EXPORT_PRIVATE QuicStreamIdManager {
   // closed ones.
   QuicStreamCount incoming_stream_count_;
 
-  // Set of stream ids that are less than the largest stream id that has been
-  // received, but are nonetheless available to be created.
-  absl::flat_hash_set<QuicStreamId> available_streams_;
+  // Indices (see GetIncomingStreamIndex()) of the stream ids that are less
+  // than the largest stream id that has been received, but are nonetheless
+  // available to be created. Stored as intervals, so that a peer skipping any
+  // number of stream ids costs a single insertion.
+  QuicIntervalSet<QuicStreamCount> available_streams_;
 
   QuicStreamId largest_peer_created_stream_id_;
 };
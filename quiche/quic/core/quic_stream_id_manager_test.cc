@@ -452,6 +452,79 @@ TEST_P(QuicStreamIdManagerTest, AvailableStreams) {
   EXPECT_TRUE(stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(4)));
 }
 
+TEST_P(QuicStreamIdManagerTest, AvailableStreamsAfterLargeGap) {
+  EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+      GetNthIncomingStreamId(90), nullptr));
+  for (int i = 0; i < 90; ++i) {
+    EXPECT_TRUE(
+        stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(i)));
+  }
+  EXPECT_FALSE(
+      stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(90)));
+  EXPECT_EQ(9u, stream_id_manager_.available_incoming_streams());
+
+  // Creating a skipped stream does not count against the limit again.
+  EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+      GetNthIncomingStreamId(45), nullptr));
+  EXPECT_FALSE(
+      stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(45)));
+  EXPECT_TRUE(stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(44)));
+  EXPECT_TRUE(stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(46)));
+  EXPECT_EQ(9u, stream_id_manager_.available_incoming_streams());
+}
+
+TEST_P(QuicStreamIdManagerTest, MaxStreamsSentWhenStreamsOpenFasterThanClose) {
+  const QuicStreamCount window =
+      stream_id_manager_.incoming_initial_max_open_streams() /
+      GetQuicFlag(FLAGS_quic_max_streams_window_divisor);
+  // Streams closed early leave the window large enough to not advertise them.
+  QuicStreamCount created = 0;
+  for (; created < 10; ++created) {
+    EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+        GetNthIncomingStreamId(created), nullptr));
+    stream_id_manager_.OnStreamClosed(GetNthIncomingStreamId(created));
+  }
+  const QuicStreamCount actual_max =
+      stream_id_manager_.incoming_actual_max_streams();
+  EXPECT_LT(stream_id_manager_.incoming_advertised_max_streams(), actual_max);
+
+  // The peer keeps opening streams without any of them closing. The closed
+  // streams are advertised once half of the window is left.
+  const QuicStreamCount streams_left =
+      stream_id_manager_.incoming_advertised_max_streams() - window / 2;
+  for (; created < streams_left - 1; ++created) {
+    EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+        GetNthIncomingStreamId(created), nullptr));
+  }
+  EXPECT_CALL(delegate_, SendMaxStreams(actual_max, IsUnidirectional()));
+  EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+      GetNthIncomingStreamId(created), nullptr));
+  EXPECT_EQ(actual_max, stream_id_manager_.incoming_advertised_max_streams());
+}
+
+// Stands in for a benchmark of stream churn: a peer opening and closing many
+// streams, skipping every other stream id.
+TEST_P(QuicStreamIdManagerTest, ManyStreamsWithGaps) {
+  EXPECT_CALL(delegate_, SendMaxStreams(_, IsUnidirectional()))
+      .Times(testing::AnyNumber());
+  const int kNumStreams = 100000;
+  for (int i = 1; i < kNumStreams; i += 2) {
+    const QuicStreamId id = GetNthIncomingStreamId(i);
+    ASSERT_TRUE(
+        stream_id_manager_.MaybeIncreaseLargestPeerStreamId(id, nullptr));
+    stream_id_manager_.OnStreamClosed(id);
+    // The skipped stream is opened late and closed as well.
+    const QuicStreamId skipped_id = GetNthIncomingStreamId(i - 1);
+    EXPECT_TRUE(stream_id_manager_.IsAvailableStream(skipped_id));
+    ASSERT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(skipped_id,
+                                                                    nullptr));
+    stream_id_manager_.OnStreamClosed(skipped_id);
+  }
+  EXPECT_FALSE(stream_id_manager_.IsAvailableStream(GetNthIncomingStreamId(0)));
+  EXPECT_TRUE(stream_id_manager_.IsAvailableStream(
+      GetNthIncomingStreamId(kNumStreams)));
+}
+
 // Tests that if MaybeIncreaseLargestPeerStreamId is given an extremely
 // large stream ID (larger than the limit) it is rejected.
 // This is a regression for Chromium bugs 909987 and 910040
@@ -261,7 +261,7 @@ void QuicTimeWaitListManager::SendVersionNegotiationPacket(
     const QuicSocketAddress& peer_address,
     std::unique_ptr<QuicPerPacketContext> packet_context) {
   std::unique_ptr<QuicEncryptedPacket> version_packet =
-      QuicFramer::BuildVersionNegotiationPacket(
+      version_negotiation_packet_cache_.BuildVersionNegotiationPacket(
           server_connection_id, client_connection_id, ietf_quic,
           use_length_prefix, supported_versions);
   QUIC_DVLOG(2) << "Dispatcher sending version negotiation packet {"
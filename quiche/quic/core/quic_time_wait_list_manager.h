@@ -19,6 +19,7 @@
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/core/quic_session.h"
 #include "quiche/quic/core/quic_types.h"
+#include "quiche/quic/core/quic_version_negotiation_packet_cache.h"
 #include "quiche/quic/platform/api/quic_flags.h"
 #include "quiche/common/quiche_linked_hash_map.h"
 
@@ -324,6 +325,9 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
 
   // Interface that manages blocked writers.
   Visitor* visitor_;
+
+  // Templates of the version negotiation packets sent to unknown versions.
+  QuicVersionNegotiationPacketCache version_negotiation_packet_cache_;
 };
 
 }  // namespace quic
@@ -849,6 +849,10 @@ struct QUIC_NO_EXPORT QuicSSLConfig {
   absl::optional<absl::InlinedVector<uint16_t, 8>> signing_algorithm_prefs;
   // Client certificate mode for mTLS support. Only used at server side.
   ClientCertMode client_cert_mode = ClientCertMode::kNone;
+  // Whether the SSL object releases its handshake configuration, such as the
+  // certificate chain and private key, once the handshake is complete. If not
+  // set, default to not releasing it.
+  absl::optional<bool> shed_handshake_config;
 };
 
 // QuicDelayedSSLConfig contains a subset of SSL config that can be applied
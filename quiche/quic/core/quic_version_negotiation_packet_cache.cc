@@ -0,0 +1,125 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_version_negotiation_packet_cache.h"
+
+#include <cstring>
+#include <utility>
+
+#include "quiche/quic/core/crypto/quic_random.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_data_writer.h"
+#include "quiche/quic/core/quic_framer.h"
+#include "quiche/quic/platform/api/quic_flag_utils.h"
+#include "quiche/quic/platform/api/quic_flags.h"
+
+namespace quic {
+
+namespace {
+
+uint32_t TemplateKey(bool use_length_prefix,
+                     uint8_t server_connection_id_length,
+                     uint8_t client_connection_id_length) {
+  return (static_cast<uint32_t>(use_length_prefix) << 16) |
+         (static_cast<uint32_t>(server_connection_id_length) << 8) |
+         client_connection_id_length;
+}
+
+}  // namespace
+
+QuicVersionNegotiationPacketCache::QuicVersionNegotiationPacketCache() =
+    default;
+
+QuicVersionNegotiationPacketCache::~QuicVersionNegotiationPacketCache() =
+    default;
+
+std::unique_ptr<QuicEncryptedPacket>
+QuicVersionNegotiationPacketCache::BuildVersionNegotiationPacket(
+    QuicConnectionId server_connection_id,
+    QuicConnectionId client_connection_id, bool ietf_quic,
+    bool use_length_prefix, const ParsedQuicVersionVector& versions) {
+  // Connection ID lengths are chosen by the peer. Only lengths valid in
+  // QUIC versions which use length prefixes are cached, which bounds the
+  // number of templates; longer ones are rare enough to be built directly.
+  if (!ietf_quic || versions.empty() ||
+      server_connection_id.length() >
+          kQuicMaxConnectionIdWithLengthPrefixLength ||
+      client_connection_id.length() >
+          kQuicMaxConnectionIdWithLengthPrefixLength) {
+    return QuicFramer::BuildVersionNegotiationPacket(
+        server_connection_id, client_connection_id, ietf_quic,
+        use_length_prefix, versions);
+  }
+  if (versions != versions_) {
+    templates_.clear();
+    versions_ = versions;
+  }
+
+  const uint8_t server_connection_id_length = server_connection_id.length();
+  const uint8_t client_connection_id_length = client_connection_id.length();
+  const uint32_t key =
+      TemplateKey(use_length_prefix, server_connection_id_length,
+                  client_connection_id_length);
+  auto it = templates_.find(key);
+  if (it == templates_.end()) {
+    ParsedQuicVersionVector wire_versions;
+    wire_versions.reserve(versions.size() + 1);
+    wire_versions.push_back(QuicVersionReservedForNegotiation());
+    wire_versions.insert(wire_versions.end(), versions.begin(),
+                         versions.end());
+    const std::string server_zeros(server_connection_id_length, '\0');
+    const std::string client_zeros(client_connection_id_length, '\0');
+    std::unique_ptr<QuicEncryptedPacket> packet =
+        QuicFramer::BuildIetfVersionNegotiationPacket(
+            use_length_prefix,
+            QuicConnectionId(server_zeros.data(), server_connection_id_length),
+            QuicConnectionId(client_zeros.data(), client_connection_id_length),
+            wire_versions);
+    if (packet == nullptr) {
+      return nullptr;
+    }
+    PacketTemplate packet_template;
+    packet_template.packet = std::string(packet->data(), packet->length());
+    // The client connection ID is the destination connection ID, it follows
+    // the type byte, the version and its length byte.
+    packet_template.client_connection_id_offset =
+        kPacketHeaderTypeSize + kQuicVersionSize + kConnectionIdLengthSize;
+    packet_template.server_connection_id_offset =
+        packet_template.client_connection_id_offset +
+        client_connection_id_length +
+        (use_length_prefix ? kConnectionIdLengthSize : 0);
+    packet_template.versions_offset =
+        packet->length() - wire_versions.size() * kQuicVersionSize;
+    it = templates_.emplace(key, std::move(packet_template)).first;
+  }
+  QUIC_CODE_COUNT(quic_build_version_negotiation_from_template);
+
+  const PacketTemplate& packet_template = it->second;
+  const size_t len = packet_template.packet.length();
+  std::unique_ptr<char[]> buffer(new char[len]);
+  memcpy(buffer.get(), packet_template.packet.data(), len);
+  memcpy(buffer.get() + packet_template.client_connection_id_offset,
+         client_connection_id.data(), client_connection_id_length);
+  memcpy(buffer.get() + packet_template.server_connection_id_offset,
+         server_connection_id.data(), server_connection_id_length);
+
+  // Move the reserved version to a random position, the same way
+  // QuicFramer::BuildVersionNegotiationPacket inserts it.
+  size_t version_index = 0;
+  if (!GetQuicFlag(FLAGS_quic_disable_version_negotiation_grease_randomness)) {
+    version_index =
+        QuicRandom::GetInstance()->RandUint64() % (versions.size() + 1);
+  }
+  char* wire_versions = buffer.get() + packet_template.versions_offset;
+  memmove(wire_versions, wire_versions + kQuicVersionSize,
+          version_index * kQuicVersionSize);
+  QuicDataWriter writer(kQuicVersionSize,
+                        wire_versions + version_index * kQuicVersionSize);
+  writer.WriteUInt32(
+      CreateQuicVersionLabel(QuicVersionReservedForNegotiation()));
+
+  return std::make_unique<QuicEncryptedPacket>(buffer.release(), len, true);
+}
+
+}  // namespace quic
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
+#define QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Builds IETF version negotiation packets from templates serialized once per
+// supported version set and pair of connection ID lengths. Building a packet
+// only copies the template, fills in the connection IDs and moves the
+// reserved version to its random position, which keeps the cost of answering
+// scanning traffic low. The packets are identical to the ones built by
+// QuicFramer::BuildVersionNegotiationPacket.
+class QUIC_EXPORT_PRIVATE QuicVersionNegotiationPacketCache {
+ public:
+  QuicVersionNegotiationPacketCache();
+  QuicVersionNegotiationPacketCache(const QuicVersionNegotiationPacketCache&) =
+      delete;
+  QuicVersionNegotiationPacketCache& operator=(
+      const QuicVersionNegotiationPacketCache&) = delete;
+  ~QuicVersionNegotiationPacketCache();
+
+  // Same as QuicFramer::BuildVersionNegotiationPacket. Google QUIC packets,
+  // empty version sets and connection IDs longer than
+  // kQuicMaxConnectionIdWithLengthPrefixLength are passed through to
+  // QuicFramer. Templates are dropped when |versions| differs from the
+  // previous call.
+  std::unique_ptr<QuicEncryptedPacket> BuildVersionNegotiationPacket(
+      QuicConnectionId server_connection_id,
+      QuicConnectionId client_connection_id, bool ietf_quic,
+      bool use_length_prefix, const ParsedQuicVersionVector& versions);
+
+  size_t num_templates() const { return templates_.size(); }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE PacketTemplate {
+    // Packet with zeroed connection IDs and the reserved version first.
+    std::string packet;
+    size_t client_connection_id_offset;
+    size_t server_connection_id_offset;
+    size_t versions_offset;
+  };
+
+  // Version set the templates have been built for.
+  ParsedQuicVersionVector versions_;
+  // Keyed by length prefix usage and connection ID lengths, so it holds at
+  // most 2 * 21 * 21 templates.
+  absl::flat_hash_map<uint32_t, PacketTemplate> templates_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
@@ -0,0 +1,141 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_version_negotiation_packet_cache.h"
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_data_reader.h"
+#include "quiche/quic/core/quic_framer.h"
+#include "quiche/quic/platform/api/quic_flags.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+#include "quiche/common/test_tools/quiche_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicVersionNegotiationPacketCacheTest : public QuicTest {
+ protected:
+  QuicVersionNegotiationPacketCacheTest()
+      : versions_(CurrentSupportedVersions()) {
+    SetQuicFlag(FLAGS_quic_disable_version_negotiation_grease_randomness,
+                true);
+  }
+
+  // Builds a packet with the cache and with QuicFramer and expects them to be
+  // identical.
+  void ExpectSameAsFramer(QuicConnectionId server_connection_id,
+                          QuicConnectionId client_connection_id,
+                          bool ietf_quic, bool use_length_prefix) {
+    std::unique_ptr<QuicEncryptedPacket> expected =
+        QuicFramer::BuildVersionNegotiationPacket(
+            server_connection_id, client_connection_id, ietf_quic,
+            use_length_prefix, versions_);
+    std::unique_ptr<QuicEncryptedPacket> packet =
+        cache_.BuildVersionNegotiationPacket(server_connection_id,
+                                             client_connection_id, ietf_quic,
+                                             use_length_prefix, versions_);
+    ASSERT_NE(nullptr, expected);
+    ASSERT_NE(nullptr, packet);
+    quiche::test::CompareCharArraysWithHexError(
+        "version negotiation packet", packet->data(), packet->length(),
+        expected->data(), expected->length());
+  }
+
+  ParsedQuicVersionVector versions_;
+  QuicVersionNegotiationPacketCache cache_;
+};
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, LengthPrefixed) {
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  char client_connection_id_bytes[] = {1, 2, 3, 4, 5};
+  ExpectSameAsFramer(TestConnectionId(2),
+                     QuicConnectionId(client_connection_id_bytes,
+                                      sizeof(client_connection_id_bytes)),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  EXPECT_EQ(2u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, NotLengthPrefixed) {
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/false);
+  EXPECT_EQ(1u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, ReuseTemplate) {
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  // Same lengths, different connection IDs.
+  ExpectSameAsFramer(TestConnectionId(2), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  EXPECT_EQ(1u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, VersionsChange) {
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  versions_.pop_back();
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  EXPECT_EQ(1u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, GoogleQuicIsNotCached) {
+  ExpectSameAsFramer(TestConnectionId(1), EmptyQuicConnectionId(),
+                     /*ietf_quic=*/false, /*use_length_prefix=*/false);
+  EXPECT_EQ(0u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, LongConnectionIdIsNotCached) {
+  char long_connection_id_bytes[kQuicMaxConnectionIdWithLengthPrefixLength +
+                                1] = {};
+  QuicConnectionId long_connection_id(long_connection_id_bytes,
+                                      sizeof(long_connection_id_bytes));
+  ExpectSameAsFramer(long_connection_id, EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  ExpectSameAsFramer(TestConnectionId(1), long_connection_id,
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  EXPECT_EQ(0u, cache_.num_templates());
+
+  char max_connection_id_bytes[kQuicMaxConnectionIdWithLengthPrefixLength] =
+      {};
+  ExpectSameAsFramer(QuicConnectionId(max_connection_id_bytes,
+                                      sizeof(max_connection_id_bytes)),
+                     EmptyQuicConnectionId(),
+                     /*ietf_quic=*/true, /*use_length_prefix=*/true);
+  EXPECT_EQ(1u, cache_.num_templates());
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, RandomReservedVersionPosition) {
+  SetQuicFlag(FLAGS_quic_disable_version_negotiation_grease_randomness, false);
+  for (int i = 0; i < 20; ++i) {
+    std::unique_ptr<QuicEncryptedPacket> packet =
+        cache_.BuildVersionNegotiationPacket(
+            TestConnectionId(i), EmptyQuicConnectionId(),
+            /*ietf_quic=*/true, /*use_length_prefix=*/true, versions_);
+    ASSERT_NE(nullptr, packet);
+    // The supported versions keep their order around the reserved version.
+    QuicVersionLabelVector labels;
+    absl::string_view wire_versions(
+        packet->data() + packet->length() -
+            (versions_.size() + 1) * kQuicVersionSize,
+        (versions_.size() + 1) * kQuicVersionSize);
+    QuicDataReader reader(wire_versions);
+    QuicVersionLabel label;
+    while (reader.ReadUInt32(&label)) {
+      if ((label & 0x0f0f0f0f) != 0x0a0a0a0a) {
+        labels.push_back(label);
+      }
+    }
+    EXPECT_EQ(CreateQuicVersionLabelVector(versions_), labels);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -4,12 +4,13 @@
 
 #include "quiche/quic/core/tls_chlo_extractor.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
-#include "openssl/ssl.h"
 #include "quiche/quic/core/frames/quic_crypto_frame.h"
 #include "quiche/quic/core/quic_data_reader.h"
 #include "quiche/quic/core/quic_error_codes.h"
@@ -22,13 +23,23 @@
 namespace quic {
 
 namespace {
-bool HasExtension(const SSL_CLIENT_HELLO* client_hello, uint16_t extension) {
-  const uint8_t* unused_extension_bytes;
-  size_t unused_extension_len;
-  return 1 == SSL_early_callback_ctx_extension_get(client_hello, extension,
-                                                   &unused_extension_bytes,
-                                                   &unused_extension_len);
-}
+
+// TLS handshake message type and extension codepoints, from RFC 8446.
+constexpr uint8_t kClientHelloMessageType = 1;
+constexpr uint16_t kServerNameExtension = 0;
+constexpr uint16_t kAlpnExtension = 16;
+constexpr uint16_t kPreSharedKeyExtension = 41;
+constexpr uint16_t kEarlyDataExtension = 42;
+// The only name type of the 'server_name' extension, from RFC 6066.
+constexpr uint8_t kHostNameType = 0;
+constexpr size_t kMaxHostNameLength = 255;
+constexpr size_t kMaxSessionIdLength = 32;
+constexpr size_t kClientHelloRandomLength = 32;
+// Size of the type and length of a TLS handshake message.
+constexpr size_t kHandshakeMessageHeaderLength = 4;
+// Largest ClientHello accepted, the same limit as BoringSSL's.
+constexpr size_t kMaxChloLength = 16384;
+
 }  // namespace
 
 TlsChloExtractor::TlsChloExtractor()
@@ -48,19 +59,15 @@ TlsChloExtractor& TlsChloExtractor::operator=(TlsChloExtractor&& other) {
   }
   crypto_stream_sequencer_ = std::move(other.crypto_stream_sequencer_);
   crypto_stream_sequencer_.set_stream(this);
-  ssl_ = std::move(other.ssl_);
-  if (ssl_) {
-    std::pair<SSL_CTX*, int> shared_handles = GetSharedSslHandles();
-    int ex_data_index = shared_handles.second;
-    const int rv = SSL_set_ex_data(ssl_.get(), ex_data_index, this);
-    QUICHE_CHECK_EQ(rv, 1) << "Internal allocation failure in SSL_set_ex_data";
-  }
+  chlo_data_ = std::move(other.chlo_data_);
   state_ = other.state_;
   error_details_ = std::move(other.error_details_);
   parsed_crypto_frame_in_this_packet_ =
       other.parsed_crypto_frame_in_this_packet_;
   alpns_ = std::move(other.alpns_);
   server_name_ = std::move(other.server_name_);
+  resumption_attempted_ = other.resumption_attempted_;
+  early_data_attempted_ = other.early_data_attempted_;
   return *this;
 }
 
@@ -179,139 +186,71 @@ bool TlsChloExtractor::OnCryptoFrame(const QuicCryptoFrame& frame) {
 // Called by the QuicStreamSequencer when it receives a CRYPTO frame that
 // advances the amount of contiguous data we now have starting from offset 0.
 void TlsChloExtractor::OnDataAvailable() {
-  // Lazily set up BoringSSL handle.
-  SetupSslHandle();
+  if (HasParsedFullChlo() || state_ == State::kUnrecoverableFailure) {
+    return;
+  }
 
-  // Get data from the stream sequencer and pass it to BoringSSL.
+  // Get data from the stream sequencer, up to the end of the CHLO if its
+  // length is known.
   struct iovec iov;
   while (crypto_stream_sequencer_.GetReadableRegion(&iov)) {
-    const int rv = SSL_provide_quic_data(
-        ssl_.get(), ssl_encryption_initial,
-        reinterpret_cast<const uint8_t*>(iov.iov_base), iov.iov_len);
-    if (rv != 1) {
-      HandleUnrecoverableError("SSL_provide_quic_data failed");
+    chlo_data_.append(static_cast<const char*>(iov.iov_base), iov.iov_len);
+    crypto_stream_sequencer_.MarkConsumed(iov.iov_len);
+    if (MaybeAttemptToParseChloLength()) {
+      AttemptToParseFullChlo();
+      return;
+    }
+    if (state_ == State::kUnrecoverableFailure) {
       return;
     }
-    crypto_stream_sequencer_.MarkConsumed(iov.iov_len);
   }
-
-  // Instruct BoringSSL to attempt parsing a full CHLO from the provided data.
-  // We ignore the return value since we know the handshake is going to fail
-  // because we explicitly cancel processing once we've parsed the CHLO.
-  (void)SSL_do_handshake(ssl_.get());
 }
 
-// static
-TlsChloExtractor* TlsChloExtractor::GetInstanceFromSSL(SSL* ssl) {
-  std::pair<SSL_CTX*, int> shared_handles = GetSharedSslHandles();
-  int ex_data_index = shared_handles.second;
-  return reinterpret_cast<TlsChloExtractor*>(
-      SSL_get_ex_data(ssl, ex_data_index));
-}
-
-// static
-int TlsChloExtractor::SetReadSecretCallback(
-    SSL* ssl, enum ssl_encryption_level_t /*level*/,
-    const SSL_CIPHER* /*cipher*/, const uint8_t* /*secret*/,
-    size_t /*secret_length*/) {
-  GetInstanceFromSSL(ssl)->HandleUnexpectedCallback("SetReadSecretCallback");
-  return 0;
-}
-
-// static
-int TlsChloExtractor::SetWriteSecretCallback(
-    SSL* ssl, enum ssl_encryption_level_t /*level*/,
-    const SSL_CIPHER* /*cipher*/, const uint8_t* /*secret*/,
-    size_t /*secret_length*/) {
-  GetInstanceFromSSL(ssl)->HandleUnexpectedCallback("SetWriteSecretCallback");
-  return 0;
-}
-
-// static
-int TlsChloExtractor::WriteMessageCallback(
-    SSL* ssl, enum ssl_encryption_level_t /*level*/, const uint8_t* /*data*/,
-    size_t /*len*/) {
-  GetInstanceFromSSL(ssl)->HandleUnexpectedCallback("WriteMessageCallback");
-  return 0;
-}
-
-// static
-int TlsChloExtractor::FlushFlightCallback(SSL* ssl) {
-  GetInstanceFromSSL(ssl)->HandleUnexpectedCallback("FlushFlightCallback");
-  return 0;
-}
-
-void TlsChloExtractor::HandleUnexpectedCallback(
-    const std::string& callback_name) {
-  std::string error_details =
-      absl::StrCat("Unexpected callback ", callback_name);
-  QUIC_BUG(quic_bug_10855_3) << error_details;
-  HandleUnrecoverableError(error_details);
-}
-
-// static
-int TlsChloExtractor::SendAlertCallback(SSL* ssl,
-                                        enum ssl_encryption_level_t /*level*/,
-                                        uint8_t desc) {
-  GetInstanceFromSSL(ssl)->SendAlert(desc);
-  return 0;
+bool TlsChloExtractor::MaybeAttemptToParseChloLength() {
+  if (chlo_data_.size() < kHandshakeMessageHeaderLength) {
+    return false;
+  }
+  QuicDataReader reader(chlo_data_);
+  uint8_t message_type;
+  uint64_t message_length;
+  if (!reader.ReadUInt8(&message_type) ||
+      !reader.ReadBytesToUInt64(3, &message_length)) {
+    HandleUnrecoverableError("Failed to read CHLO header");
+    return false;
+  }
+  if (message_type != kClientHelloMessageType) {
+    HandleUnrecoverableError(absl::StrCat("Unexpected handshake message type ",
+                                          static_cast<int>(message_type)));
+    return false;
+  }
+  if (message_length > kMaxChloLength) {
+    HandleUnrecoverableError(
+        absl::StrCat("CHLO too long: ", message_length, " bytes"));
+    return false;
+  }
+  return chlo_data_.size() >= kHandshakeMessageHeaderLength + message_length;
 }
 
-void TlsChloExtractor::SendAlert(uint8_t tls_alert_value) {
-  if (tls_alert_value == SSL3_AD_HANDSHAKE_FAILURE && HasParsedFullChlo()) {
-    // This is the most common scenario. Since we return an error from
-    // SelectCertCallback in order to cancel further processing, BoringSSL will
-    // try to send this alert to tell the client that the handshake failed.
+void TlsChloExtractor::AttemptToParseFullChlo() {
+  QuicDataReader reader(chlo_data_);
+  uint64_t message_length;
+  if (!reader.Seek(1) || !reader.ReadBytesToUInt64(3, &message_length)) {
+    HandleUnrecoverableError("Failed to read CHLO length");
     return;
   }
-  HandleUnrecoverableError(absl::StrCat(
-      "BoringSSL attempted to send alert ", static_cast<int>(tls_alert_value),
-      " ", SSL_alert_desc_string_long(tls_alert_value)));
-}
-
-// static
-enum ssl_select_cert_result_t TlsChloExtractor::SelectCertCallback(
-    const SSL_CLIENT_HELLO* client_hello) {
-  GetInstanceFromSSL(client_hello->ssl)->HandleParsedChlo(client_hello);
-  // Always return an error to cancel any further processing in BoringSSL.
-  return ssl_select_cert_error;
-}
-
-// Extracts the server name and ALPN from the parsed ClientHello.
-void TlsChloExtractor::HandleParsedChlo(const SSL_CLIENT_HELLO* client_hello) {
-  const char* server_name =
-      SSL_get_servername(client_hello->ssl, TLSEXT_NAMETYPE_host_name);
-  if (server_name) {
-    server_name_ = std::string(server_name);
-  }
-
-  resumption_attempted_ =
-      HasExtension(client_hello, TLSEXT_TYPE_pre_shared_key);
-  early_data_attempted_ = HasExtension(client_hello, TLSEXT_TYPE_early_data);
-
-  const uint8_t* alpn_data;
-  size_t alpn_len;
-  int rv = SSL_early_callback_ctx_extension_get(
-      client_hello, TLSEXT_TYPE_application_layer_protocol_negotiation,
-      &alpn_data, &alpn_len);
-  if (rv == 1) {
-    QuicDataReader alpns_reader(reinterpret_cast<const char*>(alpn_data),
-                                alpn_len);
-    absl::string_view alpns_payload;
-    if (!alpns_reader.ReadStringPiece16(&alpns_payload)) {
-      HandleUnrecoverableError("Failed to read alpns_payload");
-      return;
-    }
-    QuicDataReader alpns_payload_reader(alpns_payload);
-    while (!alpns_payload_reader.IsDoneReading()) {
-      absl::string_view alpn_payload;
-      if (!alpns_payload_reader.ReadStringPiece8(&alpn_payload)) {
-        HandleUnrecoverableError("Failed to read alpn_payload");
-        return;
-      }
-      alpns_.emplace_back(std::string(alpn_payload));
-    }
+  absl::string_view client_hello;
+  if (!reader.ReadStringPiece(&client_hello, message_length) ||
+      !ParseClientHello(client_hello)) {
+    alpns_.clear();
+    server_name_.clear();
+    resumption_attempted_ = false;
+    early_data_attempted_ = false;
+    HandleUnrecoverableError("Failed to parse CHLO");
+    return;
   }
+  // The rest of the crypto stream is not needed.
+  chlo_data_.clear();
+  chlo_data_.shrink_to_fit();
 
   // Update our state now that we've parsed a full CHLO.
   if (state_ == State::kInitial) {
@@ -324,54 +263,133 @@ void TlsChloExtractor::HandleParsedChlo(const SSL_CLIENT_HELLO* client_hello) {
   }
 }
 
-// static
-std::pair<SSL_CTX*, int> TlsChloExtractor::GetSharedSslHandles() {
-  // Use a lambda to benefit from C++11 guarantee that static variables are
-  // initialized lazily in a thread-safe manner. |shared_handles| is therefore
-  // guaranteed to be initialized exactly once and never destructed.
-  static std::pair<SSL_CTX*, int>* shared_handles = []() {
-    CRYPTO_library_init();
-    SSL_CTX* ssl_ctx = SSL_CTX_new(TLS_with_buffers_method());
-    SSL_CTX_set_min_proto_version(ssl_ctx, TLS1_3_VERSION);
-    SSL_CTX_set_max_proto_version(ssl_ctx, TLS1_3_VERSION);
-    static const SSL_QUIC_METHOD kQuicCallbacks{
-        TlsChloExtractor::SetReadSecretCallback,
-        TlsChloExtractor::SetWriteSecretCallback,
-        TlsChloExtractor::WriteMessageCallback,
-        TlsChloExtractor::FlushFlightCallback,
-        TlsChloExtractor::SendAlertCallback};
-    SSL_CTX_set_quic_method(ssl_ctx, &kQuicCallbacks);
-    SSL_CTX_set_select_certificate_cb(ssl_ctx,
-                                      TlsChloExtractor::SelectCertCallback);
-    int ex_data_index =
-        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
-    return new std::pair<SSL_CTX*, int>(ssl_ctx, ex_data_index);
-  }();
-  return *shared_handles;
-}
+// Extracts the server name and ALPN from the ClientHello, applying the same
+// checks as BoringSSL to the parts of the message that are read.
+bool TlsChloExtractor::ParseClientHello(absl::string_view client_hello) {
+  QuicDataReader reader(client_hello);
+  absl::string_view session_id;
+  absl::string_view cipher_suites;
+  absl::string_view compression_methods;
+  // Skip legacy_version and random.
+  if (!reader.Seek(2 + kClientHelloRandomLength) ||
+      !reader.ReadStringPiece8(&session_id) ||
+      session_id.size() > kMaxSessionIdLength ||
+      !reader.ReadStringPiece16(&cipher_suites) || cipher_suites.size() < 2 ||
+      cipher_suites.size() % 2 != 0 ||
+      !reader.ReadStringPiece8(&compression_methods) ||
+      compression_methods.empty()) {
+    QUIC_DLOG(ERROR) << "Failed to parse CHLO fields";
+    return false;
+  }
+  if (reader.IsDoneReading()) {
+    // No extensions.
+    return true;
+  }
+  absl::string_view extensions;
+  if (!reader.ReadStringPiece16(&extensions) || !reader.IsDoneReading()) {
+    QUIC_DLOG(ERROR) << "Failed to parse CHLO extensions";
+    return false;
+  }
 
-// Sets up the per-instance SSL handle needed by BoringSSL.
-void TlsChloExtractor::SetupSslHandle() {
-  if (ssl_) {
-    // Handles have already been set up.
-    return;
+  // Like BoringSSL, reject a ClientHello that repeats an extension type before
+  // looking at the contents of any extension.
+  std::vector<uint16_t> extension_types;
+  QuicDataReader types_reader(extensions);
+  while (!types_reader.IsDoneReading()) {
+    uint16_t extension_type;
+    absl::string_view extension_data;
+    if (!types_reader.ReadUInt16(&extension_type) ||
+        !types_reader.ReadStringPiece16(&extension_data)) {
+      QUIC_DLOG(ERROR) << "Failed to parse CHLO extension";
+      return false;
+    }
+    extension_types.push_back(extension_type);
+  }
+  std::sort(extension_types.begin(), extension_types.end());
+  if (std::adjacent_find(extension_types.begin(), extension_types.end()) !=
+      extension_types.end()) {
+    QUIC_DLOG(ERROR) << "Duplicate CHLO extension";
+    return false;
   }
 
-  std::pair<SSL_CTX*, int> shared_handles = GetSharedSslHandles();
-  SSL_CTX* ssl_ctx = shared_handles.first;
-  int ex_data_index = shared_handles.second;
+  QuicDataReader extensions_reader(extensions);
+  while (!extensions_reader.IsDoneReading()) {
+    uint16_t extension_type;
+    absl::string_view extension_data;
+    if (!extensions_reader.ReadUInt16(&extension_type) ||
+        !extensions_reader.ReadStringPiece16(&extension_data)) {
+      QUIC_DLOG(ERROR) << "Failed to parse CHLO extension";
+      return false;
+    }
+    switch (extension_type) {
+      case kServerNameExtension:
+        if (!ParseServerName(extension_data)) {
+          return false;
+        }
+        break;
+      case kAlpnExtension:
+        if (!ParseAlpns(extension_data)) {
+          return false;
+        }
+        break;
+      case kPreSharedKeyExtension:
+        resumption_attempted_ = true;
+        break;
+      case kEarlyDataExtension:
+        early_data_attempted_ = true;
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
 
-  ssl_ = bssl::UniquePtr<SSL>(SSL_new(ssl_ctx));
-  const int rv = SSL_set_ex_data(ssl_.get(), ex_data_index, this);
-  QUICHE_CHECK_EQ(rv, 1) << "Internal allocation failure in SSL_set_ex_data";
-  SSL_set_accept_state(ssl_.get());
+bool TlsChloExtractor::ParseServerName(absl::string_view extension_data) {
+  QuicDataReader reader(extension_data);
+  absl::string_view server_name_list;
+  uint8_t name_type;
+  absl::string_view host_name;
+  if (!reader.ReadStringPiece16(&server_name_list) ||
+      !reader.IsDoneReading()) {
+    QUIC_DLOG(ERROR) << "Failed to read server_name_list";
+    return false;
+  }
+  QuicDataReader server_name_list_reader(server_name_list);
+  // Like BoringSSL, only accept a single host name.
+  if (!server_name_list_reader.ReadUInt8(&name_type) ||
+      !server_name_list_reader.ReadStringPiece16(&host_name) ||
+      !server_name_list_reader.IsDoneReading() || name_type != kHostNameType ||
+      host_name.empty() || host_name.size() > kMaxHostNameLength ||
+      host_name.find('\0') != absl::string_view::npos) {
+    QUIC_DLOG(ERROR) << "Invalid server_name_list";
+    return false;
+  }
+  server_name_ = std::string(host_name);
+  return true;
+}
 
-  // Make sure we use the right TLS extension codepoint.
-  int use_legacy_extension = 0;
-  if (framer_->version().UsesLegacyTlsExtension()) {
-    use_legacy_extension = 1;
+bool TlsChloExtractor::ParseAlpns(absl::string_view extension_data) {
+  QuicDataReader alpns_reader(extension_data);
+  absl::string_view alpns_payload;
+  // Like BoringSSL, require a non-empty list of non-empty protocol names with
+  // nothing after it.
+  if (!alpns_reader.ReadStringPiece16(&alpns_payload) ||
+      !alpns_reader.IsDoneReading() || alpns_payload.empty()) {
+    QUIC_DLOG(ERROR) << "Failed to read alpns_payload";
+    return false;
+  }
+  QuicDataReader alpns_payload_reader(alpns_payload);
+  while (!alpns_payload_reader.IsDoneReading()) {
+    absl::string_view alpn_payload;
+    if (!alpns_payload_reader.ReadStringPiece8(&alpn_payload) ||
+        alpn_payload.empty()) {
+      QUIC_DLOG(ERROR) << "Failed to read alpn_payload";
+      return false;
+    }
+    alpns_.emplace_back(std::string(alpn_payload));
   }
-  SSL_set_quic_use_legacy_codepoint(ssl_.get(), use_legacy_extension);
+  return true;
 }
 
 // Called by other methods to record any unrecoverable failures they experience.
@@ -9,7 +9,7 @@
 #include <string>
 #include <vector>
 
-#include "openssl/ssl.h"
+#include "absl/strings/string_view.h"
 #include "quiche/quic/core/frames/quic_ack_frequency_frame.h"
 #include "quiche/quic/core/quic_framer.h"
 #include "quiche/quic/core/quic_packets.h"
@@ -19,12 +19,17 @@
 
 namespace quic {
 
+namespace test {
+class TlsChloExtractorPeer;
+}  // namespace test
+
 // Utility class that allows extracting information from a QUIC-TLS Client
 // Hello. This class creates a QuicFramer to parse the packet, and implements
 // QuicFramerVisitorInterface to access the frames parsed by the QuicFramer. It
 // then uses a QuicStreamSequencer to reassemble the contents of the crypto
 // stream, and implements QuicStreamSequencer::StreamInterface to access the
-// reassembled data.
+// reassembled data. The ClientHello is parsed directly rather than with
+// BoringSSL, so that no SSL object is created for each extraction.
 class QUIC_NO_EXPORT TlsChloExtractor
     : public QuicFramerVisitorInterface,
       public QuicStreamSequencer::StreamInterface {
@@ -190,49 +195,30 @@ class QUIC_NO_EXPORT TlsChloExtractor
   ParsedQuicVersion version() const override { return framer_->version(); }
 
  private:
+  friend class test::TlsChloExtractorPeer;
+
   // Parses the length of the CHLO message by looking at the first four bytes.
   // Returns whether we have received enough data to parse the full CHLO now.
   bool MaybeAttemptToParseChloLength();
   // Parses the full CHLO message if enough data has been received.
   void AttemptToParseFullChlo();
+  // Extracts the server name, ALPNs and extension info from the body of the
+  // ClientHello message.
+  bool ParseClientHello(absl::string_view client_hello);
+  // Extracts the server name from the 'server_name' TLS extension.
+  bool ParseServerName(absl::string_view extension_data);
+  // Extracts the ALPNs from the 'application_layer_protocol_negotiation' TLS
+  // extension.
+  bool ParseAlpns(absl::string_view extension_data);
   // Moves to the failed state and records the error details.
   void HandleUnrecoverableError(const std::string& error_details);
-  // Lazily sets up shared SSL handles if needed.
-  static std::pair<SSL_CTX*, int> GetSharedSslHandles();
-  // Lazily sets up the per-instance SSL handle if needed.
-  void SetupSslHandle();
-  // Extract the TlsChloExtractor instance from |ssl|.
-  static TlsChloExtractor* GetInstanceFromSSL(SSL* ssl);
-
-  // BoringSSL static TLS callbacks.
-  static enum ssl_select_cert_result_t SelectCertCallback(
-      const SSL_CLIENT_HELLO* client_hello);
-  static int SetReadSecretCallback(SSL* ssl, enum ssl_encryption_level_t level,
-                                   const SSL_CIPHER* cipher,
-                                   const uint8_t* secret, size_t secret_length);
-  static int SetWriteSecretCallback(SSL* ssl, enum ssl_encryption_level_t level,
-                                    const SSL_CIPHER* cipher,
-                                    const uint8_t* secret,
-                                    size_t secret_length);
-  static int WriteMessageCallback(SSL* ssl, enum ssl_encryption_level_t level,
-                                  const uint8_t* data, size_t len);
-  static int FlushFlightCallback(SSL* ssl);
-  static int SendAlertCallback(SSL* ssl, enum ssl_encryption_level_t level,
-                               uint8_t desc);
-
-  // Called by SelectCertCallback.
-  void HandleParsedChlo(const SSL_CLIENT_HELLO* client_hello);
-  // Called by callbacks that should never be called.
-  void HandleUnexpectedCallback(const std::string& callback_name);
-  // Called by SendAlertCallback.
-  void SendAlert(uint8_t tls_alert_value);
 
   // Used to parse received packets to extract single frames.
   std::unique_ptr<QuicFramer> framer_;
   // Used to reassemble the crypto stream from received CRYPTO frames.
   QuicStreamSequencer crypto_stream_sequencer_;
-  // BoringSSL handle required to parse the CHLO.
-  bssl::UniquePtr<SSL> ssl_;
+  // Reassembled contents of the crypto stream, up to the end of the CHLO.
+  std::string chlo_data_;
   // State of this TlsChloExtractor.
   State state_;
   // Detail string that can be logged in the presence of unrecoverable errors.
@@ -5,6 +5,8 @@
 #include "quiche/quic/core/tls_chlo_extractor.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "openssl/ssl.h"
 #include "quiche/quic/core/http/quic_spdy_client_session.h"
@@ -17,6 +19,7 @@
 #include "quiche/quic/test_tools/first_flight.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
 #include "quiche/quic/test_tools/simple_session_cache.h"
+#include "quiche/quic/test_tools/tls_chlo_extractor_peer.h"
 
 namespace quic {
 namespace test {
@@ -247,6 +250,135 @@ TEST_P(TlsChloExtractorTest, MoveAssignmentBetweenPackets) {
             TlsChloExtractor::State::kParsedFullMultiPacketChlo);
 }
 
+// Encodes |value| as a big-endian 16-bit integer.
+std::string Uint16(size_t value) {
+  return std::string({static_cast<char>((value >> 8) & 0xff),
+                      static_cast<char>(value & 0xff)});
+}
+
+std::string Extension(uint16_t type, const std::string& data) {
+  return Uint16(type) + Uint16(data.size()) + data;
+}
+
+std::string ServerNameExtension(const std::string& host_name) {
+  std::string server_name_list =
+      std::string(1, '\0') + Uint16(host_name.size()) + host_name;
+  return Extension(0, Uint16(server_name_list.size()) + server_name_list);
+}
+
+std::string AlpnList(const std::vector<std::string>& alpns) {
+  std::string protocol_name_list;
+  for (const std::string& alpn : alpns) {
+    protocol_name_list += std::string(1, static_cast<char>(alpn.size())) + alpn;
+  }
+  return protocol_name_list;
+}
+
+std::string AlpnExtension(const std::vector<std::string>& alpns) {
+  std::string protocol_name_list = AlpnList(alpns);
+  return Extension(16,
+                   Uint16(protocol_name_list.size()) + protocol_name_list);
+}
+
+// Returns the body of a ClientHello carrying |extensions|.
+std::string ClientHello(const std::string& extensions) {
+  return std::string("\x03\x03", 2) + std::string(32, 'r') +
+         std::string(1, '\0') + Uint16(2) + std::string("\x13\x01", 2) +
+         std::string("\x01\x00", 2) + Uint16(extensions.size()) + extensions;
+}
+
+class TlsChloExtractorParseTest : public QuicTest {
+ protected:
+  bool Parse(const std::string& client_hello) {
+    return TlsChloExtractorPeer::ParseClientHello(&extractor_, client_hello);
+  }
+
+  TlsChloExtractor extractor_;
+};
+
+TEST_F(TlsChloExtractorParseTest, ValidClientHello) {
+  EXPECT_TRUE(Parse(ClientHello(ServerNameExtension("example.org") +
+                                AlpnExtension({"h3", "h3-29"}) +
+                                Extension(41, "psk") + Extension(42, ""))));
+  EXPECT_EQ(extractor_.server_name(), "example.org");
+  EXPECT_EQ(extractor_.alpns(), std::vector<std::string>({"h3", "h3-29"}));
+  EXPECT_TRUE(extractor_.resumption_attempted());
+  EXPECT_TRUE(extractor_.early_data_attempted());
+}
+
+TEST_F(TlsChloExtractorParseTest, NoExtensions) {
+  std::string client_hello = ClientHello("");
+  // Drop the empty extensions block entirely.
+  client_hello.resize(client_hello.size() - 2);
+  EXPECT_TRUE(Parse(client_hello));
+  EXPECT_TRUE(extractor_.server_name().empty());
+  EXPECT_TRUE(extractor_.alpns().empty());
+}
+
+TEST_F(TlsChloExtractorParseTest, TruncatedInput) {
+  const std::string client_hello = ClientHello(
+      ServerNameExtension("example.org") + AlpnExtension({"h3"}));
+  // Stopping right after the compression methods is a valid ClientHello with
+  // no extensions.
+  const size_t no_extensions_length = ClientHello("").size() - 2;
+  for (size_t length = 0; length < client_hello.size(); ++length) {
+    if (length == no_extensions_length) {
+      continue;
+    }
+    TlsChloExtractor extractor;
+    EXPECT_FALSE(TlsChloExtractorPeer::ParseClientHello(
+        &extractor, absl::string_view(client_hello.data(), length)))
+        << length;
+  }
+}
+
+TEST_F(TlsChloExtractorParseTest, OversizedLengths) {
+  // Extension data length runs past the end of the extensions block.
+  EXPECT_FALSE(Parse(ClientHello(Uint16(0) + Uint16(100) + "short")));
+  // Extensions block length runs past the end of the ClientHello.
+  std::string client_hello = ClientHello(AlpnExtension({"h3"}));
+  client_hello.resize(client_hello.size() - 1);
+  EXPECT_FALSE(Parse(client_hello));
+  // Trailing data after the extensions block.
+  EXPECT_FALSE(Parse(ClientHello(AlpnExtension({"h3"})) + "x"));
+  // Host name longer than the server_name_list.
+  EXPECT_FALSE(Parse(ClientHello(
+      Extension(0, Uint16(6) + std::string(1, '\0') + Uint16(10) + "abc"))));
+  // Protocol name longer than the protocol_name_list.
+  EXPECT_FALSE(Parse(ClientHello(Extension(16, Uint16(3) + "\x05h3"))));
+  // Host name over 255 bytes.
+  EXPECT_FALSE(Parse(ClientHello(ServerNameExtension(std::string(256, 'a')))));
+}
+
+TEST_F(TlsChloExtractorParseTest, DuplicateServerName) {
+  EXPECT_FALSE(Parse(ClientHello(ServerNameExtension("example.org") +
+                                 ServerNameExtension("example.com"))));
+}
+
+TEST_F(TlsChloExtractorParseTest, DuplicateAlpn) {
+  EXPECT_FALSE(Parse(ClientHello(AlpnExtension({"h3"}) +
+                                 ServerNameExtension("example.org") +
+                                 AlpnExtension({"h3-29"}))));
+}
+
+TEST_F(TlsChloExtractorParseTest, DuplicateUnknownExtension) {
+  EXPECT_FALSE(
+      Parse(ClientHello(Extension(0xff00, "") + Extension(0xff00, ""))));
+}
+
+TEST_F(TlsChloExtractorParseTest, MalformedAlpnList) {
+  // Empty protocol_name_list.
+  EXPECT_FALSE(Parse(ClientHello(AlpnExtension({}))));
+  // Empty protocol name.
+  EXPECT_FALSE(Parse(ClientHello(AlpnExtension({"h3", ""}))));
+  // Data after the protocol_name_list.
+  std::string protocol_name_list = AlpnList({"h3"});
+  EXPECT_FALSE(Parse(ClientHello(Extension(
+      16, Uint16(protocol_name_list.size()) + protocol_name_list + "x"))));
+  // Missing protocol_name_list length.
+  EXPECT_FALSE(Parse(ClientHello(Extension(16, "\x01"))));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
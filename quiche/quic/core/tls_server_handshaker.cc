@@ -149,9 +149,8 @@ void TlsServerHandshaker::DecryptCallback::Run(std::vector<uint8_t> plaintext) {
   if (is_async) {
     context_switcher.emplace(handshaker->connection_context());
   }
-  QUIC_TRACESTRING(
-      absl::StrCat("TLS ticket decryption done. len(decrypted_ticket):",
-                   handshaker->decrypted_session_ticket_.size()));
+  QUIC_TRACEEVENT("TLS ticket decryption done. len(decrypted_ticket):$0",
+                  handshaker->decrypted_session_ticket_.size());
 
   // DecryptCallback::Run could be called synchronously. When that happens, we
   // are currently in the middle of a call to AdvanceHandshake.
@@ -604,6 +603,19 @@ void TlsServerHandshaker::FinishHandshake() {
   // without requiring their contents to be retransmitted with 1-RTT keys."
   // It is expected that QuicConnection will discard the key at an
   // appropriate time.
+
+  if (tls_connection_.ssl_config().shed_handshake_config.value_or(false)) {
+    ShedHandshakeState();
+  }
+}
+
+void TlsServerHandshaker::ShedHandshakeState() {
+  // BoringSSL has released the handshake configuration of the SSL object by
+  // now, so no more session tickets will be sealed or opened. The 1-RTT keys
+  // live in the framer, and the resumption state in the SSL_SESSION.
+  decrypted_session_ticket_ = std::vector<uint8_t>();
+  ticket_encryption_key_ = std::string();
+  pre_shared_key_ = std::string();
 }
 
 QuicAsyncStatus TlsServerHandshaker::VerifyCertChain(
@@ -684,8 +696,8 @@ void TlsServerHandshaker::OnComputeSignatureDone(
     context_switcher.emplace(connection_context());
   }
 
-  QUIC_TRACESTRING(absl::StrCat("TLS compute signature done. ok:", ok,
-                                ", len(signature):", signature.size()));
+  QUIC_TRACEEVENT("TLS compute signature done. ok:$0, len(signature):$1", ok,
+                  signature.size());
 
   if (ok) {
     cert_verify_sig_ = std::move(signature);
@@ -963,11 +975,11 @@ void TlsServerHandshaker::OnSelectCertificateDone(
     context_switcher.emplace(connection_context());
   }
 
-  QUIC_TRACESTRING(absl::StrCat(
-      "TLS select certificate done: ok:", ok,
-      ", certs_found:", (chain != nullptr && !chain->certs.empty()),
-      ", len(handshake_hints):", handshake_hints.size(),
-      ", len(ticket_encryption_key):", ticket_encryption_key.size()));
+  QUIC_TRACEEVENT(
+      "TLS select certificate done: ok:$0, certs_found:$1, "
+      "len(handshake_hints):$2, len(ticket_encryption_key):$3",
+      ok, (chain != nullptr && !chain->certs.empty()), handshake_hints.size(),
+      ticket_encryption_key.size());
 
   ticket_encryption_key_ = std::string(ticket_encryption_key);
   select_cert_status_ = QUIC_FAILURE;
@@ -316,6 +316,10 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
     return session()->connection()->context();
   }
 
+  // Called once the handshake is complete if the SSL object sheds its
+  // handshake configuration. Releases the handshake-only state kept here.
+  void ShedHandshakeState();
+
   std::unique_ptr<ProofSourceHandle> proof_source_handle_;
   ProofSource* proof_source_;
 
@@ -741,6 +741,25 @@ TEST_P(TlsServerHandshakerTest, Resumption) {
             GetParam().disable_resumption);
 }
 
+TEST_P(TlsServerHandshakerTest, ResumptionWithShedHandshakeConfig) {
+  SetQuicFlag(FLAGS_quic_shed_tls_server_handshake_config, true);
+  InitializeServer();
+  InitializeFakeClient();
+
+  // Do the first handshake. The server must still issue a usable ticket.
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_FALSE(server_stream()->IsResumption());
+
+  // Now do another handshake
+  InitializeServer();
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_NE(client_stream()->IsResumption(), GetParam().disable_resumption);
+  EXPECT_NE(server_stream()->IsResumption(), GetParam().disable_resumption);
+}
+
 TEST_P(TlsServerHandshakerTest, ResumptionWithAsyncDecryptCallback) {
   // Do the first handshake
   InitializeFakeClient();
@@ -4,6 +4,10 @@
 
 #include "quiche/quic/test_tools/quic_coalesced_packet_peer.h"
 
+#include <cstring>
+
+#include "quiche/quic/platform/api/quic_logging.h"
+
 namespace quic {
 namespace test {
 
@@ -14,9 +18,25 @@ void QuicCoalescedPacketPeer::SetMaxPacketLength(
 }
 
 //  static
-std::string* QuicCoalescedPacketPeer::GetMutableEncryptedBuffer(
-    QuicCoalescedPacket& coalesced_packet, EncryptionLevel encryption_level) {
-  return &coalesced_packet.encrypted_buffers_[encryption_level];
+void QuicCoalescedPacketPeer::ExtendEncryptedPacket(
+    QuicCoalescedPacket& coalesced_packet, EncryptionLevel encryption_level,
+    QuicPacketLength extra_length) {
+  QUICHE_DCHECK_EQ(coalesced_packet.encrypted_buffer_length_,
+                   coalesced_packet.encrypted_offsets_[encryption_level] +
+                       coalesced_packet.encrypted_lengths_[encryption_level]);
+  QUICHE_DCHECK_LE(coalesced_packet.encrypted_buffer_length_ + extra_length,
+                   kMaxOutgoingPacketSize);
+  memset(coalesced_packet.encrypted_buffer_.get() +
+             coalesced_packet.encrypted_buffer_length_,
+         '!', extra_length);
+  coalesced_packet.encrypted_lengths_[encryption_level] += extra_length;
+  coalesced_packet.encrypted_buffer_length_ += extra_length;
+}
+
+//  static
+bool QuicCoalescedPacketPeer::HasEncryptedBuffer(
+    const QuicCoalescedPacket& coalesced_packet) {
+  return coalesced_packet.encrypted_buffer_ != nullptr;
 }
 
 }  // namespace test
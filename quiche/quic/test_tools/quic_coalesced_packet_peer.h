@@ -16,8 +16,14 @@ class QuicCoalescedPacketPeer {
   static void SetMaxPacketLength(QuicCoalescedPacket& coalesced_packet,
                                  QuicPacketLength length);
 
-  static std::string* GetMutableEncryptedBuffer(
-      QuicCoalescedPacket& coalesced_packet, EncryptionLevel encryption_level);
+  // Adds |extra_length| bytes to the end of the encrypted packet of
+  // |encryption_level|, which must be the last one coalesced.
+  static void ExtendEncryptedPacket(QuicCoalescedPacket& coalesced_packet,
+                                    EncryptionLevel encryption_level,
+                                    QuicPacketLength extra_length);
+
+  // Returns whether the buffer for encrypted packets is allocated.
+  static bool HasEncryptedBuffer(const QuicCoalescedPacket& coalesced_packet);
 };
 
 }  // namespace test
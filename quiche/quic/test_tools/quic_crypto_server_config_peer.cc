@@ -14,19 +14,17 @@ namespace test {
 
 quiche::QuicheReferenceCountedPointer<QuicCryptoServerConfig::Config>
 QuicCryptoServerConfigPeer::GetPrimaryConfig() {
-  QuicReaderMutexLock locked(&server_config_->configs_lock_);
-  return quiche::QuicheReferenceCountedPointer<QuicCryptoServerConfig::Config>(
-      server_config_->primary_config_);
+  return server_config_->GetSnapshot()->primary;
 }
 
 quiche::QuicheReferenceCountedPointer<QuicCryptoServerConfig::Config>
 QuicCryptoServerConfigPeer::GetConfig(std::string config_id) {
-  QuicReaderMutexLock locked(&server_config_->configs_lock_);
+  std::shared_ptr<const QuicCryptoServerConfig::ConfigSnapshot> snapshot =
+      server_config_->GetSnapshot();
   if (config_id == "<primary>") {
-    return quiche::QuicheReferenceCountedPointer<
-        QuicCryptoServerConfig::Config>(server_config_->primary_config_);
+    return snapshot->primary;
   } else {
-    return server_config_->GetConfigWithScid(config_id);
+    return QuicCryptoServerConfig::GetConfigWithScid(*snapshot, config_id);
   }
 }
 
@@ -155,10 +155,10 @@ bool QuicSessionPeer::IsStreamAvailable(QuicSession* session, QuicStreamId id) {
   if (VersionHasIetfQuicFrames(session->transport_version())) {
     if (id % QuicUtils::StreamIdDelta(session->transport_version()) < 2) {
       return session->ietf_streamid_manager_.bidirectional_stream_id_manager_
-          .available_streams_.contains(id);
+          .IsSkippedIncomingStream(id);
     }
     return session->ietf_streamid_manager_.unidirectional_stream_id_manager_
-        .available_streams_.contains(id);
+        .IsSkippedIncomingStream(id);
   }
   return session->stream_id_manager_.available_streams_.contains(id);
 }
@@ -0,0 +1,29 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_TLS_CHLO_EXTRACTOR_PEER_H_
+#define QUICHE_QUIC_TEST_TOOLS_TLS_CHLO_EXTRACTOR_PEER_H_
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/tls_chlo_extractor.h"
+
+namespace quic {
+
+namespace test {
+
+class TlsChloExtractorPeer {
+ public:
+  // Parses the body of a ClientHello message, without the handshake message
+  // header.
+  static bool ParseClientHello(TlsChloExtractor* extractor,
+                               absl::string_view client_hello) {
+    return extractor->ParseClientHello(client_hello);
+  }
+};
+
+}  // namespace test
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_TLS_CHLO_EXTRACTOR_PEER_H_
@@ -0,0 +1,146 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/quic_async_server_backend.h"
+
+#include <memory>
+#include <utility>
+
+#include "quiche/quic/core/quic_error_codes.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicAsyncServerBackend::QuicAsyncServerBackend(
+    std::unique_ptr<ResponseFetcher> fetcher, size_t num_threads,
+    WakeUpCallback wake_up)
+    : fetcher_(std::move(fetcher)) {
+  QUICHE_DCHECK_LT(0u, num_threads);
+  SetWakeUpCallback(std::move(wake_up));
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this));
+    workers_.back()->Start();
+  }
+}
+
+QuicAsyncServerBackend::~QuicAsyncServerBackend() {
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    quitting_ = true;
+    for (QuicNotification* idle_worker : idle_workers_) {
+      idle_worker->Notify();
+    }
+    idle_workers_.clear();
+  }
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+bool QuicAsyncServerBackend::InitializeBackend(
+    const std::string& /*backend_url*/) {
+  return true;
+}
+
+bool QuicAsyncServerBackend::IsBackendInitialized() const { return true; }
+
+void QuicAsyncServerBackend::FetchResponseFromBackend(
+    const spdy::Http2HeaderBlock& request_headers,
+    const std::string& request_body,
+    QuicSimpleServerBackend::RequestHandler* request_handler) {
+  auto fetch = std::make_unique<Fetch>();
+  fetch->request_handler = request_handler;
+  fetch->fetch_id = next_fetch_id_++;
+  fetch->request_headers = request_headers.Clone();
+  fetch->request_body = request_body;
+  active_fetch_ids_[request_handler] = fetch->fetch_id;
+
+  QuicWriterMutexLock lock(&mutex_);
+  pending_fetches_.push_back(std::move(fetch));
+  if (!idle_workers_.empty()) {
+    idle_workers_.back()->Notify();
+    idle_workers_.pop_back();
+  }
+}
+
+void QuicAsyncServerBackend::CloseBackendResponseStream(
+    QuicSimpleServerBackend::RequestHandler* request_handler) {
+  if (active_fetch_ids_.erase(request_handler) == 0) {
+    return;
+  }
+  // A fetch already being run by a worker is dropped once it completes.
+  QuicWriterMutexLock lock(&mutex_);
+  pending_fetches_.remove_if(
+      [request_handler](const std::unique_ptr<Fetch>& fetch) {
+        return fetch->request_handler == request_handler;
+      });
+}
+
+void QuicAsyncServerBackend::ProcessCompletedFetches() {
+  std::list<std::unique_ptr<Fetch>> completed_fetches;
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    completed_fetches.swap(completed_fetches_);
+  }
+  for (const std::unique_ptr<Fetch>& fetch : completed_fetches) {
+    auto it = active_fetch_ids_.find(fetch->request_handler);
+    if (it == active_fetch_ids_.end() || it->second != fetch->fetch_id) {
+      QUIC_DVLOG(1) << "Dropping the response of a closed stream.";
+      continue;
+    }
+    active_fetch_ids_.erase(it);
+    if (fetch->response == nullptr) {
+      fetch->request_handler->TerminateStreamWithError(
+          QuicResetStreamError::FromInternal(QUIC_STREAM_INTERNAL_ERROR));
+      continue;
+    }
+    fetch->request_handler->OnResponseBackendComplete(fetch->response.get());
+  }
+}
+
+void QuicAsyncServerBackend::SetWakeUpCallback(WakeUpCallback wake_up) {
+  QuicWriterMutexLock lock(&mutex_);
+  wake_up_ = std::move(wake_up);
+}
+
+void QuicAsyncServerBackend::RunWorker() {
+  // Notified when a fetch is queued while this worker is idle.
+  std::unique_ptr<QuicNotification> fetch_queued;
+  while (true) {
+    std::unique_ptr<Fetch> fetch;
+    {
+      QuicWriterMutexLock lock(&mutex_);
+      // Notifications are sent with |mutex_| held, so the previous one is no
+      // longer in use.
+      fetch_queued.reset();
+      if (quitting_) {
+        return;
+      }
+      if (pending_fetches_.empty()) {
+        fetch_queued = std::make_unique<QuicNotification>();
+        idle_workers_.push_back(fetch_queued.get());
+      } else {
+        fetch = std::move(pending_fetches_.front());
+        pending_fetches_.pop_front();
+      }
+    }
+    if (fetch == nullptr) {
+      fetch_queued->WaitForNotification();
+      continue;
+    }
+
+    fetch->response =
+        fetcher_->FetchResponse(fetch->request_headers, fetch->request_body);
+
+    QuicWriterMutexLock lock(&mutex_);
+    completed_fetches_.push_back(std::move(fetch));
+    // Called with |mutex_| held so that SetWakeUpCallback() can tell when the
+    // previous callback is no longer in use.
+    if (wake_up_) {
+      wake_up_();
+    }
+  }
+}
+
+}  // namespace quic
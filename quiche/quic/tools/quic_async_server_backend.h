@@ -0,0 +1,134 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_ASYNC_SERVER_BACKEND_H_
+#define QUICHE_QUIC_TOOLS_QUIC_ASYNC_SERVER_BACKEND_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+#include "quiche/quic/platform/api/quic_thread.h"
+#include "quiche/quic/tools/quic_backend_response.h"
+#include "quiche/quic/tools/quic_simple_server_backend.h"
+#include "quiche/spdy/core/spdy_header_block.h"
+
+namespace quic {
+
+// A QuicSimpleServerBackend that computes responses on a pool of worker
+// threads, so that slow responses do not stall the event loop that serves all
+// the other streams.
+//
+// Fetches are queued by FetchResponseFromBackend() on the event loop thread
+// and run by the workers. Responses are only ever delivered to request
+// handlers on the event loop thread, and fetches of streams closed in the
+// meantime are dropped.
+//
+// The backend does not deliver responses by itself: its owner must drive
+// ProcessCompletedFetches() from its event loop. When a fetch completes, the
+// worker calls the wake-up callback, which must cause the event loop thread to
+// call ProcessCompletedFetches(). QuicServer::DriveAsyncServerBackend() sets
+// this up for the backend of a QuicServer. Completed fetches hold their
+// responses until it is called.
+class QUIC_EXPORT_PRIVATE QuicAsyncServerBackend
+    : public QuicSimpleServerBackend {
+ public:
+  // Computes responses. Called on worker threads, so implementations must be
+  // thread-safe and must not touch any state of the event loop.
+  class QUIC_EXPORT_PRIVATE ResponseFetcher {
+   public:
+    virtual ~ResponseFetcher() = default;
+
+    // Returns the response to the request, or nullptr to reset the stream.
+    virtual std::unique_ptr<QuicBackendResponse> FetchResponse(
+        const spdy::Http2HeaderBlock& request_headers,
+        absl::string_view request_body) = 0;
+  };
+
+  // Called on a worker thread whenever a fetch completes, with the backend's
+  // lock held. Must be thread-safe and must not call into the backend.
+  using WakeUpCallback = std::function<void()>;
+
+  QuicAsyncServerBackend(std::unique_ptr<ResponseFetcher> fetcher,
+                         size_t num_threads, WakeUpCallback wake_up);
+  QuicAsyncServerBackend(const QuicAsyncServerBackend&) = delete;
+  QuicAsyncServerBackend& operator=(const QuicAsyncServerBackend&) = delete;
+  // Waits for the fetches being run by the workers to complete, and drops
+  // them along with the fetches still queued.
+  ~QuicAsyncServerBackend() override;
+
+  // Delivers the completed fetches to their request handlers. Must be called
+  // by the owner's event loop, on the event loop thread, after the wake-up
+  // callback has run.
+  void ProcessCompletedFetches();
+
+  // Replaces the wake-up callback, which may be empty. Once this returns, the
+  // previous callback is no longer called.
+  void SetWakeUpCallback(WakeUpCallback wake_up);
+
+  // QuicSimpleServerBackend implementation.
+  bool InitializeBackend(const std::string& backend_url) override;
+  bool IsBackendInitialized() const override;
+  void FetchResponseFromBackend(
+      const spdy::Http2HeaderBlock& request_headers,
+      const std::string& request_body,
+      QuicSimpleServerBackend::RequestHandler* request_handler) override;
+  void CloseBackendResponseStream(
+      QuicSimpleServerBackend::RequestHandler* request_handler) override;
+
+ private:
+  struct Fetch {
+    RequestHandler* request_handler;
+    // Distinguishes fetches of request handlers allocated at the same
+    // address.
+    uint64_t fetch_id;
+    spdy::Http2HeaderBlock request_headers;
+    std::string request_body;
+    std::unique_ptr<QuicBackendResponse> response;
+  };
+
+  class Worker : public QuicThread {
+   public:
+    explicit Worker(QuicAsyncServerBackend* backend)
+        : QuicThread("QuicAsyncServerBackendWorker"), backend_(backend) {}
+
+   protected:
+    void Run() override { backend_->RunWorker(); }
+
+   private:
+    QuicAsyncServerBackend* backend_;
+  };
+
+  // Runs queued fetches until the backend is destroyed.
+  void RunWorker();
+
+  std::unique_ptr<ResponseFetcher> fetcher_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  QuicMutex mutex_;
+  WakeUpCallback wake_up_ QUIC_GUARDED_BY(mutex_);
+  std::list<std::unique_ptr<Fetch>> pending_fetches_ QUIC_GUARDED_BY(mutex_);
+  std::list<std::unique_ptr<Fetch>> completed_fetches_ QUIC_GUARDED_BY(mutex_);
+  // Workers waiting for a fetch to be queued. QuicMutex has no condition
+  // variable, so each idle worker waits on its own notification, which is
+  // notified with |mutex_| held and removed from the list.
+  std::vector<QuicNotification*> idle_workers_ QUIC_GUARDED_BY(mutex_);
+  bool quitting_ QUIC_GUARDED_BY(mutex_) = false;
+
+  // Only accessed on the event loop thread.
+  absl::flat_hash_map<RequestHandler*, uint64_t> active_fetch_ids_;
+  uint64_t next_fetch_id_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_ASYNC_SERVER_BACKEND_H_
@@ -0,0 +1,206 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/quic_async_server_backend.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/spdy/core/spdy_header_block.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::StrictMock;
+
+namespace quic {
+namespace test {
+namespace {
+
+// Responds with the request path as the body. Requests for "/slow" block until
+// |unblock_slow| is notified, and requests for "/error" fail.
+class TestResponseFetcher : public QuicAsyncServerBackend::ResponseFetcher {
+ public:
+  TestResponseFetcher(QuicNotification* slow_started,
+                      QuicNotification* unblock_slow)
+      : slow_started_(slow_started), unblock_slow_(unblock_slow) {}
+
+  std::unique_ptr<QuicBackendResponse> FetchResponse(
+      const spdy::Http2HeaderBlock& request_headers,
+      absl::string_view /*request_body*/) override {
+    absl::string_view path = request_headers.find(":path")->second;
+    if (path == "/error") {
+      return nullptr;
+    }
+    if (path == "/slow") {
+      slow_started_->Notify();
+      unblock_slow_->WaitForNotification();
+    }
+    auto response = std::make_unique<QuicBackendResponse>();
+    spdy::Http2HeaderBlock response_headers;
+    response_headers[":status"] = "200";
+    response->set_headers(std::move(response_headers));
+    response->set_body(path);
+    return response;
+  }
+
+ private:
+  QuicNotification* slow_started_;
+  QuicNotification* unblock_slow_;
+};
+
+class MockRequestHandler : public QuicSimpleServerBackend::RequestHandler {
+ public:
+  QuicConnectionId connection_id() const override {
+    return EmptyQuicConnectionId();
+  }
+  QuicStreamId stream_id() const override { return 0; }
+  std::string peer_host() const override { return "127.0.0.1"; }
+  MOCK_METHOD(void, OnResponseBackendComplete,
+              (const QuicBackendResponse* response), (override));
+  MOCK_METHOD(void, SendStreamData, (absl::string_view data, bool close_stream),
+              (override));
+  MOCK_METHOD(void, TerminateStreamWithError, (QuicResetStreamError error),
+              (override));
+  MOCK_METHOD(void, ResumeRequestBody, (), (override));
+};
+
+class QuicAsyncServerBackendTest : public QuicTest {
+ protected:
+  QuicAsyncServerBackendTest()
+      : backend_(std::make_unique<TestResponseFetcher>(&slow_started_,
+                                                       &unblock_slow_),
+                 /*num_threads=*/2, [this]() { OnWakeUp(); }) {}
+
+  ~QuicAsyncServerBackendTest() override {
+    // Let the backend join its workers.
+    if (!unblock_slow_.HasBeenNotified()) {
+      unblock_slow_.Notify();
+    }
+  }
+
+  void Fetch(absl::string_view path, MockRequestHandler* request_handler) {
+    spdy::Http2HeaderBlock request_headers;
+    request_headers[":authority"] = "www.example.com";
+    request_headers[":path"] = path;
+    backend_.FetchResponseFromBackend(request_headers, "", request_handler);
+  }
+
+  // Waits until |wake_ups| fetches have completed in total.
+  void WaitForWakeUps(int wake_ups) {
+    QuicNotification expected_wake_ups_reached;
+    {
+      QuicWriterMutexLock lock(&mutex_);
+      if (wake_ups_ >= wake_ups) {
+        return;
+      }
+      expected_wake_ups_ = wake_ups;
+      expected_wake_ups_reached_ = &expected_wake_ups_reached;
+    }
+    expected_wake_ups_reached.WaitForNotification();
+    // Wait for OnWakeUp() to be done with the notification.
+    QuicWriterMutexLock lock(&mutex_);
+  }
+
+  void OnWakeUp() {
+    QuicWriterMutexLock lock(&mutex_);
+    ++wake_ups_;
+    if (expected_wake_ups_reached_ != nullptr &&
+        wake_ups_ >= expected_wake_ups_) {
+      expected_wake_ups_reached_->Notify();
+      expected_wake_ups_reached_ = nullptr;
+    }
+  }
+
+  QuicNotification slow_started_;
+  QuicNotification unblock_slow_;
+  QuicMutex mutex_;
+  int wake_ups_ QUIC_GUARDED_BY(mutex_) = 0;
+  int expected_wake_ups_ QUIC_GUARDED_BY(mutex_) = 0;
+  QuicNotification* expected_wake_ups_reached_ QUIC_GUARDED_BY(mutex_) =
+      nullptr;
+  QuicAsyncServerBackend backend_;
+};
+
+TEST_F(QuicAsyncServerBackendTest, DeliversResponseOnEventLoop) {
+  StrictMock<MockRequestHandler> request_handler;
+  Fetch("/fast", &request_handler);
+  WaitForWakeUps(1);
+
+  EXPECT_CALL(request_handler, OnResponseBackendComplete(_))
+      .WillOnce(Invoke([](const QuicBackendResponse* response) {
+        EXPECT_EQ("/fast", response->body());
+      }));
+  backend_.ProcessCompletedFetches();
+
+  // Responses are only delivered once.
+  backend_.ProcessCompletedFetches();
+}
+
+TEST_F(QuicAsyncServerBackendTest, SlowFetchDoesNotDelayOtherStreams) {
+  StrictMock<MockRequestHandler> slow_handler;
+  StrictMock<MockRequestHandler> fast_handler;
+  Fetch("/slow", &slow_handler);
+  slow_started_.WaitForNotification();
+  Fetch("/fast", &fast_handler);
+  WaitForWakeUps(1);
+
+  EXPECT_CALL(fast_handler, OnResponseBackendComplete(_));
+  backend_.ProcessCompletedFetches();
+  testing::Mock::VerifyAndClearExpectations(&fast_handler);
+
+  unblock_slow_.Notify();
+  WaitForWakeUps(2);
+  EXPECT_CALL(slow_handler, OnResponseBackendComplete(_))
+      .WillOnce(Invoke([](const QuicBackendResponse* response) {
+        EXPECT_EQ("/slow", response->body());
+      }));
+  backend_.ProcessCompletedFetches();
+}
+
+TEST_F(QuicAsyncServerBackendTest, DropsResponseOfClosedStream) {
+  StrictMock<MockRequestHandler> request_handler;
+  Fetch("/slow", &request_handler);
+  slow_started_.WaitForNotification();
+  backend_.CloseBackendResponseStream(&request_handler);
+
+  unblock_slow_.Notify();
+  WaitForWakeUps(1);
+  backend_.ProcessCompletedFetches();
+}
+
+TEST_F(QuicAsyncServerBackendTest, DropsResponseOfReplacedFetch) {
+  StrictMock<MockRequestHandler> request_handler;
+  Fetch("/slow", &request_handler);
+  slow_started_.WaitForNotification();
+  // A new fetch of a request handler at the same address.
+  backend_.CloseBackendResponseStream(&request_handler);
+  Fetch("/fast", &request_handler);
+  WaitForWakeUps(1);
+
+  unblock_slow_.Notify();
+  WaitForWakeUps(2);
+  EXPECT_CALL(request_handler, OnResponseBackendComplete(_))
+      .WillOnce(Invoke([](const QuicBackendResponse* response) {
+        EXPECT_EQ("/fast", response->body());
+      }));
+  backend_.ProcessCompletedFetches();
+}
+
+TEST_F(QuicAsyncServerBackendTest, FailedFetchResetsStream) {
+  StrictMock<MockRequestHandler> request_handler;
+  Fetch("/error", &request_handler);
+  WaitForWakeUps(1);
+
+  EXPECT_CALL(request_handler,
+              TerminateStreamWithError(QuicResetStreamError::FromInternal(
+                  QUIC_STREAM_INTERNAL_ERROR)));
+  backend_.ProcessCompletedFetches();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -6,20 +6,6 @@
 
 namespace quic {
 
-QuicBackendResponse::ServerPushInfo::ServerPushInfo(
-    QuicUrl request_url, spdy::Http2HeaderBlock headers,
-    spdy::SpdyPriority priority, std::string body)
-    : request_url(request_url),
-      headers(std::move(headers)),
-      priority(priority),
-      body(body) {}
-
-QuicBackendResponse::ServerPushInfo::ServerPushInfo(const ServerPushInfo& other)
-    : request_url(other.request_url),
-      headers(other.headers.Clone()),
-      priority(other.priority),
-      body(other.body) {}
-
 QuicBackendResponse::QuicBackendResponse() : response_type_(REGULAR_RESPONSE) {}
 
 QuicBackendResponse::~QuicBackendResponse() = default;
@@ -5,8 +5,15 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 #define QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/string_view.h"
-#include "quiche/quic/tools/quic_url.h"
+#include "absl/types/span.h"
 #include "quiche/spdy/core/spdy_protocol.h"
 
 namespace quic {
@@ -15,18 +22,31 @@ namespace quic {
 // fetched by the QuicSimpleServerBackend
 class QuicBackendResponse {
  public:
-  // A ServerPushInfo contains path of the push request and everything needed in
-  // comprising a response for the push request.
-  // TODO(b/171463363): Remove.
-  struct ServerPushInfo {
-    ServerPushInfo(QuicUrl request_url, spdy::Http2HeaderBlock headers,
-                   spdy::SpdyPriority priority, std::string body);
-    ServerPushInfo(const ServerPushInfo& other);
-
-    QuicUrl request_url;
-    spdy::Http2HeaderBlock headers;
-    spdy::SpdyPriority priority;
-    std::string body;
+  // Provides the body of a response in chunks, so that the whole body does not
+  // have to be held in memory.  An instance is shared by all streams sending
+  // the response, possibly on different threads.
+  class BodySource {
+   public:
+    // Reads the body for a single response from start to end.  A reader may
+    // hold resources, such as an open file, until it is destroyed.
+    class Reader {
+     public:
+      virtual ~Reader() = default;
+
+      // Copies the next destination.size() bytes of the body into
+      // |destination|, which must not extend past the end of the body.
+      // Returns false on failure.
+      virtual bool Read(absl::Span<char> destination) = 0;
+    };
+
+    virtual ~BodySource() = default;
+
+    // Length of the body in bytes.
+    virtual uint64_t length() const = 0;
+
+    // Returns a reader positioned at the start of the body, or nullptr on
+    // failure.
+    virtual std::unique_ptr<Reader> CreateReader() const = 0;
   };
 
   enum SpecialResponseType {
@@ -56,6 +76,16 @@ class QuicBackendResponse {
   const spdy::Http2HeaderBlock& headers() const { return headers_; }
   const spdy::Http2HeaderBlock& trailers() const { return trailers_; }
   const absl::string_view body() const { return absl::string_view(body_); }
+  // QPACK encoding of headers() that only refers to the static table, or empty
+  // if it has not been computed.
+  absl::string_view static_header_encoding() const {
+    return static_header_encoding_;
+  }
+  // If not null, the body is read from this source as it is sent, and body()
+  // is empty.
+  const std::shared_ptr<const BodySource>& body_source() const {
+    return body_source_;
+  }
 
   void AddEarlyHints(const spdy::Http2HeaderBlock& headers) {
     spdy::Http2HeaderBlock hints = headers.Clone();
@@ -76,6 +106,12 @@ class QuicBackendResponse {
   void set_body(absl::string_view body) {
     body_.assign(body.data(), body.size());
   }
+  void set_body_source(std::shared_ptr<const BodySource> body_source) {
+    body_source_ = std::move(body_source);
+  }
+  void set_static_header_encoding(std::string static_header_encoding) {
+    static_header_encoding_ = std::move(static_header_encoding);
+  }
 
  private:
   std::vector<spdy::Http2HeaderBlock> early_hints_;
@@ -83,6 +119,8 @@ class QuicBackendResponse {
   spdy::Http2HeaderBlock headers_;
   spdy::Http2HeaderBlock trailers_;
   std::string body_;
+  std::shared_ptr<const BodySource> body_source_;
+  std::string static_header_encoding_;
 };
 
 }  // namespace quic
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/quic_file_body_source.h"
+
+#include <fstream>
+#include <utility>
+
+#include "absl/types/span.h"
+#include "quiche/quic/platform/api/quic_bug_tracker.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Reads [offset, offset + length) of a file through a stream which is opened
+// once and then read sequentially.
+class QuicFileBodyReader : public QuicBackendResponse::BodySource::Reader {
+ public:
+  QuicFileBodyReader(std::ifstream file, std::string file_name,
+                     uint64_t length)
+      : file_(std::move(file)),
+        file_name_(std::move(file_name)),
+        remaining_(length) {}
+
+  bool Read(absl::Span<char> destination) override {
+    if (destination.size() > remaining_) {
+      QUIC_BUG(quic_file_body_source_read_past_end)
+          << "Read of " << destination.size() << " bytes past the end of a "
+          << "body with " << remaining_ << " bytes left";
+      return false;
+    }
+    file_.read(destination.data(), destination.size());
+    if (!file_) {
+      QUIC_LOG(ERROR) << "Failed to read " << destination.size()
+                      << " bytes from response body file: " << file_name_;
+      return false;
+    }
+    remaining_ -= destination.size();
+    return true;
+  }
+
+ private:
+  std::ifstream file_;
+  const std::string file_name_;
+  uint64_t remaining_;
+};
+
+}  // namespace
+
+QuicFileBodySource::QuicFileBodySource(const std::string& file_name,
+                                       uint64_t offset, uint64_t length)
+    : file_name_(file_name), offset_(offset), length_(length) {}
+
+QuicFileBodySource::~QuicFileBodySource() = default;
+
+std::unique_ptr<QuicBackendResponse::BodySource::Reader>
+QuicFileBodySource::CreateReader() const {
+  std::ifstream file(file_name_, std::ios::binary);
+  if (!file.is_open()) {
+    QUIC_LOG(ERROR) << "Failed to open response body file: " << file_name_;
+    return nullptr;
+  }
+  file.seekg(offset_);
+  if (!file) {
+    QUIC_LOG(ERROR) << "Failed to seek to offset " << offset_
+                    << " of response body file: " << file_name_;
+    return nullptr;
+  }
+  return std::make_unique<QuicFileBodyReader>(std::move(file), file_name_,
+                                              length_);
+}
+
+}  // namespace quic
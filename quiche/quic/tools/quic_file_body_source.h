@@ -0,0 +1,40 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_FILE_BODY_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_FILE_BODY_SOURCE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "quiche/quic/tools/quic_backend_response.h"
+
+namespace quic {
+
+// Reads a response body from the range [offset, offset + length) of a file.
+// Each reader keeps the file open while its response is being sent, so only
+// the chunks being sent are held in memory and a file descriptor is only held
+// by responses in flight.
+class QuicFileBodySource : public QuicBackendResponse::BodySource {
+ public:
+  QuicFileBodySource(const std::string& file_name, uint64_t offset,
+                     uint64_t length);
+  QuicFileBodySource(const QuicFileBodySource&) = delete;
+  QuicFileBodySource& operator=(const QuicFileBodySource&) = delete;
+  ~QuicFileBodySource() override;
+
+  // QuicBackendResponse::BodySource implementation.
+  uint64_t length() const override { return length_; }
+  std::unique_ptr<Reader> CreateReader() const override;
+
+ private:
+  const std::string file_name_;
+  const uint64_t offset_;
+  const uint64_t length_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_FILE_BODY_SOURCE_H_
@@ -4,6 +4,7 @@
 
 #include "quiche/quic/tools/quic_memory_cache_backend.h"
 
+#include <list>
 #include <utility>
 
 #include "absl/strings/match.h"
@@ -11,17 +12,30 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/http/spdy_utils.h"
+#include "quiche/quic/core/qpack/qpack_encoder.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 #include "quiche/quic/platform/api/quic_logging.h"
+#include "quiche/quic/tools/quic_file_body_source.h"
 #include "quiche/quic/tools/web_transport_test_visitors.h"
 #include "quiche/common/platform/api/quiche_file_utils.h"
 #include "quiche/common/quiche_text_utils.h"
 
 using spdy::Http2HeaderBlock;
-using spdy::kV3LowestPriority;
 
 namespace quic {
 
+namespace {
+
+// Returns true if |contents| contains the empty line which ends the headers.
+bool HeadersComplete(absl::string_view contents) {
+  return absl::StartsWith(contents, "\n") ||
+         absl::StartsWith(contents, "\r\n") ||
+         absl::StrContains(contents, "\n\n") ||
+         absl::StrContains(contents, "\n\r\n");
+}
+
+}  // namespace
+
 QuicMemoryCacheBackend::ResourceFile::ResourceFile(const std::string& file_name)
     : file_name_(file_name) {}
 
@@ -37,13 +51,56 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
   }
   file_contents_ = *maybe_file_contents;
 
+  absl::optional<size_t> start = ParseHeaders();
+  if (!start.has_value()) {
+    return;
+  }
+  body_ = absl::string_view(file_contents_.data() + *start,
+                            file_contents_.size() - *start);
+}
+
+void QuicMemoryCacheBackend::ResourceFile::ReadHeaders() {
+  absl::optional<uint64_t> file_size = quiche::GetFileSize(file_name_);
+  if (!file_size.has_value()) {
+    QUIC_LOG(DFATAL) << "Failed to read file for the memory cache backend: "
+                     << file_name_;
+    return;
+  }
+  // Read the file a chunk at a time until the empty line which ends the
+  // headers.
+  static constexpr size_t kChunkSize = 4 * 1024;
+  while (!HeadersComplete(file_contents_)) {
+    absl::optional<std::string> chunk = quiche::ReadFileRange(
+        file_name_, file_contents_.size(), kChunkSize);
+    if (!chunk.has_value()) {
+      QUIC_LOG(DFATAL) << "Failed to read file for the memory cache backend: "
+                       << file_name_;
+      return;
+    }
+    if (chunk->empty()) {
+      break;
+    }
+    file_contents_.append(*chunk);
+  }
+
+  absl::optional<size_t> start = ParseHeaders();
+  if (!start.has_value()) {
+    return;
+  }
+  // Drop the start of the body read along with the headers.
+  file_contents_.resize(*start);
+  body_source_ = std::make_shared<QuicFileBodySource>(file_name_, *start,
+                                                      *file_size - *start);
+}
+
+absl::optional<size_t> QuicMemoryCacheBackend::ResourceFile::ParseHeaders() {
   // First read the headers.
   size_t start = 0;
   while (start < file_contents_.length()) {
     size_t pos = file_contents_.find('\n', start);
     if (pos == std::string::npos) {
       QUIC_LOG(DFATAL) << "Headers invalid or empty, ignoring: " << file_name_;
-      return;
+      return absl::nullopt;
     }
     size_t len = pos - start;
     // Support both dos and unix line endings for convenience.
@@ -62,7 +119,7 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
       if (pos == std::string::npos) {
         QUIC_LOG(DFATAL) << "Headers invalid or empty, ignoring: "
                          << file_name_;
-        return;
+        return absl::nullopt;
       }
       spdy_headers_[":status"] = line.substr(pos + 1, 3);
       continue;
@@ -71,7 +128,7 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
     pos = line.find(": ");
     if (pos == std::string::npos) {
       QUIC_LOG(DFATAL) << "Headers invalid or empty, ignoring: " << file_name_;
-      return;
+      return absl::nullopt;
     }
     spdy_headers_.AppendValueOrAddHeader(
         quiche::QuicheTextUtils::ToLower(line.substr(0, pos)),
@@ -88,9 +145,9 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
     HandleXOriginalUrl();
   }
 
-  // X-Push-URL header is a relatively quick way to support sever push
-  // in the toy server.  A production server should use link=preload
-  // stuff as described in https://w3c.github.io/preload/.
+  // X-Push-URL header is a relatively quick way to list the resources to
+  // preload in the toy server.  They are announced with Link preload headers,
+  // see https://w3c.github.io/preload/.
   it = spdy_headers_.find("x-push-url");
   if (it != spdy_headers_.end()) {
     absl::string_view push_urls = it->second;
@@ -107,8 +164,7 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
     }
   }
 
-  body_ = absl::string_view(file_contents_.data() + start,
-                            file_contents_.size() - start);
+  return start;
 }
 
 void QuicMemoryCacheBackend::ResourceFile::SetHostPathFromBase(
@@ -170,7 +226,6 @@ const QuicBackendResponse* QuicMemoryCacheBackend::GetResponse(
   return it->second.get();
 }
 
-using ServerPushInfo = QuicBackendResponse::ServerPushInfo;
 using SpecialResponseType = QuicBackendResponse::SpecialResponseType;
 
 void QuicMemoryCacheBackend::AddSimpleResponse(absl::string_view host,
@@ -183,13 +238,6 @@ void QuicMemoryCacheBackend::AddSimpleResponse(absl::string_view host,
   AddResponse(host, path, std::move(response_headers), body);
 }
 
-void QuicMemoryCacheBackend::AddSimpleResponseWithServerPushResources(
-    absl::string_view host, absl::string_view path, int response_code,
-    absl::string_view body, std::list<ServerPushInfo> push_resources) {
-  AddSimpleResponse(host, path, response_code, body);
-  MaybeAddServerPushResources(host, path, push_resources);
-}
-
 void QuicMemoryCacheBackend::AddDefaultResponse(QuicBackendResponse* response) {
   QuicWriterMutexLock lock(&response_mutex_);
   default_response_.reset(response);
@@ -201,7 +249,8 @@ void QuicMemoryCacheBackend::AddResponse(absl::string_view host,
                                          absl::string_view response_body) {
   AddResponseImpl(host, path, QuicBackendResponse::REGULAR_RESPONSE,
                   std::move(response_headers), response_body,
-                  Http2HeaderBlock(), std::vector<spdy::Http2HeaderBlock>());
+                  Http2HeaderBlock(), std::vector<spdy::Http2HeaderBlock>(),
+                  /*body_source=*/nullptr);
 }
 
 void QuicMemoryCacheBackend::AddResponse(absl::string_view host,
@@ -212,7 +261,8 @@ void QuicMemoryCacheBackend::AddResponse(absl::string_view host,
   AddResponseImpl(host, path, QuicBackendResponse::REGULAR_RESPONSE,
                   std::move(response_headers), response_body,
                   std::move(response_trailers),
-                  std::vector<spdy::Http2HeaderBlock>());
+                  std::vector<spdy::Http2HeaderBlock>(),
+                  /*body_source=*/nullptr);
 }
 
 void QuicMemoryCacheBackend::AddResponseWithEarlyHints(
@@ -221,14 +271,62 @@ void QuicMemoryCacheBackend::AddResponseWithEarlyHints(
     const std::vector<spdy::Http2HeaderBlock>& early_hints) {
   AddResponseImpl(host, path, QuicBackendResponse::REGULAR_RESPONSE,
                   std::move(response_headers), response_body,
-                  Http2HeaderBlock(), early_hints);
+                  Http2HeaderBlock(), early_hints, /*body_source=*/nullptr);
+}
+
+void QuicMemoryCacheBackend::AddResponseWithBodySource(
+    absl::string_view host, absl::string_view path,
+    Http2HeaderBlock response_headers,
+    std::shared_ptr<const QuicBackendResponse::BodySource> body_source) {
+  AddResponseWithBodySource(host, path, std::move(response_headers),
+                            std::move(body_source), Http2HeaderBlock());
+}
+
+void QuicMemoryCacheBackend::AddResponseWithBodySource(
+    absl::string_view host, absl::string_view path,
+    Http2HeaderBlock response_headers,
+    std::shared_ptr<const QuicBackendResponse::BodySource> body_source,
+    Http2HeaderBlock response_trailers) {
+  AddResponseImpl(host, path, QuicBackendResponse::REGULAR_RESPONSE,
+                  std::move(response_headers), "",
+                  std::move(response_trailers),
+                  std::vector<spdy::Http2HeaderBlock>(),
+                  std::move(body_source));
+}
+
+bool QuicMemoryCacheBackend::AddPreloadResources(
+    absl::string_view host, absl::string_view path,
+    const std::vector<QuicUrl>& preload_urls) {
+  if (preload_urls.empty()) {
+    return true;
+  }
+  std::string link;
+  for (const QuicUrl& url : preload_urls) {
+    if (!link.empty()) {
+      link.append(", ");
+    }
+    absl::StrAppend(&link, "<",
+                    url.host() == host ? url.path() : url.ToString(),
+                    ">; rel=preload");
+  }
+  Http2HeaderBlock early_hints;
+  early_hints["link"] = link;
+
+  QuicWriterMutexLock lock(&response_mutex_);
+  auto it = responses_.find(GetKey(host, path));
+  if (it == responses_.end()) {
+    return false;
+  }
+  it->second->AddEarlyHints(early_hints);
+  return true;
 }
 
 void QuicMemoryCacheBackend::AddSpecialResponse(
     absl::string_view host, absl::string_view path,
     SpecialResponseType response_type) {
   AddResponseImpl(host, path, response_type, Http2HeaderBlock(), "",
-                  Http2HeaderBlock(), std::vector<spdy::Http2HeaderBlock>());
+                  Http2HeaderBlock(), std::vector<spdy::Http2HeaderBlock>(),
+                  /*body_source=*/nullptr);
 }
 
 void QuicMemoryCacheBackend::AddSpecialResponse(
@@ -237,7 +335,8 @@ void QuicMemoryCacheBackend::AddSpecialResponse(
     SpecialResponseType response_type) {
   AddResponseImpl(host, path, response_type, std::move(response_headers),
                   response_body, Http2HeaderBlock(),
-                  std::vector<spdy::Http2HeaderBlock>());
+                  std::vector<spdy::Http2HeaderBlock>(),
+                  /*body_source=*/nullptr);
 }
 
 QuicMemoryCacheBackend::QuicMemoryCacheBackend() : cache_initialized_(false) {}
@@ -275,16 +374,26 @@ bool QuicMemoryCacheBackend::InitializeBackend(
     }
 
     resource_file->SetHostPathFromBase(base);
-    resource_file->Read();
-
-    AddResponse(resource_file->host(), resource_file->path(),
-                resource_file->spdy_headers().Clone(), resource_file->body());
+    if (enable_file_backed_bodies_) {
+      resource_file->ReadHeaders();
+      AddResponseWithBodySource(resource_file->host(), resource_file->path(),
+                                resource_file->spdy_headers().Clone(),
+                                resource_file->body_source());
+    } else {
+      resource_file->Read();
+      AddResponse(resource_file->host(), resource_file->path(),
+                  resource_file->spdy_headers().Clone(),
+                  resource_file->body());
+    }
 
     resource_files.push_back(std::move(resource_file));
   }
 
   for (const auto& resource_file : resource_files) {
-    std::list<ServerPushInfo> push_resources;
+    if (resource_file->push_urls().empty()) {
+      continue;
+    }
+    std::vector<QuicUrl> preload_urls;
     for (const auto& push_url : resource_file->push_urls()) {
       QuicUrl url(push_url);
       const QuicBackendResponse* response = GetResponse(url.host(), url.path());
@@ -293,12 +402,10 @@ bool QuicMemoryCacheBackend::InitializeBackend(
             << "Push URL '" << push_url << "' not found.";
         return false;
       }
-      push_resources.push_back(ServerPushInfo(url, response->headers().Clone(),
-                                              kV3LowestPriority,
-                                              (std::string(response->body()))));
+      preload_urls.push_back(url);
     }
-    MaybeAddServerPushResources(resource_file->host(), resource_file->path(),
-                                push_resources);
+    AddPreloadResources(resource_file->host(), resource_file->path(),
+                        preload_urls);
   }
 
   cache_initialized_ = true;
@@ -320,6 +427,10 @@ void QuicMemoryCacheBackend::EnableWebTransport() {
   enable_webtransport_ = true;
 }
 
+void QuicMemoryCacheBackend::EnableFileBackedBodies() {
+  enable_file_backed_bodies_ = true;
+}
+
 bool QuicMemoryCacheBackend::IsBackendInitialized() const {
   return cache_initialized_;
 }
@@ -353,20 +464,6 @@ void QuicMemoryCacheBackend::FetchResponseFromBackend(
 void QuicMemoryCacheBackend::CloseBackendResponseStream(
     QuicSimpleServerBackend::RequestHandler* /*quic_stream*/) {}
 
-std::list<ServerPushInfo> QuicMemoryCacheBackend::GetServerPushResources(
-    std::string request_url) {
-  QuicWriterMutexLock lock(&response_mutex_);
-
-  std::list<ServerPushInfo> resources;
-  auto resource_range = server_push_resources_.equal_range(request_url);
-  for (auto it = resource_range.first; it != resource_range.second; ++it) {
-    resources.push_back(it->second);
-  }
-  QUIC_DVLOG(1) << "Found " << resources.size() << " push resources for "
-                << request_url;
-  return resources;
-}
-
 QuicMemoryCacheBackend::WebTransportResponse
 QuicMemoryCacheBackend::ProcessWebTransportRequest(
     const spdy::Http2HeaderBlock& request_headers,
@@ -407,7 +504,8 @@ void QuicMemoryCacheBackend::AddResponseImpl(
     absl::string_view host, absl::string_view path,
     SpecialResponseType response_type, Http2HeaderBlock response_headers,
     absl::string_view response_body, Http2HeaderBlock response_trailers,
-    const std::vector<spdy::Http2HeaderBlock>& early_hints) {
+    const std::vector<spdy::Http2HeaderBlock>& early_hints,
+    std::shared_ptr<const QuicBackendResponse::BodySource> body_source) {
   QuicWriterMutexLock lock(&response_mutex_);
 
   QUICHE_DCHECK(!host.empty())
@@ -421,7 +519,14 @@ void QuicMemoryCacheBackend::AddResponseImpl(
   auto new_response = std::make_unique<QuicBackendResponse>();
   new_response->set_response_type(response_type);
   new_response->set_headers(std::move(response_headers));
+  if (response_type == QuicBackendResponse::REGULAR_RESPONSE) {
+    // Encoded once here, so that connections that do not use the QPACK dynamic
+    // table do not encode the same headers for every request.
+    new_response->set_static_header_encoding(
+        QpackEncoder::EncodeHeaderListWithStaticTable(new_response->headers()));
+  }
   new_response->set_body(response_body);
+  new_response->set_body_source(std::move(body_source));
   new_response->set_trailers(std::move(response_trailers));
   for (auto& headers : early_hints) {
     new_response->AddEarlyHints(headers);
@@ -439,58 +544,4 @@ std::string QuicMemoryCacheBackend::GetKey(absl::string_view host,
   return host_string + std::string(path);
 }
 
-void QuicMemoryCacheBackend::MaybeAddServerPushResources(
-    absl::string_view request_host, absl::string_view request_path,
-    std::list<ServerPushInfo> push_resources) {
-  std::string request_url = GetKey(request_host, request_path);
-
-  for (const auto& push_resource : push_resources) {
-    if (PushResourceExistsInCache(request_url, push_resource)) {
-      continue;
-    }
-
-    QUIC_DVLOG(1) << "Add request-resource association: request url "
-                  << request_url << " push url "
-                  << push_resource.request_url.ToString()
-                  << " response headers "
-                  << push_resource.headers.DebugString();
-    {
-      QuicWriterMutexLock lock(&response_mutex_);
-      server_push_resources_.insert(std::make_pair(request_url, push_resource));
-    }
-    std::string host = push_resource.request_url.host();
-    if (host.empty()) {
-      host = std::string(request_host);
-    }
-    std::string path = push_resource.request_url.path();
-    bool found_existing_response = false;
-    {
-      QuicWriterMutexLock lock(&response_mutex_);
-      found_existing_response = responses_.contains(GetKey(host, path));
-    }
-    if (!found_existing_response) {
-      // Add a server push response to responses map, if it is not in the map.
-      absl::string_view body = push_resource.body;
-      QUIC_DVLOG(1) << "Add response for push resource: host " << host
-                    << " path " << path;
-      AddResponse(host, path, push_resource.headers.Clone(), body);
-    }
-  }
-}
-
-bool QuicMemoryCacheBackend::PushResourceExistsInCache(
-    std::string original_request_url, ServerPushInfo resource) {
-  QuicWriterMutexLock lock(&response_mutex_);
-  auto resource_range =
-      server_push_resources_.equal_range(original_request_url);
-  for (auto it = resource_range.first; it != resource_range.second; ++it) {
-    ServerPushInfo push_resource = it->second;
-    if (push_resource.request_url.ToString() ==
-        resource.request_url.ToString()) {
-      return true;
-    }
-  }
-  return false;
-}
-
 }  // namespace quic
@@ -5,13 +5,13 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_MEMORY_CACHE_BACKEND_H_
 #define QUICHE_QUIC_TOOLS_QUIC_MEMORY_CACHE_BACKEND_H_
 
-#include <list>
-#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "quiche/quic/core/http/spdy_utils.h"
 #include "quiche/quic/platform/api/quic_mutex.h"
 #include "quiche/quic/tools/quic_backend_response.h"
@@ -24,12 +24,15 @@ namespace quic {
 // In-memory cache for HTTP responses.
 // Reads from disk cache generated by:
 // `wget -p --save_headers <url>`
+//
+// Resources listed in the X-Push-Url header of a cached response are announced
+// with a 103 Early Hints response carrying Link preload headers.
 class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
  public:
   // Class to manage loading a resource file into memory.  There are
   // two uses: called by InitializeBackend to load resources
   // from files, and recursively called when said resources specify
-  // server push associations.
+  // preload associations.
   class ResourceFile {
    public:
     explicit ResourceFile(const std::string& file_name);
@@ -39,6 +42,10 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
     void Read();
 
+    // Same as Read(), but only reads the headers into memory.  The body is
+    // provided by body_source(), which reads it from the file as it is sent.
+    void ReadHeaders();
+
     // |base| is |file_name_| with |cache_directory| prefix stripped.
     void SetHostPathFromBase(absl::string_view base);
 
@@ -52,15 +59,24 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
     absl::string_view body() { return body_; }
 
+    const std::shared_ptr<const QuicBackendResponse::BodySource>&
+    body_source() {
+      return body_source_;
+    }
+
     const std::vector<absl::string_view>& push_urls() { return push_urls_; }
 
    private:
+    // Parses the headers at the start of |file_contents_|.  Returns the offset
+    // of the body, or absl::nullopt if the headers are invalid.
+    absl::optional<size_t> ParseHeaders();
     void HandleXOriginalUrl();
     absl::string_view RemoveScheme(absl::string_view url);
 
     std::string file_name_;
     std::string file_contents_;
     absl::string_view body_;
+    std::shared_ptr<const QuicBackendResponse::BodySource> body_source_;
     spdy::Http2HeaderBlock spdy_headers_;
     absl::string_view x_original_url_;
     std::vector<absl::string_view> push_urls_;
@@ -83,16 +99,6 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
   void AddSimpleResponse(absl::string_view host, absl::string_view path,
                          int response_code, absl::string_view body);
 
-  // Add a simple response to the cache as AddSimpleResponse() does, and add
-  // some server push resources(resource path, corresponding response status and
-  // path) associated with it.
-  // Push resource implicitly come from the same host.
-  // TODO(b/171463363): Remove.
-  void AddSimpleResponseWithServerPushResources(
-      absl::string_view host, absl::string_view path, int response_code,
-      absl::string_view body,
-      std::list<QuicBackendResponse::ServerPushInfo> push_resources);
-
   // Add a response to the cache.
   void AddResponse(absl::string_view host, absl::string_view path,
                    spdy::Http2HeaderBlock response_headers,
@@ -104,12 +110,34 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
                    absl::string_view response_body,
                    spdy::Http2HeaderBlock response_trailers);
 
+  // Add a response whose body is read from |body_source| as it is sent, rather
+  // than held in memory.
+  void AddResponseWithBodySource(
+      absl::string_view host, absl::string_view path,
+      spdy::Http2HeaderBlock response_headers,
+      std::shared_ptr<const QuicBackendResponse::BodySource> body_source);
+
+  // Same as above, with trailers sent after the body.
+  void AddResponseWithBodySource(
+      absl::string_view host, absl::string_view path,
+      spdy::Http2HeaderBlock response_headers,
+      std::shared_ptr<const QuicBackendResponse::BodySource> body_source,
+      spdy::Http2HeaderBlock response_trailers);
+
   // Add a response, with 103 Early Hints, to the cache.
   void AddResponseWithEarlyHints(
       absl::string_view host, absl::string_view path,
       spdy::Http2HeaderBlock response_headers, absl::string_view response_body,
       const std::vector<spdy::Http2HeaderBlock>& early_hints);
 
+  // Adds a 103 Early Hints response with a Link header preloading
+  // |preload_urls| to the cached response for |host| and |path|. The header
+  // block is built once and sent as is with every response. URLs on |host| are
+  // linked by path. Returns false if there is no such cached response. Does
+  // nothing if |preload_urls| is empty.
+  bool AddPreloadResources(absl::string_view host, absl::string_view path,
+                           const std::vector<QuicUrl>& preload_urls);
+
   // Simulate a special behavior at a particular path.
   void AddSpecialResponse(
       absl::string_view host, absl::string_view path,
@@ -130,10 +158,9 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
   void EnableWebTransport();
 
-  // Find all the server push resources associated with |request_url|.
-  // TODO(b/171463363): Remove.
-  std::list<QuicBackendResponse::ServerPushInfo> GetServerPushResources(
-      std::string request_url);
+  // Once called, InitializeBackend() only keeps the headers of the cache files
+  // in memory, and response bodies are read from the files as they are sent.
+  void EnableFileBackedBodies();
 
   // Implements the functions for interface QuicSimpleServerBackend
   // |cache_cirectory| can be generated using `wget -p --save-headers <url>`.
@@ -156,23 +183,12 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
                        spdy::Http2HeaderBlock response_headers,
                        absl::string_view response_body,
                        spdy::Http2HeaderBlock response_trailers,
-                       const std::vector<spdy::Http2HeaderBlock>& early_hints);
+                       const std::vector<spdy::Http2HeaderBlock>& early_hints,
+                       std::shared_ptr<const QuicBackendResponse::BodySource>
+                           body_source);
 
   std::string GetKey(absl::string_view host, absl::string_view path) const;
 
-  // Add some server push urls with given responses for specified
-  // request if these push resources are not associated with this request yet.
-  // TODO(b/171463363): Remove.
-  void MaybeAddServerPushResources(
-      absl::string_view request_host, absl::string_view request_path,
-      std::list<QuicBackendResponse::ServerPushInfo> push_resources);
-
-  // Check if push resource(push_host/push_path) associated with given request
-  // url already exists in server push map.
-  // TODO(b/171463363): Remove.
-  bool PushResourceExistsInCache(std::string original_request_url,
-                                 QuicBackendResponse::ServerPushInfo resource);
-
   // Cached responses.
   absl::flat_hash_map<std::string, std::unique_ptr<QuicBackendResponse>>
       responses_ QUIC_GUARDED_BY(response_mutex_);
@@ -185,17 +201,14 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
   std::unique_ptr<QuicBackendResponse> generate_bytes_response_
       QUIC_GUARDED_BY(response_mutex_);
 
-  // A map from request URL to associated server push responses (if any).
-  // TODO(b/171463363): Remove.
-  std::multimap<std::string, QuicBackendResponse::ServerPushInfo>
-      server_push_resources_ QUIC_GUARDED_BY(response_mutex_);
-
   // Protects against concurrent access from test threads setting responses, and
   // server threads accessing those responses.
   mutable QuicMutex response_mutex_;
   bool cache_initialized_;
 
   bool enable_webtransport_ = false;
+
+  bool enable_file_backed_bodies_ = false;
 };
 
 }  // namespace quic
@@ -4,10 +4,16 @@
 
 #include "quiche/quic/tools/quic_memory_cache_backend.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/qpack/qpack_encoder.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/tools/quic_backend_response.h"
 #include "quiche/common/platform/api/quiche_file_utils.h"
@@ -18,7 +24,6 @@ namespace test {
 
 namespace {
 using Response = QuicBackendResponse;
-using ServerPushInfo = QuicBackendResponse::ServerPushInfo;
 }  // namespace
 
 class QuicMemoryCacheBackendTest : public QuicTest {
@@ -55,6 +60,21 @@ TEST_F(QuicMemoryCacheBackendTest, AddSimpleResponseGetResponse) {
   EXPECT_EQ(response_body.size(), response->body().length());
 }
 
+TEST_F(QuicMemoryCacheBackendTest, PrecomputesStaticHeaderEncoding) {
+  cache_.AddSimpleResponse("www.google.com", "/", 200, "hello response");
+  cache_.AddSpecialResponse("www.google.com", "/close",
+                            QuicBackendResponse::CLOSE_CONNECTION);
+
+  const Response* response = cache_.GetResponse("www.google.com", "/");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(QpackEncoder::EncodeHeaderListWithStaticTable(response->headers()),
+            response->static_header_encoding());
+
+  response = cache_.GetResponse("www.google.com", "/close");
+  ASSERT_TRUE(response);
+  EXPECT_TRUE(response->static_header_encoding().empty());
+}
+
 TEST_F(QuicMemoryCacheBackendTest, AddResponse) {
   const std::string kRequestHost = "www.foo.com";
   const std::string kRequestPath = "/";
@@ -96,6 +116,51 @@ TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDir) {
   EXPECT_LT(0U, response->body().length());
 }
 
+// TODO(crbug.com/1249712) This test is failing on iOS.
+#if defined(OS_IOS)
+#define MAYBE_ReadsCacheDirWithFileBackedBodies \
+  DISABLED_ReadsCacheDirWithFileBackedBodies
+#else
+#define MAYBE_ReadsCacheDirWithFileBackedBodies \
+  ReadsCacheDirWithFileBackedBodies
+#endif
+TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDirWithFileBackedBodies) {
+  QuicMemoryCacheBackend in_memory_cache;
+  in_memory_cache.InitializeBackend(CacheDirectory());
+  const Response* in_memory_response =
+      in_memory_cache.GetResponse("test.example.com", "/index.html");
+  ASSERT_TRUE(in_memory_response);
+
+  cache_.EnableFileBackedBodies();
+  cache_.InitializeBackend(CacheDirectory());
+  const Response* response =
+      cache_.GetResponse("test.example.com", "/index.html");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(in_memory_response->headers(), response->headers());
+  EXPECT_TRUE(response->body().empty());
+  ASSERT_NE(nullptr, response->body_source());
+
+  const absl::string_view expected_body = in_memory_response->body();
+  ASSERT_EQ(expected_body.size(), response->body_source()->length());
+  std::unique_ptr<Response::BodySource::Reader> reader =
+      response->body_source()->CreateReader();
+  ASSERT_NE(nullptr, reader);
+  std::string body(expected_body.size(), '\0');
+  ASSERT_TRUE(reader->Read(absl::MakeSpan(body)));
+  EXPECT_EQ(expected_body, body);
+
+  // Each reader starts at the beginning of the body and reads sequentially.
+  ASSERT_LT(2u, body.size());
+  reader = response->body_source()->CreateReader();
+  ASSERT_NE(nullptr, reader);
+  std::string start(1, '\0');
+  std::string rest(body.size() - 1, '\0');
+  ASSERT_TRUE(reader->Read(absl::MakeSpan(start)));
+  ASSERT_TRUE(reader->Read(absl::MakeSpan(rest)));
+  EXPECT_EQ(expected_body.substr(0, 1), start);
+  EXPECT_EQ(expected_body.substr(1), rest);
+}
+
 // TODO(crbug.com/1249712) This test is failing on iOS.
 #if defined(OS_IOS)
 #define MAYBE_ReadsCacheDirWithServerPushResource \
@@ -106,9 +171,13 @@ TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDir) {
 #endif
 TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDirWithServerPushResource) {
   cache_.InitializeBackend(CacheDirectory() + "_with_push");
-  std::list<ServerPushInfo> resources =
-      cache_.GetServerPushResources("test.example.com/");
-  ASSERT_EQ(1UL, resources.size());
+  const Response* response = cache_.GetResponse("test.example.com", "/");
+  ASSERT_TRUE(response);
+  ASSERT_EQ(1u, response->early_hints().size());
+  auto link = response->early_hints()[0].find("link");
+  ASSERT_NE(response->early_hints()[0].end(), link);
+  std::vector<absl::string_view> preloads = absl::StrSplit(link->second, ", ");
+  EXPECT_EQ(1u, preloads.size());
 }
 
 // TODO(crbug.com/1249712) This test is failing on iOS.
@@ -121,9 +190,14 @@ TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDirWithServerPushResource) {
 #endif
 TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDirWithServerPushResources) {
   cache_.InitializeBackend(CacheDirectory() + "_with_push");
-  std::list<ServerPushInfo> resources =
-      cache_.GetServerPushResources("test.example.com/index2.html");
-  ASSERT_EQ(2UL, resources.size());
+  const Response* response =
+      cache_.GetResponse("test.example.com", "/index2.html");
+  ASSERT_TRUE(response);
+  ASSERT_EQ(1u, response->early_hints().size());
+  auto link = response->early_hints()[0].find("link");
+  ASSERT_NE(response->early_hints()[0].end(), link);
+  std::vector<absl::string_view> preloads = absl::StrSplit(link->second, ", ");
+  EXPECT_EQ(2u, preloads.size());
 }
 
 // TODO(crbug.com/1249712) This test is failing on iOS.
@@ -211,81 +285,38 @@ TEST_F(QuicMemoryCacheBackendTest, DefaultResponse) {
   EXPECT_EQ("200", response->headers().find(":status")->second);
 }
 
-TEST_F(QuicMemoryCacheBackendTest, AddSimpleResponseWithServerPushResources) {
-  std::string request_host = "www.foo.com";
-  std::string response_body("hello response");
-  const size_t kNumResources = 5;
-  int NumResources = 5;
-  std::list<ServerPushInfo> push_resources;
-  std::string scheme = "http";
-  for (int i = 0; i < NumResources; ++i) {
-    std::string path = absl::StrCat("/server_push_src", i);
-    std::string url = scheme + "://" + request_host + path;
-    QuicUrl resource_url(url);
-    std::string body =
-        absl::StrCat("This is server push response body for ", path);
-    spdy::Http2HeaderBlock response_headers;
-    response_headers[":status"] = "200";
-    response_headers["content-length"] = absl::StrCat(body.size());
-    push_resources.push_back(
-        ServerPushInfo(resource_url, response_headers.Clone(), i, body));
-  }
+TEST_F(QuicMemoryCacheBackendTest, AddPreloadResources) {
+  const std::string host = "www.foo.com";
+  cache_.AddSimpleResponse(host, "/", 200, "hello response");
+  std::vector<QuicUrl> preload_urls = {
+      QuicUrl("https://www.foo.com/style.css"),
+      QuicUrl("https://static.foo.com/script.js")};
+  ASSERT_TRUE(cache_.AddPreloadResources(host, "/", preload_urls));
 
-  cache_.AddSimpleResponseWithServerPushResources(
-      request_host, "/", 200, response_body, push_resources);
-
-  std::string request_url = request_host + "/";
-  std::list<ServerPushInfo> resources =
-      cache_.GetServerPushResources(request_url);
-  ASSERT_EQ(kNumResources, resources.size());
-  for (const auto& push_resource : push_resources) {
-    ServerPushInfo resource = resources.front();
-    EXPECT_EQ(resource.request_url.ToString(),
-              push_resource.request_url.ToString());
-    EXPECT_EQ(resource.priority, push_resource.priority);
-    resources.pop_front();
-  }
+  const Response* response = cache_.GetResponse(host, "/");
+  ASSERT_TRUE(response);
+  ASSERT_EQ(1u, response->early_hints().size());
+  const spdy::Http2HeaderBlock& early_hints = response->early_hints()[0];
+  EXPECT_EQ("103", early_hints.find(":status")->second);
+  EXPECT_EQ(
+      "</style.css>; rel=preload, "
+      "<https://static.foo.com/script.js>; rel=preload",
+      early_hints.find("link")->second);
 }
 
-TEST_F(QuicMemoryCacheBackendTest, GetServerPushResourcesAndPushResponses) {
-  std::string request_host = "www.foo.com";
-  std::string response_body("hello response");
-  const size_t kNumResources = 4;
-  int NumResources = 4;
-  std::string scheme = "http";
-  std::string push_response_status[kNumResources] = {"200", "200", "301",
-                                                     "404"};
-  std::list<ServerPushInfo> push_resources;
-  for (int i = 0; i < NumResources; ++i) {
-    std::string path = absl::StrCat("/server_push_src", i);
-    std::string url = scheme + "://" + request_host + path;
-    QuicUrl resource_url(url);
-    std::string body = "This is server push response body for " + path;
-    spdy::Http2HeaderBlock response_headers;
-    response_headers[":status"] = push_response_status[i];
-    response_headers["content-length"] = absl::StrCat(body.size());
-    push_resources.push_back(
-        ServerPushInfo(resource_url, response_headers.Clone(), i, body));
-  }
-  cache_.AddSimpleResponseWithServerPushResources(
-      request_host, "/", 200, response_body, push_resources);
-  std::string request_url = request_host + "/";
-  std::list<ServerPushInfo> resources =
-      cache_.GetServerPushResources(request_url);
-  ASSERT_EQ(kNumResources, resources.size());
-  int i = 0;
-  for (const auto& push_resource : push_resources) {
-    QuicUrl url = resources.front().request_url;
-    std::string host = url.host();
-    std::string path = url.path();
-    const Response* response = cache_.GetResponse(host, path);
-    ASSERT_TRUE(response);
-    ASSERT_TRUE(response->headers().contains(":status"));
-    EXPECT_EQ(push_response_status[i++],
-              response->headers().find(":status")->second);
-    EXPECT_EQ(push_resource.body, response->body());
-    resources.pop_front();
-  }
+TEST_F(QuicMemoryCacheBackendTest, AddPreloadResourcesWithoutUrls) {
+  const std::string host = "www.foo.com";
+  cache_.AddSimpleResponse(host, "/", 200, "hello response");
+  ASSERT_TRUE(cache_.AddPreloadResources(host, "/", {}));
+
+  const Response* response = cache_.GetResponse(host, "/");
+  ASSERT_TRUE(response);
+  EXPECT_TRUE(response->early_hints().empty());
+}
+
+TEST_F(QuicMemoryCacheBackendTest, AddPreloadResourcesToMissingResponse) {
+  EXPECT_FALSE(cache_.AddPreloadResources(
+      "www.foo.com", "/", {QuicUrl("https://www.foo.com/style.css")}));
 }
 
 }  // namespace test
@@ -9,7 +9,9 @@
 #include <netinet/in.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #include <cstdint>
 #include <memory>
@@ -28,6 +30,7 @@
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/platform/api/quic_flags.h"
 #include "quiche/quic/platform/api/quic_logging.h"
+#include "quiche/quic/tools/quic_async_server_backend.h"
 #include "quiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
 #include "quiche/quic/tools/quic_simple_dispatcher.h"
 #include "quiche/quic/tools/quic_simple_server_backend.h"
@@ -43,6 +46,70 @@ const char kSourceAddressTokenSecret[] = "secret";
 
 const size_t kNumSessionsToCreatePerSocketEvent = 16;
 
+// Registers an eventfd with the epoll server, which the workers of the backend
+// write to when a fetch completes, and delivers the completed fetches once the
+// event loop reads it.
+class QuicServer::AsyncServerBackendWaker : public QuicEpollCallbackInterface {
+ public:
+  AsyncServerBackendWaker(QuicEpollServer* epoll_server,
+                          QuicAsyncServerBackend* backend)
+      : epoll_server_(epoll_server),
+        backend_(backend),
+        fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (fd_ < 0) {
+      QUIC_LOG(ERROR) << "eventfd() failed: " << strerror(errno);
+      return;
+    }
+    epoll_server_->RegisterFD(fd_, this, EPOLLIN);
+    int fd = fd_;
+    backend_->SetWakeUpCallback([fd]() {
+      uint64_t value = 1;
+      // Only fails if the counter is about to overflow, in which case the
+      // event loop is due to wake up anyway.
+      (void)write(fd, &value, sizeof(value));
+    });
+  }
+  AsyncServerBackendWaker(const AsyncServerBackendWaker&) = delete;
+  AsyncServerBackendWaker& operator=(const AsyncServerBackendWaker&) = delete;
+
+  ~AsyncServerBackendWaker() override {
+    if (fd_ < 0) {
+      return;
+    }
+    backend_->SetWakeUpCallback(nullptr);
+    if (registered_) {
+      epoll_server_->UnregisterFD(fd_);
+    }
+    close(fd_);
+  }
+
+  std::string Name() const override { return "AsyncServerBackendWaker"; }
+
+  void OnRegistration(QuicEpollServer* /*eps*/, int /*fd*/,
+                      int /*event_mask*/) override {
+    registered_ = true;
+  }
+  void OnModification(int /*fd*/, int /*event_mask*/) override {}
+  void OnEvent(int fd, QuicEpollEvent* /*event*/) override {
+    uint64_t value;
+    // Resets the counter.
+    (void)read(fd, &value, sizeof(value));
+    backend_->ProcessCompletedFetches();
+  }
+  void OnUnregistration(int /*fd*/, bool /*replaced*/) override {
+    registered_ = false;
+  }
+  void OnShutdown(QuicEpollServer* /*eps*/, int /*fd*/) override {
+    registered_ = false;
+  }
+
+ private:
+  QuicEpollServer* epoll_server_;
+  QuicAsyncServerBackend* backend_;
+  int fd_;
+  bool registered_ = false;
+};
+
 QuicServer::QuicServer(std::unique_ptr<ProofSource> proof_source,
                        QuicSimpleServerBackend* quic_simple_server_backend)
     : QuicServer(std::move(proof_source), quic_simple_server_backend,
@@ -97,6 +164,14 @@ void QuicServer::Initialize() {
 
   epoll_server_.set_timeout_in_us(50 * 1000);
 
+  const int32_t long_header_packets_per_read =
+      GetQuicFlag(FLAGS_quic_server_long_header_packets_per_read);
+  if (long_header_packets_per_read > 0) {
+    packet_reader_->set_prioritize_short_header_packets(true);
+    packet_reader_->set_max_long_header_packets_per_read(
+        long_header_packets_per_read);
+  }
+
   QuicEpollClock clock(&epoll_server_);
 
   std::unique_ptr<CryptoHandshakeMessage> scfg(crypto_config_.AddDefaultConfig(
@@ -182,6 +257,15 @@ void QuicServer::Shutdown() {
   fd_ = -1;
 }
 
+void QuicServer::DriveAsyncServerBackend(QuicAsyncServerBackend* backend) {
+  QUICHE_DCHECK_EQ(static_cast<QuicSimpleServerBackend*>(backend),
+                   quic_simple_server_backend_);
+  // The previous waker clears the wake-up callback of the backend.
+  async_server_backend_waker_.reset();
+  async_server_backend_waker_ =
+      std::make_unique<AsyncServerBackendWaker>(&epoll_server_, backend);
+}
+
 void QuicServer::OnEvent(int fd, QuicEpollEvent* event) {
   QUICHE_DCHECK_EQ(fd, fd_);
   event->out_ready_mask = 0;
@@ -189,14 +273,24 @@ void QuicServer::OnEvent(int fd, QuicEpollEvent* event) {
   if (event->in_events & EPOLLIN) {
     QUIC_DVLOG(1) << "EPOLLIN";
 
+    // Packets which arrived during the previous iteration of the event loop
+    // waited up to its busy time to be read. |packets_dropped_| was updated
+    // by the previous read.
+    QuicEpollClock clock(&epoll_server_);
+    dispatcher_->overload_controller()->OnEventLoopSample(
+        clock.ApproximateNow(),
+        QuicTime::Delta::FromMicroseconds(epoll_server_.LastBusyTimeInUsec()),
+        packets_dropped_);
+
     dispatcher_->ProcessBufferedChlos(kNumSessionsToCreatePerSocketEvent);
 
     bool more_to_read = true;
     while (more_to_read) {
       more_to_read = packet_reader_->ReadAndDispatchPackets(
-          fd_, port_, QuicEpollClock(&epoll_server_), dispatcher_.get(),
+          fd_, port_, clock, dispatcher_.get(),
           overflow_supported_ ? &packets_dropped_ : nullptr);
     }
+    dispatcher_->OnReadEventComplete();
 
     if (dispatcher_->HasChlosBuffered()) {
       // Register EPOLLIN event to consume buffered CHLO(s).
@@ -32,6 +32,7 @@ namespace test {
 class QuicServerPeer;
 }  // namespace test
 
+class QuicAsyncServerBackend;
 class QuicDispatcher;
 class QuicPacketReader;
 
@@ -67,6 +68,10 @@ class QuicServer : public QuicSpdyServerBase,
   // Server deletion is imminent.  Start cleaning up the epoll server.
   virtual void Shutdown();
 
+  // Delivers the responses completed by |backend|, which must be the backend
+  // of this server, from the event loop of this server.
+  void DriveAsyncServerBackend(QuicAsyncServerBackend* backend);
+
   // From EpollCallbackInterface
   void OnRegistration(QuicEpollServer* /*eps*/, int /*fd*/,
                       int /*event_mask*/) override {}
@@ -117,6 +122,8 @@ class QuicServer : public QuicSpdyServerBase,
  private:
   friend class quic::test::QuicServerPeer;
 
+  class AsyncServerBackendWaker;
+
   // Initialize the internal state of the server.
   void Initialize();
 
@@ -125,6 +132,10 @@ class QuicServer : public QuicSpdyServerBase,
   // Frames incoming packets and hands them to the dispatcher.
   QuicEpollServer epoll_server_;
 
+  // Wakes up |epoll_server_| when an asynchronous backend completes a fetch.
+  // Destroyed before |epoll_server_|.
+  std::unique_ptr<AsyncServerBackendWaker> async_server_backend_waker_;
+
   // The port the server is listening on.
   int port_;
 
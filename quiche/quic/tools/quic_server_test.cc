@@ -17,6 +17,7 @@
 #include "quiche/quic/test_tools/crypto_test_utils.h"
 #include "quiche/quic/test_tools/mock_quic_dispatcher.h"
 #include "quiche/quic/test_tools/quic_server_peer.h"
+#include "quiche/quic/tools/quic_async_server_backend.h"
 #include "quiche/quic/tools/quic_memory_cache_backend.h"
 #include "quiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
 
@@ -140,6 +141,115 @@ TEST_F(QuicServerEpollInTest, ProcessBufferedCHLOsOnEpollin) {
   }
 }
 
+// Tests that packets dropped by the kernel because the server fell behind are
+// fed to the overload controller, which then escalates.
+TEST_F(QuicServerEpollInTest, KernelDropsEscalateOverload) {
+  StartListening();
+  if (!server_.overflow_supported()) {
+    return;
+  }
+  MockQuicSimpleDispatcher* dispatcher_ = server_.mock_dispatcher();
+  QUICHE_DCHECK(dispatcher_ != nullptr);
+  EXPECT_CALL(*dispatcher_, OnCanWrite()).Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher_, ProcessBufferedChlos(_))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher_, HasPendingWrites()).Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher_, HasChlosBuffered())
+      .WillRepeatedly(testing::Return(false));
+  QuicOverloadController* overload_controller =
+      dispatcher_->overload_controller();
+  overload_controller->set_kernel_drops_threshold(1);
+
+  int fd = socket(
+      AddressFamilyUnderTest() == IpAddressFamily::IP_V4 ? AF_INET : AF_INET6,
+      SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  ASSERT_LT(0, fd);
+  char buf[1024];
+  memset(buf, 0, ABSL_ARRAYSIZE(buf));
+  sockaddr_storage storage = server_address_.generic_address();
+  auto send_packets = [&](int num_packets) {
+    for (int i = 0; i < num_packets; ++i) {
+      sendto(fd, buf, ABSL_ARRAYSIZE(buf), 0,
+             reinterpret_cast<sockaddr*>(&storage), sizeof(storage));
+    }
+  };
+
+  // Overflow the small receive buffer before the server gets to read.
+  send_packets(100);
+  server_.WaitForEvents();
+  EXPECT_EQ(QuicOverloadController::kNotOverloaded,
+            overload_controller->level());
+
+  // The drops counted by the previous read are sampled on the next event.
+  send_packets(1);
+  server_.WaitForEvents();
+  EXPECT_LE(QuicOverloadController::kRejectNewConnections,
+            overload_controller->level());
+  EXPECT_LT(0u, overload_controller->stats().level_changes);
+  close(fd);
+}
+
+// Responds with an empty 200 response.
+class TestResponseFetcher : public QuicAsyncServerBackend::ResponseFetcher {
+ public:
+  std::unique_ptr<QuicBackendResponse> FetchResponse(
+      const spdy::Http2HeaderBlock& /*request_headers*/,
+      absl::string_view /*request_body*/) override {
+    auto response = std::make_unique<QuicBackendResponse>();
+    spdy::Http2HeaderBlock response_headers;
+    response_headers[":status"] = "200";
+    response->set_headers(std::move(response_headers));
+    return response;
+  }
+};
+
+class MockRequestHandler : public QuicSimpleServerBackend::RequestHandler {
+ public:
+  QuicConnectionId connection_id() const override {
+    return EmptyQuicConnectionId();
+  }
+  QuicStreamId stream_id() const override { return 0; }
+  std::string peer_host() const override { return "127.0.0.1"; }
+  MOCK_METHOD(void, OnResponseBackendComplete,
+              (const QuicBackendResponse* response), (override));
+  MOCK_METHOD(void, SendStreamData, (absl::string_view data, bool close_stream),
+              (override));
+  MOCK_METHOD(void, TerminateStreamWithError, (QuicResetStreamError error),
+              (override));
+  MOCK_METHOD(void, ResumeRequestBody, (), (override));
+};
+
+class QuicServerAsyncBackendTest : public QuicTest {
+ public:
+  QuicServerAsyncBackendTest()
+      : backend_(std::make_unique<TestResponseFetcher>(), /*num_threads=*/1,
+                 /*wake_up=*/nullptr),
+        server_(crypto_test_utils::ProofSourceForTesting(), &backend_) {}
+
+ protected:
+  QuicAsyncServerBackend backend_;
+  QuicServer server_;
+};
+
+// Tests that responses completed by the workers of an asynchronous backend are
+// delivered by the event loop of the server.
+TEST_F(QuicServerAsyncBackendTest, DeliversResponsesOnEventLoop) {
+  server_.DriveAsyncServerBackend(&backend_);
+
+  testing::StrictMock<MockRequestHandler> request_handler;
+  bool response_delivered = false;
+  EXPECT_CALL(request_handler, OnResponseBackendComplete(_))
+      .WillOnce(testing::Assign(&response_delivered, true));
+  spdy::Http2HeaderBlock request_headers;
+  request_headers[":authority"] = "www.example.com";
+  request_headers[":path"] = "/";
+  backend_.FetchResponseFromBackend(request_headers, "", &request_handler);
+
+  while (!response_delivered) {
+    server_.WaitForEvents();
+  }
+}
+
 class QuicServerDispatchPacketTest : public QuicTest {
  public:
   QuicServerDispatchPacketTest()
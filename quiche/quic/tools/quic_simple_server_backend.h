@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_BACKEND_H_
 #define QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_BACKEND_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -45,6 +46,9 @@ class QuicSimpleServerBackend {
     virtual void SendStreamData(absl::string_view data, bool close_stream) = 0;
     // Abruptly terminates (resets) the request stream with `error`.
     virtual void TerminateStreamWithError(QuicResetStreamError error) = 0;
+    // Offers the request body data not yet consumed by `HandleRequestBody()`
+    // to the backend again. Only used for streaming request bodies.
+    virtual void ResumeRequestBody() = 0;
   };
 
   struct WebTransportResponse {
@@ -65,7 +69,8 @@ class QuicSimpleServerBackend {
   // If the response has to be fetched over the network, the function
   // asynchronously calls `request_handler` with the HTTP response.
   //
-  // Not called for requests using the CONNECT method.
+  // Not called for requests using the CONNECT method, nor if
+  // `SupportsStreamingRequestBody()` returns true.
   virtual void FetchResponseFromBackend(
       const spdy::Http2HeaderBlock& request_headers,
       const std::string& request_body, RequestHandler* request_handler) = 0;
@@ -98,6 +103,30 @@ class QuicSimpleServerBackend {
         QuicResetStreamError::FromInternal(QUIC_STREAM_CONNECT_ERROR));
   }
 
+  // Returns true if requests not using the CONNECT method should be handed to
+  // the backend as they are received, through `HandleRequestHeaders()`,
+  // `HandleRequestBody()` and `HandleRequestComplete()`, instead of being
+  // buffered in full and passed to `FetchResponseFromBackend()`.
+  virtual bool SupportsStreamingRequestBody() const { return false; }
+  // Handles the headers of a request with a streaming body. Called immediately
+  // on receiving the headers, before any of the body is received.
+  virtual void HandleRequestHeaders(
+      const spdy::Http2HeaderBlock& /*request_headers*/,
+      RequestHandler* /*request_handler*/) {}
+  // Handles the next chunk of a streaming request body, and returns the number
+  // of bytes of `data` consumed. Unconsumed bytes are not acknowledged to the
+  // flow controller, so the peer eventually stops sending. They are offered
+  // again, possibly along with more data, when more data arrives or when the
+  // backend calls `request_handler->ResumeRequestBody()`.
+  virtual size_t HandleRequestBody(absl::string_view data,
+                                   RequestHandler* /*request_handler*/) {
+    return data.size();
+  }
+  // Called once the whole body of a request with a streaming body has been
+  // consumed. The response should be sent, potentially asynchronously, using
+  // `request_handler`.
+  virtual void HandleRequestComplete(RequestHandler* /*request_handler*/) {}
+
   // Clears the state of the backend  instance
   virtual void CloseBackendResponseStream(RequestHandler* request_handler) = 0;
 
@@ -166,18 +166,6 @@ class MockQuicSimpleServerSession : public QuicSimpleServerSession {
             config, CurrentSupportedVersions(), connection, visitor, helper,
             crypto_config, compressed_certs_cache, quic_simple_server_backend) {
   }
-  // Methods taking non-copyable types like Http2HeaderBlock by value cannot be
-  // mocked directly.
-  void WritePushPromise(QuicStreamId original_stream_id,
-                        QuicStreamId promised_stream_id,
-                        spdy::Http2HeaderBlock headers) override {
-    return WritePushPromiseMock(original_stream_id, promised_stream_id,
-                                headers);
-  }
-  MOCK_METHOD(void, WritePushPromiseMock,
-              (QuicStreamId original_stream_id, QuicStreamId promised_stream_id,
-               const spdy::Http2HeaderBlock& headers),
-              ());
 
   MOCK_METHOD(void, SendBlocked, (QuicStreamId), (override));
   MOCK_METHOD(bool, WriteControlFrame,
@@ -6,12 +6,14 @@
 
 #include <cstdint>
 #include <list>
+#include <string>
 #include <utility>
 
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/http/quic_spdy_stream.h"
 #include "quiche/quic/core/http/spdy_utils.h"
 #include "quiche/quic/core/http/web_transport_http3.h"
@@ -93,6 +95,21 @@ void QuicSimpleServerStream::OnInitialHeadersComplete(
 
     quic_simple_server_backend_->HandleConnectHeaders(request_headers_,
                                                       /*request_handler=*/this);
+    return;
+  }
+
+  if (!response_sent_ && !IsConnectRequest() &&
+      quic_simple_server_backend_ != nullptr &&
+      quic_simple_server_backend_->SupportsStreamingRequestBody()) {
+    if (!request_headers_.contains(":authority") ||
+        !request_headers_.contains(":path")) {
+      QUIC_DVLOG(1) << "Request headers do not contain :authority or :path.";
+      SendErrorResponse();
+      return;
+    }
+    streaming_request_body_ = true;
+    quic_simple_server_backend_->HandleRequestHeaders(request_headers_,
+                                                      /*request_handler=*/this);
   }
 }
 
@@ -103,6 +120,11 @@ void QuicSimpleServerStream::OnTrailingHeadersComplete(
 }
 
 void QuicSimpleServerStream::OnBodyAvailable() {
+  if (streaming_request_body_) {
+    OnStreamingRequestBodyAvailable();
+    return;
+  }
+
   while (HasBytesToRead()) {
     struct iovec iov;
     if (GetReadableRegions(&iov, 1) == 0) {
@@ -146,23 +168,65 @@ void QuicSimpleServerStream::OnBodyAvailable() {
   }
 }
 
-void QuicSimpleServerStream::PushResponse(
-    Http2HeaderBlock push_request_headers) {
-  if (QuicUtils::IsClientInitiatedStreamId(session()->transport_version(),
-                                           id())) {
-    QUIC_BUG(quic_bug_10962_2)
-        << "Client initiated stream shouldn't be used as promised stream.";
+void QuicSimpleServerStream::OnStreamingRequestBodyAvailable() {
+  QUICHE_DCHECK(streaming_request_body_);
+
+  while (HasBytesToRead()) {
+    struct iovec iov;
+    if (GetReadableRegions(&iov, 1) == 0) {
+      // No more data to read.
+      break;
+    }
+    if (content_length_ >= 0 &&
+        request_body_bytes_consumed_ + iov.iov_len >
+            static_cast<uint64_t>(content_length_)) {
+      QUIC_DVLOG(1) << "Body size ("
+                    << request_body_bytes_consumed_ + iov.iov_len
+                    << ") > content length (" << content_length_ << ").";
+      SendErrorResponse();
+      return;
+    }
+    const size_t consumed = quic_simple_server_backend_->HandleRequestBody(
+        absl::string_view(static_cast<char*>(iov.iov_base), iov.iov_len),
+        /*request_handler=*/this);
+    QUICHE_DCHECK_LE(consumed, iov.iov_len);
+    QUIC_DVLOG(1) << "Stream " << id() << " passed " << consumed << " of "
+                  << iov.iov_len << " bytes to the backend.";
+    if (reading_stopped()) {
+      // The backend has stopped the request, e.g. with an error response.
+      return;
+    }
+    request_body_bytes_consumed_ += consumed;
+    MarkConsumed(consumed);
+    if (consumed < iov.iov_len) {
+      // The rest of the data stays in the sequencer, and is not credited to
+      // the flow control window, until the backend resumes reading.
+      return;
+    }
+  }
+
+  if (!sequencer()->IsClosed()) {
+    sequencer()->SetUnblocked();
+    return;
+  }
+
+  // If the sequencer is closed, then all the body, including the fin, has been
+  // consumed.
+  OnFinRead();
+
+  if (write_side_closed() || fin_buffered()) {
     return;
   }
-  // Change the stream state to emulate a client request.
-  request_headers_ = std::move(push_request_headers);
-  content_length_ = 0;
-  QUIC_DVLOG(1) << "Stream " << id()
-                << " ready to receive server push response.";
-  QUICHE_DCHECK(reading_stopped());
 
-  // Directly send response based on the emulated request_headers_.
-  SendResponse();
+  if (content_length_ > 0 &&
+      static_cast<uint64_t>(content_length_) != request_body_bytes_consumed_) {
+    QUIC_DVLOG(1) << "Content length (" << content_length_ << ") != body size ("
+                  << request_body_bytes_consumed_ << ").";
+    SendErrorResponse();
+    return;
+  }
+
+  quic_simple_server_backend_->HandleRequestComplete(/*request_handler=*/this);
 }
 
 void QuicSimpleServerStream::HandleRequestConnectData(bool fin_received) {
@@ -287,9 +351,7 @@ void QuicSimpleServerStream::OnResponseBackendComplete(
   }
 
   // Examing response status, if it was not pure integer as typical h2
-  // response status, send error response. Notice that
-  // QuicHttpResponseCache push urls are strictly authority + path only,
-  // scheme is not included (see |QuicHttpResponseCache::GetKey()|).
+  // response status, send error response.
   std::string request_url = request_headers_[":authority"].as_string() +
                             request_headers_[":path"].as_string();
   int response_code;
@@ -308,20 +370,6 @@ void QuicSimpleServerStream::OnResponseBackendComplete(
     return;
   }
 
-  if (QuicUtils::IsServerInitiatedStreamId(session()->transport_version(),
-                                           id())) {
-    // A server initiated stream is only used for a server push response,
-    // and only 200 and 30X response codes are supported for server push.
-    // This behavior mirrors the HTTP/2 implementation.
-    bool is_redirection = response_code / 100 == 3;
-    if (response_code != 200 && !is_redirection) {
-      QUIC_LOG(WARNING) << "Response to server push request " << request_url
-                        << " result in response code " << response_code;
-      Reset(QUIC_STREAM_CANCELLED);
-      return;
-    }
-  }
-
   if (response->response_type() == QuicBackendResponse::INCOMPLETE_RESPONSE) {
     QUIC_DVLOG(1)
         << "Stream " << id()
@@ -350,9 +398,42 @@ void QuicSimpleServerStream::OnResponseBackendComplete(
     return;
   }
 
+  if (response->body_source() != nullptr) {
+    QUIC_DVLOG(1) << "Stream " << id() << " sending response from source.";
+    body_bytes_remaining_ = response->body_source()->length();
+    if (body_bytes_remaining_ > 0) {
+      body_reader_ = response->body_source()->CreateReader();
+      if (body_reader_ == nullptr) {
+        QUIC_LOG(ERROR) << "Stream " << id()
+                        << " failed to open the response body.";
+        SendErrorResponse();
+        return;
+      }
+    }
+    body_trailers_ = response->trailers().Clone();
+    const bool send_fin = body_bytes_remaining_ == 0 && body_trailers_.empty();
+    WriteHeadersWithStaticEncoding(response->headers().Clone(),
+                                   response->static_header_encoding(),
+                                   send_fin, nullptr);
+    QUICHE_DCHECK(!response_sent_);
+    response_sent_ = true;
+    if (send_fin) {
+      return;
+    }
+    if (body_reader_ == nullptr) {
+      WriteTrailers(std::move(body_trailers_), nullptr);
+      return;
+    }
+
+    WriteBodyFromSource();
+
+    return;
+  }
+
   QUIC_DVLOG(1) << "Stream " << id() << " sending response.";
-  SendHeadersAndBodyAndTrailers(response->headers().Clone(), response->body(),
-                                response->trailers().Clone());
+  SendHeadersAndBodyAndTrailers(
+      response->headers().Clone(), response->static_header_encoding(),
+      response->body(), response->trailers().Clone());
 }
 
 void QuicSimpleServerStream::SendStreamData(absl::string_view data,
@@ -369,6 +450,20 @@ void QuicSimpleServerStream::SendStreamData(absl::string_view data,
   }
 }
 
+void QuicSimpleServerStream::ResumeRequestBody() {
+  if (!streaming_request_body_) {
+    QUIC_BUG(quic_simple_server_stream_resume_without_streaming_body)
+        << "Stream " << id() << " does not have a streaming request body.";
+    return;
+  }
+  // Nothing is pending once all the data has been consumed, and the fin, if
+  // any, has already been processed.
+  if (!HasBytesToRead()) {
+    return;
+  }
+  OnStreamingRequestBodyAvailable();
+}
+
 void QuicSimpleServerStream::TerminateStreamWithError(
     QuicResetStreamError error) {
   QUIC_DVLOG(1) << "Stream " << id() << " abruptly terminating with error "
@@ -379,6 +474,7 @@ void QuicSimpleServerStream::TerminateStreamWithError(
 void QuicSimpleServerStream::OnCanWrite() {
   QuicSpdyStream::OnCanWrite();
   WriteGeneratedBytes();
+  WriteBodyFromSource();
 }
 
 void QuicSimpleServerStream::WriteGeneratedBytes() {
@@ -392,6 +488,35 @@ void QuicSimpleServerStream::WriteGeneratedBytes() {
   }
 }
 
+void QuicSimpleServerStream::WriteBodyFromSource() {
+  static constexpr size_t kChunkSize = 16 * 1024;
+  while (body_reader_ != nullptr && !HasBufferedData() &&
+         !write_side_closed()) {
+    std::string data(std::min<uint64_t>(kChunkSize, body_bytes_remaining_),
+                     '\0');
+    if (!body_reader_->Read(absl::MakeSpan(data))) {
+      QUIC_LOG(ERROR) << "Stream " << id()
+                      << " failed to read the response body.";
+      body_reader_ = nullptr;
+      Reset(QUIC_STREAM_INTERNAL_ERROR);
+      return;
+    }
+    body_bytes_remaining_ -= data.size();
+    if (body_bytes_remaining_ > 0) {
+      WriteOrBufferBody(data, /*fin=*/false);
+      continue;
+    }
+    // Close the file before the stream lingers waiting for acks.
+    body_reader_ = nullptr;
+    if (body_trailers_.empty()) {
+      WriteOrBufferBody(data, /*fin=*/true);
+      return;
+    }
+    WriteOrBufferBody(data, /*fin=*/false);
+    WriteTrailers(std::move(body_trailers_), nullptr);
+  }
+}
+
 void QuicSimpleServerStream::SendNotFoundResponse() {
   QUIC_DVLOG(1) << "Stream " << id() << " sending not found response.";
   Http2HeaderBlock headers;
@@ -445,6 +570,15 @@ void QuicSimpleServerStream::SendHeadersAndBody(
 void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
     absl::optional<Http2HeaderBlock> response_headers, absl::string_view body,
     Http2HeaderBlock response_trailers) {
+  SendHeadersAndBodyAndTrailers(std::move(response_headers),
+                                /*static_header_encoding=*/absl::string_view(),
+                                body, std::move(response_trailers));
+}
+
+void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
+    absl::optional<Http2HeaderBlock> response_headers,
+    absl::string_view static_header_encoding, absl::string_view body,
+    Http2HeaderBlock response_trailers) {
   // Headers should be sent iff not sent in a previous response.
   QUICHE_DCHECK_NE(response_headers.has_value(), response_sent_);
 
@@ -454,7 +588,8 @@ void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
     QUIC_DLOG(INFO) << "Stream " << id()
                     << " writing headers (fin = " << send_fin
                     << ") : " << response_headers.value().DebugString();
-    WriteHeaders(std::move(response_headers).value(), send_fin, nullptr);
+    WriteHeadersWithStaticEncoding(std::move(response_headers).value(),
+                                   static_header_encoding, send_fin, nullptr);
     response_sent_ = true;
     if (send_fin) {
       // Nothing else to send.
@@ -6,6 +6,7 @@
 #define QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_STREAM_H_
 
 #include <cstdint>
+#include <memory>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -45,11 +46,6 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
 
   void OnInvalidHeaders() override;
 
-  // Make this stream start from as if it just finished parsing an incoming
-  // request whose headers are equivalent to |push_request_headers|.
-  // Doing so will trigger this toy stream to fetch response and send it back.
-  virtual void PushResponse(spdy::Http2HeaderBlock push_request_headers);
-
   // The response body of error responses.
   static const char* const kErrorResponseBody;
   static const char* const kNotFoundResponseBody;
@@ -61,11 +57,17 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   void OnResponseBackendComplete(const QuicBackendResponse* response) override;
   void SendStreamData(absl::string_view data, bool close_stream) override;
   void TerminateStreamWithError(QuicResetStreamError error) override;
+  void ResumeRequestBody() override;
 
  protected:
   // Handles fresh body data whenever received when method is CONNECT.
   void HandleRequestConnectData(bool fin_received);
 
+  // Passes the available request body data to a backend that supports
+  // streaming request bodies, and completes the request once the fin has been
+  // consumed.
+  void OnStreamingRequestBodyAvailable();
+
   // Sends a response using SendHeaders for the headers and WriteData for the
   // body.
   virtual void SendResponse();
@@ -90,6 +92,13 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   void SendHeadersAndBodyAndTrailers(
       absl::optional<spdy::Http2HeaderBlock> response_headers,
       absl::string_view body, spdy::Http2HeaderBlock response_trailers);
+  // Same as above, but |static_header_encoding| is the QPACK encoding of
+  // |response_headers| that only refers to the static table, see
+  // QuicSpdyStream::WriteHeadersWithStaticEncoding().
+  void SendHeadersAndBodyAndTrailers(
+      absl::optional<spdy::Http2HeaderBlock> response_headers,
+      absl::string_view static_header_encoding, absl::string_view body,
+      spdy::Http2HeaderBlock response_trailers);
 
   spdy::Http2HeaderBlock* request_headers() { return &request_headers_; }
 
@@ -102,6 +111,10 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   // Writes the body bytes for the GENERATE_BYTES response type.
   void WriteGeneratedBytes();
 
+  // Writes the body bytes of a response with a body source, a chunk at a time
+  // as the stream becomes writable.
+  void WriteBodyFromSource();
+
   void set_quic_simple_server_backend_for_test(
       QuicSimpleServerBackend* backend) {
     quic_simple_server_backend_ = backend;
@@ -114,8 +127,20 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
 
  private:
   uint64_t generate_bytes_length_;
+  // Reader of the remainder of a response body served from a body source, if
+  // any, the number of bytes left to read from it, and the trailers to send
+  // after it.
+  std::unique_ptr<QuicBackendResponse::BodySource::Reader> body_reader_;
+  uint64_t body_bytes_remaining_ = 0;
+  spdy::Http2HeaderBlock body_trailers_;
   // Whether response headers have already been sent.
   bool response_sent_ = false;
+  // Whether the request body is passed to the backend as it is received
+  // rather than buffered in |body_|.
+  bool streaming_request_body_ = false;
+  // Number of request body bytes consumed by the backend, if
+  // |streaming_request_body_|.
+  uint64_t request_body_bytes_consumed_ = 0;
 
   QuicSimpleServerBackend* quic_simple_server_backend_;  // Not owned.
 };
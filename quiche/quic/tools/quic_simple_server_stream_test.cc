@@ -10,6 +10,7 @@
 
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "quiche/quic/core/crypto/null_encrypter.h"
@@ -24,6 +25,7 @@
 #include "quiche/quic/test_tools/crypto_test_utils.h"
 #include "quiche/quic/test_tools/quic_config_peer.h"
 #include "quiche/quic/test_tools/quic_connection_peer.h"
+#include "quiche/quic/test_tools/quic_flow_controller_peer.h"
 #include "quiche/quic/test_tools/quic_session_peer.h"
 #include "quiche/quic/test_tools/quic_spdy_session_peer.h"
 #include "quiche/quic/test_tools/quic_stream_peer.h"
@@ -37,6 +39,7 @@
 
 using testing::_;
 using testing::AnyNumber;
+using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
 using testing::StrictMock;
@@ -120,6 +123,42 @@ class TestStream : public QuicSimpleServerStream {
 
 namespace {
 
+// Body source that serves |body| and fails every read at or after
+// |fail_from_offset|.
+class TestBodySource : public QuicBackendResponse::BodySource {
+ public:
+  TestBodySource(std::string body, uint64_t fail_from_offset)
+      : body_(std::move(body)), fail_from_offset_(fail_from_offset) {}
+
+  uint64_t length() const override { return body_.size(); }
+  std::unique_ptr<Reader> CreateReader() const override {
+    return std::make_unique<TestReader>(this);
+  }
+
+ private:
+  class TestReader : public Reader {
+   public:
+    explicit TestReader(const TestBodySource* source) : source_(source) {}
+
+    bool Read(absl::Span<char> destination) override {
+      if (offset_ >= source_->fail_from_offset_) {
+        return false;
+      }
+      memcpy(destination.data(), source_->body_.data() + offset_,
+             destination.size());
+      offset_ += destination.size();
+      return true;
+    }
+
+   private:
+    const TestBodySource* source_;
+    uint64_t offset_ = 0;
+  };
+
+  const std::string body_;
+  const uint64_t fail_from_offset_;
+};
+
 class MockQuicSimpleServerSession : public QuicSimpleServerSession {
  public:
   const size_t kMaxStreamsForTest = 100;
@@ -453,44 +492,6 @@ TEST_P(QuicSimpleServerStreamTest, SendResponseWithIllegalResponseStatus2) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
-TEST_P(QuicSimpleServerStreamTest, SendPushResponseWith404Response) {
-  // Create a new promised stream with even id().
-  auto promised_stream = new StrictMock<TestStream>(
-      GetNthServerInitiatedUnidirectionalStreamId(
-          connection_->transport_version(), 3),
-      &session_, WRITE_UNIDIRECTIONAL, &memory_cache_backend_);
-  session_.ActivateStream(absl::WrapUnique(promised_stream));
-
-  // Send a push response with response status 404, which will be regarded as
-  // invalid server push response.
-  spdy::Http2HeaderBlock* request_headers = promised_stream->mutable_headers();
-  (*request_headers)[":path"] = "/bar";
-  (*request_headers)[":authority"] = "www.google.com";
-  (*request_headers)[":method"] = "GET";
-
-  response_headers_[":status"] = "404";
-  response_headers_["content-length"] = "8";
-  std::string body = "NotFound";
-
-  memory_cache_backend_.AddResponse("www.google.com", "/bar",
-                                    std::move(response_headers_), body);
-
-  InSequence s;
-  if (session_.version().UsesHttp3()) {
-    EXPECT_CALL(session_,
-                MaybeSendStopSendingFrame(
-                    promised_stream->id(),
-                    QuicResetStreamError::FromInternal(QUIC_STREAM_CANCELLED)));
-  }
-  EXPECT_CALL(
-      session_,
-      MaybeSendRstStreamFrame(
-          promised_stream->id(),
-          QuicResetStreamError::FromInternal(QUIC_STREAM_CANCELLED), 0));
-
-  promised_stream->DoSendResponse();
-}
-
 TEST_P(QuicSimpleServerStreamTest, SendResponseWithValidHeaders) {
   // Add a request and response with valid headers.
   spdy::Http2HeaderBlock* request_headers = stream_->mutable_headers();
@@ -564,62 +565,127 @@ TEST_P(QuicSimpleServerStreamTest, SendResponseWithEarlyHints) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
-TEST_P(QuicSimpleServerStreamTest, PushResponseOnClientInitiatedStream) {
-  // EXPECT_QUIC_BUG tests are expensive so only run one instance of them.
-  if (GetParam() != AllSupportedVersions()[0]) {
-    return;
+TEST_P(QuicSimpleServerStreamTest, SendResponseFromBodySource) {
+  spdy::Http2HeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/bar";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":method"] = "GET";
+
+  // Two full 16 KiB chunks and a partial one.
+  const size_t kChunkSize = 16 * 1024;
+  std::string body;
+  for (size_t i = 0; i < 2 * kChunkSize + 100; ++i) {
+    body.push_back('a' + i % 26);
   }
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = absl::StrCat(body.size());
+  memory_cache_backend_.AddResponseWithBodySource(
+      "www.google.com", "/bar", std::move(response_headers_),
+      std::make_shared<TestBodySource>(body, body.size()));
+  QuicStreamPeer::SetFinReceived(stream_);
+  // Let the whole body be written at once.
+  QuicStreamPeer::SetSendWindowOffset(stream_, 10 * kChunkSize);
+  QuicFlowControllerPeer::SetSendWindowOffset(session_.flow_controller(),
+                                              10 * kChunkSize);
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke(&session_, &MockQuicSimpleServerSession::ConsumeData));
 
-  // Calling PushResponse() on a client initialted stream is never supposed to
-  // happen.
-  EXPECT_QUIC_BUG(stream_->PushResponse(spdy::Http2HeaderBlock()),
-                  "Client initiated stream"
-                  " shouldn't be used as promised stream.");
+  auto write_body = [this](absl::string_view data, bool fin) {
+    stream_->QuicSimpleServerStream::WriteOrBufferBody(data, fin);
+  };
+  InSequence s;
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  EXPECT_CALL(*stream_,
+              WriteOrBufferBody(Eq(body.substr(0, kChunkSize)), false))
+      .WillOnce(write_body);
+  EXPECT_CALL(*stream_, WriteOrBufferBody(
+                            Eq(body.substr(kChunkSize, kChunkSize)), false))
+      .WillOnce(write_body);
+  EXPECT_CALL(*stream_,
+              WriteOrBufferBody(Eq(body.substr(2 * kChunkSize)), true))
+      .WillOnce(write_body);
+
+  stream_->DoSendResponse();
+  EXPECT_FALSE(QuicStreamPeer::read_side_closed(stream_));
+  EXPECT_TRUE(stream_->write_side_closed());
 }
 
-TEST_P(QuicSimpleServerStreamTest, PushResponseOnServerInitiatedStream) {
-  // Tests that PushResponse() should take the given headers as request headers
-  // and fetch response from cache, and send it out.
-
-  // Create a stream with even stream id and test against this stream.
-  const QuicStreamId kServerInitiatedStreamId =
-      GetNthServerInitiatedUnidirectionalStreamId(
-          connection_->transport_version(), 3);
-  // Create a server initiated stream and pass it to session_.
-  auto server_initiated_stream =
-      new StrictMock<TestStream>(kServerInitiatedStreamId, &session_,
-                                 WRITE_UNIDIRECTIONAL, &memory_cache_backend_);
-  session_.ActivateStream(absl::WrapUnique(server_initiated_stream));
-
-  const std::string kHost = "www.foo.com";
-  const std::string kPath = "/bar";
-  spdy::Http2HeaderBlock headers;
-  headers[":path"] = kPath;
-  headers[":authority"] = kHost;
-  headers[":method"] = "GET";
+TEST_P(QuicSimpleServerStreamTest, SendResponseFromBodySourceWithTrailers) {
+  spdy::Http2HeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/bar";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":method"] = "GET";
 
+  std::string body(100, 'a');
   response_headers_[":status"] = "200";
-  response_headers_["content-length"] = "5";
-  const std::string kBody = "Hello";
-  quiche::QuicheBuffer header = HttpEncoder::SerializeDataFrameHeader(
-      body_.length(), quiche::SimpleBufferAllocator::Get());
-  memory_cache_backend_.AddResponse(kHost, kPath, std::move(response_headers_),
-                                    kBody);
+  response_headers_["content-length"] = absl::StrCat(body.size());
+  spdy::Http2HeaderBlock response_trailers;
+  response_trailers["trailer"] = "value";
+  memory_cache_backend_.AddResponseWithBodySource(
+      "www.google.com", "/bar", std::move(response_headers_),
+      std::make_shared<TestBodySource>(body, body.size()),
+      std::move(response_trailers));
+  QuicStreamPeer::SetFinReceived(stream_);
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke(&session_, &MockQuicSimpleServerSession::ConsumeData));
 
-  // Call PushResponse() should trigger stream to fetch response from cache
-  // and send it back.
+  // The fin is sent with the trailers rather than with the body.
   InSequence s;
-  EXPECT_CALL(*server_initiated_stream, WriteHeadersMock(false));
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  EXPECT_CALL(*stream_, WriteOrBufferBody(Eq(body), false))
+      .WillOnce([this](absl::string_view data, bool fin) {
+        stream_->QuicSimpleServerStream::WriteOrBufferBody(data, fin);
+      });
+
+  stream_->DoSendResponse();
+  EXPECT_TRUE(stream_->fin_sent());
+}
 
+TEST_P(QuicSimpleServerStreamTest, SendResponseFromBodySourceReadFailure) {
+  spdy::Http2HeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/bar";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":method"] = "GET";
+
+  // The second chunk fails to be read.
+  const size_t kChunkSize = 16 * 1024;
+  std::string body(3 * kChunkSize, 'a');
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = absl::StrCat(body.size());
+  memory_cache_backend_.AddResponseWithBodySource(
+      "www.google.com", "/bar", std::move(response_headers_),
+      std::make_shared<TestBodySource>(body, kChunkSize));
+  QuicStreamPeer::SetFinReceived(stream_);
+  QuicStreamPeer::SetSendWindowOffset(stream_, 10 * kChunkSize);
+  QuicFlowControllerPeer::SetSendWindowOffset(session_.flow_controller(),
+                                              10 * kChunkSize);
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke(&session_, &MockQuicSimpleServerSession::ConsumeData));
+
+  InSequence s;
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  EXPECT_CALL(*stream_,
+              WriteOrBufferBody(Eq(body.substr(0, kChunkSize)), false))
+      .WillOnce([this](absl::string_view data, bool fin) {
+        stream_->QuicSimpleServerStream::WriteOrBufferBody(data, fin);
+      });
   if (UsesHttp3()) {
-    EXPECT_CALL(session_, WritevData(kServerInitiatedStreamId, header.size(), _,
-                                     NO_FIN, _, _));
+    EXPECT_CALL(session_,
+                MaybeSendStopSendingFrame(
+                    stream_->id(), QuicResetStreamError::FromInternal(
+                                       QUIC_STREAM_INTERNAL_ERROR)));
   }
   EXPECT_CALL(session_,
-              WritevData(kServerInitiatedStreamId, kBody.size(), _, FIN, _, _));
-  server_initiated_stream->PushResponse(std::move(headers));
-  EXPECT_EQ(kPath, server_initiated_stream->GetHeader(":path"));
-  EXPECT_EQ("GET", server_initiated_stream->GetHeader(":method"));
+              MaybeSendRstStreamFrame(stream_->id(),
+                                      QuicResetStreamError::FromInternal(
+                                          QUIC_STREAM_INTERNAL_ERROR),
+                                      _));
+
+  stream_->DoSendResponse();
+  EXPECT_FALSE(stream_->fin_sent());
 }
 
 TEST_P(QuicSimpleServerStreamTest, TestSendErrorResponse) {
@@ -774,6 +840,19 @@ class TestQuicSimpleServerBackend : public QuicSimpleServerBackend {
       RequestHandler* /*request_handler*/) override {}
 };
 
+// QuicSimpleServerBackend with a streaming request body that implements its
+// behavior through mocking.
+class TestStreamingQuicSimpleServerBackend
+    : public TestQuicSimpleServerBackend {
+ public:
+  bool SupportsStreamingRequestBody() const override { return true; }
+  MOCK_METHOD(void, HandleRequestHeaders,
+              (const spdy::Http2HeaderBlock&, RequestHandler*), (override));
+  MOCK_METHOD(size_t, HandleRequestBody, (absl::string_view, RequestHandler*),
+              (override));
+  MOCK_METHOD(void, HandleRequestComplete, (RequestHandler*), (override));
+};
+
 ACTION_P(SendHeadersResponse, response_ptr) {
   arg1->OnResponseBackendComplete(response_ptr);
 }
@@ -784,6 +863,10 @@ ACTION_P(SendStreamData, data, close_stream) {
 
 ACTION_P(TerminateStream, error) { arg1->TerminateStreamWithError(error); }
 
+ACTION_P(SendCompleteResponse, response_ptr) {
+  arg0->OnResponseBackendComplete(response_ptr);
+}
+
 TEST_P(QuicSimpleServerStreamTest, ConnectSendsIntermediateResponses) {
   auto test_backend = std::make_unique<TestQuicSimpleServerBackend>();
   TestQuicSimpleServerBackend* test_backend_ptr = test_backend.get();
@@ -917,6 +1000,49 @@ TEST_P(QuicSimpleServerStreamTest, BackendCanTerminateStream) {
   stream_->OnStreamHeaderList(/*fin=*/false, kFakeFrameLen, header_list);
 }
 
+TEST_P(QuicSimpleServerStreamTest, StreamingRequestBodyWithBackpressure) {
+  auto test_backend = std::make_unique<TestStreamingQuicSimpleServerBackend>();
+  TestStreamingQuicSimpleServerBackend* test_backend_ptr = test_backend.get();
+  ReplaceBackend(std::move(test_backend));
+
+  QuicBackendResponse response;
+  spdy::Http2HeaderBlock response_headers;
+  response_headers[":status"] = "200";
+  response.set_headers(std::move(response_headers));
+
+  quiche::QuicheBuffer header = HttpEncoder::SerializeDataFrameHeader(
+      body_.length(), quiche::SimpleBufferAllocator::Get());
+  const QuicByteCount header_length = UsesHttp3() ? header.size() : 0;
+
+  // The backend first consumes only part of the body, then the rest once it
+  // resumes reading.
+  InSequence s;
+  EXPECT_CALL(*test_backend_ptr, HandleRequestHeaders(_, _));
+  EXPECT_CALL(*test_backend_ptr, HandleRequestBody(absl::string_view(body_), _))
+      .WillOnce(testing::Return(5));
+  EXPECT_CALL(*test_backend_ptr,
+              HandleRequestBody(absl::string_view(body_).substr(5), _))
+      .WillOnce(testing::Return(body_.length() - 5));
+  EXPECT_CALL(*test_backend_ptr, HandleRequestComplete(_))
+      .WillOnce(SendCompleteResponse(&response));
+  EXPECT_CALL(*stream_, WriteHeadersMock(true));
+
+  stream_->OnStreamHeaderList(/*fin=*/false, kFakeFrameLen, header_list_);
+  std::string data =
+      UsesHttp3() ? absl::StrCat(header.AsStringView(), body_) : body_;
+  stream_->OnStreamFrame(
+      QuicStreamFrame(stream_->id(), /*fin=*/true, /*offset=*/0, data));
+
+  // Unconsumed bytes are not credited to the flow control window.
+  EXPECT_EQ(header_length + 5, QuicStreamPeer::bytes_consumed(stream_));
+  EXPECT_TRUE(StreamBody().empty());
+
+  stream_->ResumeRequestBody();
+  EXPECT_EQ(data.length(), QuicStreamPeer::bytes_consumed(stream_));
+  EXPECT_FALSE(stream_->send_response_was_called());
+  EXPECT_FALSE(stream_->send_error_response_was_called());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
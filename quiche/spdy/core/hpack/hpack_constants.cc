@@ -5,11 +5,13 @@
 #include "quiche/spdy/core/hpack/hpack_constants.h"
 
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <vector>
 
 #include "absl/base/macros.h"
 #include "quiche/common/platform/api/quiche_logging.h"
+#include "quiche/spdy/core/hpack/hpack_static_index.h"
 #include "quiche/spdy/core/hpack/hpack_static_table.h"
 
 namespace spdy {
@@ -291,71 +293,78 @@ const std::vector<HpackHuffmanSymbol>& HpackHuffmanCodeVector() {
 #define STATIC_ENTRY(name, value) \
   { name, ABSL_ARRAYSIZE(name) - 1, value, ABSL_ARRAYSIZE(value) - 1 }
 
+namespace {
+
+constexpr HpackStaticEntry kHpackStaticTable[] = {
+    STATIC_ENTRY(":authority", ""),                    // 1
+    STATIC_ENTRY(":method", "GET"),                    // 2
+    STATIC_ENTRY(":method", "POST"),                   // 3
+    STATIC_ENTRY(":path", "/"),                        // 4
+    STATIC_ENTRY(":path", "/index.html"),              // 5
+    STATIC_ENTRY(":scheme", "http"),                   // 6
+    STATIC_ENTRY(":scheme", "https"),                  // 7
+    STATIC_ENTRY(":status", "200"),                    // 8
+    STATIC_ENTRY(":status", "204"),                    // 9
+    STATIC_ENTRY(":status", "206"),                    // 10
+    STATIC_ENTRY(":status", "304"),                    // 11
+    STATIC_ENTRY(":status", "400"),                    // 12
+    STATIC_ENTRY(":status", "404"),                    // 13
+    STATIC_ENTRY(":status", "500"),                    // 14
+    STATIC_ENTRY("accept-charset", ""),                // 15
+    STATIC_ENTRY("accept-encoding", "gzip, deflate"),  // 16
+    STATIC_ENTRY("accept-language", ""),               // 17
+    STATIC_ENTRY("accept-ranges", ""),                 // 18
+    STATIC_ENTRY("accept", ""),                        // 19
+    STATIC_ENTRY("access-control-allow-origin", ""),   // 20
+    STATIC_ENTRY("age", ""),                           // 21
+    STATIC_ENTRY("allow", ""),                         // 22
+    STATIC_ENTRY("authorization", ""),                 // 23
+    STATIC_ENTRY("cache-control", ""),                 // 24
+    STATIC_ENTRY("content-disposition", ""),           // 25
+    STATIC_ENTRY("content-encoding", ""),              // 26
+    STATIC_ENTRY("content-language", ""),              // 27
+    STATIC_ENTRY("content-length", ""),                // 28
+    STATIC_ENTRY("content-location", ""),              // 29
+    STATIC_ENTRY("content-range", ""),                 // 30
+    STATIC_ENTRY("content-type", ""),                  // 31
+    STATIC_ENTRY("cookie", ""),                        // 32
+    STATIC_ENTRY("date", ""),                          // 33
+    STATIC_ENTRY("etag", ""),                          // 34
+    STATIC_ENTRY("expect", ""),                        // 35
+    STATIC_ENTRY("expires", ""),                       // 36
+    STATIC_ENTRY("from", ""),                          // 37
+    STATIC_ENTRY("host", ""),                          // 38
+    STATIC_ENTRY("if-match", ""),                      // 39
+    STATIC_ENTRY("if-modified-since", ""),             // 40
+    STATIC_ENTRY("if-none-match", ""),                 // 41
+    STATIC_ENTRY("if-range", ""),                      // 42
+    STATIC_ENTRY("if-unmodified-since", ""),           // 43
+    STATIC_ENTRY("last-modified", ""),                 // 44
+    STATIC_ENTRY("link", ""),                          // 45
+    STATIC_ENTRY("location", ""),                      // 46
+    STATIC_ENTRY("max-forwards", ""),                  // 47
+    STATIC_ENTRY("proxy-authenticate", ""),            // 48
+    STATIC_ENTRY("proxy-authorization", ""),           // 49
+    STATIC_ENTRY("range", ""),                         // 50
+    STATIC_ENTRY("referer", ""),                       // 51
+    STATIC_ENTRY("refresh", ""),                       // 52
+    STATIC_ENTRY("retry-after", ""),                   // 53
+    STATIC_ENTRY("server", ""),                        // 54
+    STATIC_ENTRY("set-cookie", ""),                    // 55
+    STATIC_ENTRY("strict-transport-security", ""),     // 56
+    STATIC_ENTRY("transfer-encoding", ""),             // 57
+    STATIC_ENTRY("user-agent", ""),                    // 58
+    STATIC_ENTRY("vary", ""),                          // 59
+    STATIC_ENTRY("via", ""),                           // 60
+    STATIC_ENTRY("www-authenticate", ""),              // 61
+};
+
+}  // namespace
+
 const std::vector<HpackStaticEntry>& HpackStaticTableVector() {
-  static const auto* kHpackStaticTable = new std::vector<HpackStaticEntry>{
-      STATIC_ENTRY(":authority", ""),                    // 1
-      STATIC_ENTRY(":method", "GET"),                    // 2
-      STATIC_ENTRY(":method", "POST"),                   // 3
-      STATIC_ENTRY(":path", "/"),                        // 4
-      STATIC_ENTRY(":path", "/index.html"),              // 5
-      STATIC_ENTRY(":scheme", "http"),                   // 6
-      STATIC_ENTRY(":scheme", "https"),                  // 7
-      STATIC_ENTRY(":status", "200"),                    // 8
-      STATIC_ENTRY(":status", "204"),                    // 9
-      STATIC_ENTRY(":status", "206"),                    // 10
-      STATIC_ENTRY(":status", "304"),                    // 11
-      STATIC_ENTRY(":status", "400"),                    // 12
-      STATIC_ENTRY(":status", "404"),                    // 13
-      STATIC_ENTRY(":status", "500"),                    // 14
-      STATIC_ENTRY("accept-charset", ""),                // 15
-      STATIC_ENTRY("accept-encoding", "gzip, deflate"),  // 16
-      STATIC_ENTRY("accept-language", ""),               // 17
-      STATIC_ENTRY("accept-ranges", ""),                 // 18
-      STATIC_ENTRY("accept", ""),                        // 19
-      STATIC_ENTRY("access-control-allow-origin", ""),   // 20
-      STATIC_ENTRY("age", ""),                           // 21
-      STATIC_ENTRY("allow", ""),                         // 22
-      STATIC_ENTRY("authorization", ""),                 // 23
-      STATIC_ENTRY("cache-control", ""),                 // 24
-      STATIC_ENTRY("content-disposition", ""),           // 25
-      STATIC_ENTRY("content-encoding", ""),              // 26
-      STATIC_ENTRY("content-language", ""),              // 27
-      STATIC_ENTRY("content-length", ""),                // 28
-      STATIC_ENTRY("content-location", ""),              // 29
-      STATIC_ENTRY("content-range", ""),                 // 30
-      STATIC_ENTRY("content-type", ""),                  // 31
-      STATIC_ENTRY("cookie", ""),                        // 32
-      STATIC_ENTRY("date", ""),                          // 33
-      STATIC_ENTRY("etag", ""),                          // 34
-      STATIC_ENTRY("expect", ""),                        // 35
-      STATIC_ENTRY("expires", ""),                       // 36
-      STATIC_ENTRY("from", ""),                          // 37
-      STATIC_ENTRY("host", ""),                          // 38
-      STATIC_ENTRY("if-match", ""),                      // 39
-      STATIC_ENTRY("if-modified-since", ""),             // 40
-      STATIC_ENTRY("if-none-match", ""),                 // 41
-      STATIC_ENTRY("if-range", ""),                      // 42
-      STATIC_ENTRY("if-unmodified-since", ""),           // 43
-      STATIC_ENTRY("last-modified", ""),                 // 44
-      STATIC_ENTRY("link", ""),                          // 45
-      STATIC_ENTRY("location", ""),                      // 46
-      STATIC_ENTRY("max-forwards", ""),                  // 47
-      STATIC_ENTRY("proxy-authenticate", ""),            // 48
-      STATIC_ENTRY("proxy-authorization", ""),           // 49
-      STATIC_ENTRY("range", ""),                         // 50
-      STATIC_ENTRY("referer", ""),                       // 51
-      STATIC_ENTRY("refresh", ""),                       // 52
-      STATIC_ENTRY("retry-after", ""),                   // 53
-      STATIC_ENTRY("server", ""),                        // 54
-      STATIC_ENTRY("set-cookie", ""),                    // 55
-      STATIC_ENTRY("strict-transport-security", ""),     // 56
-      STATIC_ENTRY("transfer-encoding", ""),             // 57
-      STATIC_ENTRY("user-agent", ""),                    // 58
-      STATIC_ENTRY("vary", ""),                          // 59
-      STATIC_ENTRY("via", ""),                           // 60
-      STATIC_ENTRY("www-authenticate", ""),              // 61
-  };
-  return *kHpackStaticTable;
+  static const auto* kStaticTableVector = new std::vector<HpackStaticEntry>(
+      std::begin(kHpackStaticTable), std::end(kHpackStaticTable));
+  return *kStaticTableVector;
 }
 
 #undef STATIC_ENTRY
@@ -371,4 +380,12 @@ const HpackStaticTable& ObtainHpackStaticTable() {
   return *shared_static_table;
 }
 
+const HpackStaticIndex<kStaticTableSize>& ObtainHpackStaticIndex() {
+  static constexpr HpackStaticIndex<kStaticTableSize> kHpackStaticIndex(
+      kHpackStaticTable);
+  static_assert(kHpackStaticIndex.valid(),
+                "Failed to build HPACK static table index.");
+  return kHpackStaticIndex;
+}
+
 }  // namespace spdy
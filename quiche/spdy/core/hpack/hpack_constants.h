@@ -41,6 +41,11 @@ struct QUICHE_EXPORT_PRIVATE HpackStaticEntry {
 };
 
 class HpackStaticTable;
+template <size_t kNumEntries>
+class HpackStaticIndex;
+
+// Number of entries in the HPACK static table.
+constexpr size_t kStaticTableSize = 61;
 
 // RFC 7540, 6.5.2: Initial value for SETTINGS_HEADER_TABLE_SIZE.
 const uint32_t kDefaultHeaderTableSizeSetting = 4096;
@@ -82,6 +87,10 @@ HpackStaticTableVector();
 // threads. This function is thread-safe.
 QUICHE_EXPORT_PRIVATE const HpackStaticTable& ObtainHpackStaticTable();
 
+// Returns the index of the HPACK static table, which is built at compile time.
+QUICHE_EXPORT_PRIVATE const HpackStaticIndex<kStaticTableSize>&
+ObtainHpackStaticIndex();
+
 // RFC 7541, 8.1.2.1: Pseudo-headers start with a colon.
 const char kPseudoHeaderPrefix = ':';
 
@@ -280,6 +280,7 @@ class HpackEncoder::Encoderator : public ProgressiveEncoder {
 
   // Encodes and returns up to max_encoded_bytes of the current header block.
   std::string Next(size_t max_encoded_bytes) override;
+  void Next(size_t max_encoded_bytes, std::string* output) override;
 
  private:
   HpackEncoder* encoder_;
@@ -333,6 +334,13 @@ HpackEncoder::Encoderator::Encoderator(const Representations& representations,
 }
 
 std::string HpackEncoder::Encoderator::Next(size_t max_encoded_bytes) {
+  std::string output;
+  Next(max_encoded_bytes, &output);
+  return output;
+}
+
+void HpackEncoder::Encoderator::Next(size_t max_encoded_bytes,
+                                     std::string* output) {
   QUICHE_BUG_IF(spdy_bug_61_1, !has_next_)
       << "Encoderator::Next called with nothing left to encode.";
   const bool enable_compression = encoder_->enable_compression_;
@@ -358,7 +366,7 @@ std::string HpackEncoder::Encoderator::Next(size_t max_encoded_bytes) {
   }
 
   has_next_ = encoder_->output_stream_.size() > max_encoded_bytes;
-  return encoder_->output_stream_.BoundedTakeString(max_encoded_bytes);
+  encoder_->output_stream_.BoundedTakeString(max_encoded_bytes, output);
 }
 
 std::unique_ptr<HpackEncoder::ProgressiveEncoder> HpackEncoder::EncodeHeaderSet(
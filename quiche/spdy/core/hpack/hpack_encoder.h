@@ -61,6 +61,12 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
 
     // Encodes and returns up to max_encoded_bytes of the current header block.
     virtual std::string Next(size_t max_encoded_bytes) = 0;
+
+    // Same as above, but replaces the contents of |output| instead of
+    // returning a new string, so that callers can reuse its capacity.
+    virtual void Next(size_t max_encoded_bytes, std::string* output) {
+      *output = Next(max_encoded_bytes);
+    }
   };
 
   // Returns a ProgressiveEncoder which must be outlived by both the given
@@ -82,11 +82,13 @@ class HpackEncoderPeer {
     std::unique_ptr<HpackEncoder::ProgressiveEncoder> encoderator =
         encoder->EncodeHeaderSet(header_set);
     http2::test::Http2Random random;
-    std::string output_buffer = encoderator->Next(random.UniformInRange(0, 16));
+    // Reuses a single buffer for the chunks.
+    std::string chunk;
+    encoderator->Next(random.UniformInRange(0, 16), &chunk);
+    std::string output_buffer = chunk;
     while (encoderator->HasNext()) {
-      std::string second_buffer =
-          encoderator->Next(random.UniformInRange(0, 16));
-      output_buffer.append(second_buffer);
+      encoderator->Next(random.UniformInRange(0, 16), &chunk);
+      output_buffer.append(chunk);
     }
     *output = std::move(output_buffer);
     return true;
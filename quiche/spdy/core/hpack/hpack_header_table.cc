@@ -14,8 +14,7 @@ namespace spdy {
 
 HpackHeaderTable::HpackHeaderTable()
     : static_entries_(ObtainHpackStaticTable().GetStaticEntries()),
-      static_index_(ObtainHpackStaticTable().GetStaticIndex()),
-      static_name_index_(ObtainHpackStaticTable().GetStaticNameIndex()),
+      static_index_(ObtainHpackStaticIndex()),
       settings_size_bound_(kDefaultHeaderTableSizeSetting),
       size_(0),
       max_size_(kDefaultHeaderTableSizeSetting),
@@ -25,9 +24,9 @@ HpackHeaderTable::~HpackHeaderTable() = default;
 
 size_t HpackHeaderTable::GetByName(absl::string_view name) {
   {
-    auto it = static_name_index_.find(name);
-    if (it != static_name_index_.end()) {
-      return 1 + it->second;
+    const size_t index = static_index_.GetByName(name);
+    if (index != static_index_.kNotFound) {
+      return 1 + index;
     }
   }
   {
@@ -41,14 +40,14 @@ size_t HpackHeaderTable::GetByName(absl::string_view name) {
 
 size_t HpackHeaderTable::GetByNameAndValue(absl::string_view name,
                                            absl::string_view value) {
-  HpackLookupEntry query{name, value};
   {
-    auto it = static_index_.find(query);
-    if (it != static_index_.end()) {
-      return 1 + it->second;
+    const size_t index = static_index_.GetByNameAndValue(name, value);
+    if (index != static_index_.kNotFound) {
+      return 1 + index;
     }
   }
   {
+    HpackLookupEntry query{name, value};
     auto it = dynamic_index_.find(query);
     if (it != dynamic_index_.end()) {
       return dynamic_table_insertions_ - it->second + kStaticTableSize;
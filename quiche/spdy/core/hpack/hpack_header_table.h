@@ -17,7 +17,9 @@
 #include "absl/strings/string_view.h"
 #include "quiche/common/platform/api/quiche_export.h"
 #include "quiche/common/quiche_circular_deque.h"
+#include "quiche/spdy/core/hpack/hpack_constants.h"
 #include "quiche/spdy/core/hpack/hpack_entry.h"
+#include "quiche/spdy/core/hpack/hpack_static_index.h"
 
 // All section references below are to http://tools.ietf.org/html/rfc7541.
 
@@ -108,22 +110,16 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
   // Evicts |count| oldest entries from the table.
   void Evict(size_t count);
 
-  // |static_entries_|, |static_index_|, and |static_name_index_| are owned by
-  // HpackStaticTable singleton.
+  // |static_entries_| is owned by HpackStaticTable singleton.  |static_index_|
+  // is built at compile time.
 
   // Stores HpackEntries.
   const StaticEntryTable& static_entries_;
   DynamicEntryTable dynamic_entries_;
 
-  // Tracks the index of the unique HpackEntry for a given header name and
-  // value.  Keys consist of string_views that point to strings stored in
-  // |static_entries_|.
-  const NameValueToEntryMap& static_index_;
-
-  // Tracks the index of the first static entry for each name in the static
-  // table.  Each key is a string_view that points to a name string stored in
-  // |static_entries_|.
-  const NameToEntryMap& static_name_index_;
+  // Tracks the index of the unique static entry for a given header name and
+  // value, and of the first static entry for each name.
+  const HpackStaticIndex<kStaticTableSize>& static_index_;
 
   // Tracks the index of the most recently inserted HpackEntry for a given
   // header name and value.  Keys consist of string_views that point to strings
@@ -97,4 +97,16 @@ std::string HpackOutputStream::BoundedTakeString(size_t max_size) {
   }
 }
 
+void HpackOutputStream::BoundedTakeString(size_t max_size,
+                                          std::string* output) {
+  QUICHE_DCHECK_EQ(bit_offset_, 0u);
+  if (buffer_.size() > max_size) {
+    output->assign(buffer_, 0, max_size);
+    buffer_.erase(0, max_size);
+  } else {
+    output->clear();
+    output->swap(buffer_);
+  }
+}
+
 }  // namespace spdy
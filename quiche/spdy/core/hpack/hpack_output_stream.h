@@ -58,6 +58,12 @@ class QUICHE_EXPORT_PRIVATE HpackOutputStream {
   // internal state with the overflow.
   std::string BoundedTakeString(size_t max_size);
 
+  // Replaces the contents of |output| with up to |max_size| bytes of the
+  // internal buffer, and keeps the overflow. Unlike the methods above, this
+  // hands the capacity of |output| back to the internal buffer, so repeated
+  // calls with the same |output| do not allocate.
+  void BoundedTakeString(size_t max_size, std::string* output);
+
   // Size in bytes of stream's internal buffer.
   size_t size() const { return buffer_.size(); }
 
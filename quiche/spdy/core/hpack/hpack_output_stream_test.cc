@@ -266,6 +266,27 @@ TEST(HpackOutputStreamTest, BoundedTakeString) {
   EXPECT_EQ("\x10", str);
 }
 
+TEST(HpackOutputStreamTest, BoundedTakeStringIntoOutput) {
+  HpackOutputStream output_stream;
+  std::string str = "previous contents";
+
+  output_stream.AppendBytes("buffer12");
+  output_stream.AppendBytes("buffer456");
+  output_stream.BoundedTakeString(9, &str);
+  EXPECT_EQ("buffer12b", str);
+  EXPECT_EQ(8u, output_stream.size());
+
+  output_stream.BoundedTakeString(9, &str);
+  EXPECT_EQ("uffer456", str);
+  EXPECT_EQ(0u, output_stream.size());
+
+  // The internal buffer keeps working after swapping with |str|.
+  output_stream.AppendBits(0x7f, 7);
+  output_stream.AppendUint32(0x11);
+  output_stream.BoundedTakeString(9, &str);
+  EXPECT_EQ("\xff\x10", str);
+}
+
 TEST(HpackOutputStreamTest, MutableString) {
   HpackOutputStream output_stream;
 
@@ -0,0 +1,240 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_SPDY_CORE_HPACK_HPACK_STATIC_INDEX_H_
+#define QUICHE_SPDY_CORE_HPACK_HPACK_STATIC_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "absl/strings/string_view.h"
+#include "quiche/spdy/core/hpack/hpack_constants.h"
+
+namespace spdy {
+
+// Perfect hash index over a static table of |kNumEntries| entries, such as the
+// HPACK or the QPACK static table. Instances are meant to be constexpr, so
+// that the index is computed by the compiler and lookups do not require any
+// initialization at runtime. The index keeps a pointer to the table, which
+// must therefore have static storage duration.
+//
+// Each index consists of a table for name and value pairs and one for names.
+// Keys are distributed into buckets, and each bucket is assigned the first
+// seed that hashes all of its keys into unused slots ("hash and displace").
+template <size_t kNumEntries>
+class HpackStaticIndex {
+ public:
+  // Return value of GetByName() and GetByNameAndValue() if no matching entry
+  // is found.
+  static constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+
+  explicit constexpr HpackStaticIndex(
+      const HpackStaticEntry (&entries)[kNumEntries])
+      : entries_(entries) {
+    uint64_t name_value_hashes[kNumEntries] = {};
+    uint64_t name_hashes[kNumEntries] = {};
+    bool all_entries[kNumEntries] = {};
+    bool first_with_name[kNumEntries] = {};
+    for (size_t i = 0; i < kNumEntries; ++i) {
+      const HpackStaticEntry& entry = entries[i];
+      name_value_hashes[i] = HashNameAndValue(entry.name, entry.name_len,
+                                              entry.value, entry.value_len);
+      name_hashes[i] = HashName(entry.name, entry.name_len);
+      all_entries[i] = true;
+      first_with_name[i] = true;
+      for (size_t j = 0; j < i; ++j) {
+        if (Equals(entries[j].name, entries[j].name_len, entry.name,
+                   entry.name_len)) {
+          first_with_name[i] = false;
+          break;
+        }
+      }
+    }
+    valid_ = name_value_table_.Build(name_value_hashes, all_entries) &&
+             name_table_.Build(name_hashes, first_with_name);
+  }
+
+  HpackStaticIndex(const HpackStaticIndex&) = delete;
+  HpackStaticIndex& operator=(const HpackStaticIndex&) = delete;
+
+  // Returns whether a collision-free index could be built. Must be checked
+  // with a static_assert() for every instance.
+  constexpr bool valid() const { return valid_; }
+
+  // Returns the zero-based index of the entry matching |name| and |value|, or
+  // kNotFound.
+  size_t GetByNameAndValue(absl::string_view name,
+                           absl::string_view value) const {
+    const size_t index = name_value_table_.Find(
+        HashNameAndValue(name.data(), name.size(), value.data(), value.size()));
+    if (index == kNotFound ||
+        name != absl::string_view(entries_[index].name,
+                                  entries_[index].name_len) ||
+        value != absl::string_view(entries_[index].value,
+                                   entries_[index].value_len)) {
+      return kNotFound;
+    }
+    return index;
+  }
+
+  // Returns the zero-based index of the first entry matching |name|, or
+  // kNotFound.
+  size_t GetByName(absl::string_view name) const {
+    const size_t index = name_table_.Find(HashName(name.data(), name.size()));
+    if (index == kNotFound ||
+        name != absl::string_view(entries_[index].name,
+                                  entries_[index].name_len)) {
+      return kNotFound;
+    }
+    return index;
+  }
+
+ private:
+  static_assert(kNumEntries > 0 && kNumEntries < 0xff,
+                "Entry indices must fit in a slot.");
+
+  static constexpr size_t SlotCount() {
+    size_t slots = 1;
+    while (slots < 2 * kNumEntries) {
+      slots *= 2;
+    }
+    return slots;
+  }
+
+  // About four slots per bucket, so that a seed is found in a few attempts.
+  static constexpr size_t kNumSlots = SlotCount();
+  static constexpr size_t kNumBuckets = kNumSlots / 4;
+  static constexpr uint8_t kEmptySlot = 0xff;
+  static constexpr uint32_t kMaxSeed = 0xffff;
+
+  static constexpr bool Equals(const char* a, size_t a_len, const char* b,
+                               size_t b_len) {
+    if (a_len != b_len) {
+      return false;
+    }
+    for (size_t i = 0; i < a_len; ++i) {
+      if (a[i] != b[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // 64-bit FNV-1a.
+  static constexpr uint64_t Hash(const char* data, size_t len, uint64_t hash) {
+    for (size_t i = 0; i < len; ++i) {
+      hash ^= static_cast<uint8_t>(data[i]);
+      hash *= 0x100000001b3u;
+    }
+    return hash;
+  }
+
+  // The finalizer of SplitMix64, used to derive the bucket and the slot of a
+  // key from its hash.
+  static constexpr uint64_t Mix(uint64_t hash, uint64_t seed) {
+    uint64_t x = hash + seed * 0x9e3779b97f4a7c15u;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31);
+  }
+
+  static constexpr uint64_t HashName(const char* name, size_t name_len) {
+    return Hash(name, name_len, 0xcbf29ce484222325u);
+  }
+
+  // The name length is mixed in so that moving bytes between the name and the
+  // value changes the hash.
+  static constexpr uint64_t HashNameAndValue(const char* name, size_t name_len,
+                                             const char* value,
+                                             size_t value_len) {
+    return Hash(value, value_len, Mix(HashName(name, name_len), name_len));
+  }
+
+  class Table {
+   public:
+    // Places the keys with |included| set. Returns false if no seed places
+    // all keys of some bucket.
+    constexpr bool Build(const uint64_t (&hashes)[kNumEntries],
+                         const bool (&included)[kNumEntries]) {
+      for (size_t slot = 0; slot < kNumSlots; ++slot) {
+        slots_[slot] = kEmptySlot;
+      }
+      size_t buckets[kNumEntries] = {};
+      size_t bucket_sizes[kNumBuckets] = {};
+      for (size_t i = 0; i < kNumEntries; ++i) {
+        if (included[i]) {
+          buckets[i] = Mix(hashes[i], 0) % kNumBuckets;
+          ++bucket_sizes[buckets[i]];
+        }
+      }
+      // Larger buckets are placed first, while most slots are still unused.
+      for (size_t size = kNumEntries; size > 0; --size) {
+        for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+          if (bucket_sizes[bucket] != size) {
+            continue;
+          }
+          bool placed = false;
+          for (uint32_t seed = 1; seed <= kMaxSeed && !placed; ++seed) {
+            placed = Place(hashes, included, buckets, bucket, seed);
+            if (placed) {
+              seeds_[bucket] = static_cast<uint16_t>(seed);
+            }
+          }
+          if (!placed) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    // Returns the index of the only entry that can match |hash|, or
+    // kNotFound.
+    constexpr size_t Find(uint64_t hash) const {
+      const uint16_t seed = seeds_[Mix(hash, 0) % kNumBuckets];
+      const uint8_t index = slots_[Mix(hash, seed) % kNumSlots];
+      return index == kEmptySlot ? kNotFound : index;
+    }
+
+   private:
+    // Places all included keys of |bucket| using |seed|, or none of them.
+    constexpr bool Place(const uint64_t (&hashes)[kNumEntries],
+                         const bool (&included)[kNumEntries],
+                         const size_t (&buckets)[kNumEntries], size_t bucket,
+                         uint32_t seed) {
+      for (size_t i = 0; i < kNumEntries; ++i) {
+        if (!included[i] || buckets[i] != bucket) {
+          continue;
+        }
+        const size_t slot = Mix(hashes[i], seed) % kNumSlots;
+        if (slots_[slot] != kEmptySlot) {
+          // Undo the placement of the previous keys of this bucket.
+          for (size_t j = 0; j < i; ++j) {
+            const size_t placed_slot = Mix(hashes[j], seed) % kNumSlots;
+            if (included[j] && buckets[j] == bucket &&
+                slots_[placed_slot] == j) {
+              slots_[placed_slot] = kEmptySlot;
+            }
+          }
+          return false;
+        }
+        slots_[slot] = static_cast<uint8_t>(i);
+      }
+      return true;
+    }
+
+    uint16_t seeds_[kNumBuckets] = {};
+    uint8_t slots_[kNumSlots] = {};
+  };
+
+  const HpackStaticEntry* entries_;
+  Table name_value_table_;
+  Table name_table_;
+  bool valid_ = false;
+};
+
+}  // namespace spdy
+
+#endif  // QUICHE_SPDY_CORE_HPACK_HPACK_STATIC_INDEX_H_
@@ -27,20 +27,6 @@ void HpackStaticTable::Initialize(const HpackStaticEntry* static_entry_table,
     std::string value(it->value, it->value_len);
     static_entries_.push_back(HpackEntry(std::move(name), std::move(value)));
   }
-
-  // |static_entries_| will not be mutated any more.  Therefore its entries will
-  // remain stable even if the container does not have iterator stability.
-  int insertion_count = 0;
-  for (const auto& entry : static_entries_) {
-    auto result = static_index_.insert(std::make_pair(
-        HpackLookupEntry{entry.name(), entry.value()}, insertion_count));
-    QUICHE_CHECK(result.second);
-
-    // Multiple static entries may have the same name, so inserts may fail.
-    static_name_index_.insert(std::make_pair(entry.name(), insertion_count));
-
-    ++insertion_count;
-  }
 }
 
 bool HpackStaticTable::IsInitialized() const {
@@ -12,20 +12,18 @@ namespace spdy {
 
 struct HpackStaticEntry;
 
-// Number of entries in the HPACK static table.
-constexpr size_t kStaticTableSize = 61;
-
-// HpackStaticTable provides |static_entries_| and |static_index_| for HPACK
-// encoding and decoding contexts.  Once initialized, an instance is read only
-// and may be accessed only through its const interface.  Such an instance may
-// be shared accross multiple HPACK contexts.
+// HpackStaticTable provides |static_entries_| for HPACK encoding and decoding
+// contexts.  Lookups by name and value use HpackStaticIndex instead.  Once
+// initialized, an instance is read only and may be accessed only through its
+// const interface.  Such an instance may be shared accross multiple HPACK
+// contexts.
 class QUICHE_EXPORT_PRIVATE HpackStaticTable {
  public:
   HpackStaticTable();
   ~HpackStaticTable();
 
-  // Prepares HpackStaticTable by filling up static_entries_ and static_index_
-  // from an array of struct HpackStaticEntry.  Must be called exactly once.
+  // Prepares HpackStaticTable by filling up static_entries_ from an array of
+  // struct HpackStaticEntry.  Must be called exactly once.
   void Initialize(const HpackStaticEntry* static_entry_table,
                   size_t static_entry_count);
 
@@ -36,19 +34,9 @@ class QUICHE_EXPORT_PRIVATE HpackStaticTable {
   const HpackHeaderTable::StaticEntryTable& GetStaticEntries() const {
     return static_entries_;
   }
-  const HpackHeaderTable::NameValueToEntryMap& GetStaticIndex() const {
-    return static_index_;
-  }
-  const HpackHeaderTable::NameToEntryMap& GetStaticNameIndex() const {
-    return static_name_index_;
-  }
 
  private:
   HpackHeaderTable::StaticEntryTable static_entries_;
-  // The following two members have string_views that point to strings stored in
-  // |static_entries_|.
-  HpackHeaderTable::NameValueToEntryMap static_index_;
-  HpackHeaderTable::NameToEntryMap static_name_index_;
 };
 
 }  // namespace spdy
@@ -4,12 +4,12 @@
 
 #include "quiche/spdy/core/hpack/hpack_static_table.h"
 
-#include <set>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "quiche/common/platform/api/quiche_test.h"
 #include "quiche/spdy/core/hpack/hpack_constants.h"
+#include "quiche/spdy/core/hpack/hpack_static_index.h"
 
 namespace spdy {
 
@@ -34,19 +34,6 @@ TEST_F(HpackStaticTableTest, Initialize) {
   const HpackHeaderTable::StaticEntryTable& static_entries =
       table_.GetStaticEntries();
   EXPECT_EQ(kStaticTableSize, static_entries.size());
-
-  const HpackHeaderTable::NameValueToEntryMap& static_index =
-      table_.GetStaticIndex();
-  EXPECT_EQ(kStaticTableSize, static_index.size());
-
-  const HpackHeaderTable::NameToEntryMap& static_name_index =
-      table_.GetStaticNameIndex();
-  // Count distinct names in static table.
-  std::set<absl::string_view> names;
-  for (const auto& entry : static_entries) {
-    names.insert(entry.name());
-  }
-  EXPECT_EQ(names.size(), static_name_index.size());
 }
 
 // Test that ObtainHpackStaticTable returns the same instance every time.
@@ -56,6 +43,29 @@ TEST_F(HpackStaticTableTest, IsSingleton) {
   EXPECT_EQ(static_table_one, static_table_two);
 }
 
+// Check that the index finds every entry of the static table.
+TEST_F(HpackStaticTableTest, StaticIndex) {
+  const HpackStaticIndex<kStaticTableSize>& index = ObtainHpackStaticIndex();
+  const std::vector<HpackStaticEntry>& entries = HpackStaticTableVector();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const absl::string_view name(entries[i].name, entries[i].name_len);
+    const absl::string_view value(entries[i].value, entries[i].value_len);
+    EXPECT_EQ(i, index.GetByNameAndValue(name, value));
+
+    size_t first_with_name = 0;
+    while (absl::string_view(entries[first_with_name].name,
+                             entries[first_with_name].name_len) != name) {
+      ++first_with_name;
+    }
+    EXPECT_EQ(first_with_name, index.GetByName(name));
+  }
+  EXPECT_EQ(1u, index.GetByNameAndValue(":method", "GET"));
+  EXPECT_EQ(index.kNotFound, index.GetByNameAndValue(":method", "PUT"));
+  EXPECT_EQ(index.kNotFound, index.GetByNameAndValue(":metho", "dGET"));
+  EXPECT_EQ(index.kNotFound, index.GetByName("x-custom"));
+  EXPECT_EQ(index.kNotFound, index.GetByName(""));
+}
+
 }  // namespace
 
 }  // namespace test
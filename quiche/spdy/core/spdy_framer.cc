@@ -93,7 +93,7 @@ uint8_t SerializePushPromiseFrameFlags(const SpdyPushPromiseIR& push_promise_ir,
 // block. Does not need or use the SpdyHeaderBlock inside SpdyHeadersIR.
 // Return false if the serialization fails. |encoding| should not be empty.
 bool SerializeHeadersGivenEncoding(const SpdyHeadersIR& headers,
-                                   const std::string& encoding,
+                                   absl::string_view encoding,
                                    const bool end_headers,
                                    ZeroCopyOutputBuffer* output) {
   const size_t frame_size =
@@ -136,7 +136,7 @@ bool SerializeHeadersGivenEncoding(const SpdyHeadersIR& headers,
 // encoded header block. Does not need or use the SpdyHeaderBlock inside
 // SpdyPushPromiseIR.
 bool SerializePushPromiseGivenEncoding(const SpdyPushPromiseIR& push_promise,
-                                       const std::string& encoding,
+                                       absl::string_view encoding,
                                        const bool end_headers,
                                        ZeroCopyOutputBuffer* output) {
   const size_t frame_size =
@@ -163,6 +163,22 @@ bool SerializePushPromiseGivenEncoding(const SpdyPushPromiseIR& push_promise,
   return ok;
 }
 
+// Serializes a CONTINUATION frame carrying |encoding| for |stream_id|.
+bool SerializeContinuationGivenEncoding(SpdyStreamId stream_id,
+                                        absl::string_view encoding,
+                                        const bool end_headers,
+                                        ZeroCopyOutputBuffer* output) {
+  const size_t frame_size = kContinuationFrameMinimumSize + encoding.size();
+  SpdyFrameBuilder builder(frame_size, output);
+  const uint8_t flags = end_headers ? HEADERS_FLAG_END_HEADERS : 0;
+  bool ok = builder.BeginNewFrame(SpdyFrameType::CONTINUATION, flags, stream_id,
+                                  frame_size - kFrameHeaderSize);
+  QUICHE_DCHECK_EQ(kFrameHeaderSize, builder.length());
+
+  ok = ok && builder.WriteBytes(encoding.data(), encoding.size());
+  return ok;
+}
+
 bool WritePayloadWithContinuation(SpdyFrameBuilder* builder,
                                   const std::string& hpack_encoding,
                                   SpdyStreamId stream_id, SpdyFrameType type,
@@ -294,8 +310,9 @@ size_t SpdyFramer::SpdyFrameIterator::NextFrame(ZeroCopyOutputBuffer* output) {
 
   const size_t size_without_block =
       is_first_frame_ ? GetFrameSizeSansBlock() : kContinuationFrameMinimumSize;
-  std::string encoding =
-      encoder_->Next(kHttp2MaxControlFrameSendSize - size_without_block);
+  std::string& encoding = framer_->hpack_encoding_buffer_;
+  encoder_->Next(kHttp2MaxControlFrameSendSize - size_without_block,
+                 &encoding);
   has_next_frame_ = encoder_->HasNext();
 
   if (framer_->debug_visitor_ != nullptr) {
@@ -315,10 +332,8 @@ size_t SpdyFramer::SpdyFrameIterator::NextFrame(ZeroCopyOutputBuffer* output) {
     is_first_frame_ = false;
     ok = SerializeGivenEncoding(encoding, output);
   } else {
-    SpdyContinuationIR continuation_ir(frame_ir.stream_id());
-    continuation_ir.take_encoding(std::move(encoding));
-    continuation_ir.set_end_headers(!has_next_frame_);
-    ok = framer_->SerializeContinuation(continuation_ir, output);
+    ok = SerializeContinuationGivenEncoding(frame_ir.stream_id(), encoding,
+                                            !has_next_frame_, output);
   }
   return ok ? free_bytes_before - output->BytesFree() : 0;
 }
@@ -344,7 +359,7 @@ size_t SpdyFramer::SpdyHeaderFrameIterator::GetFrameSizeSansBlock() const {
 }
 
 bool SpdyFramer::SpdyHeaderFrameIterator::SerializeGivenEncoding(
-    const std::string& encoding, ZeroCopyOutputBuffer* output) const {
+    absl::string_view encoding, ZeroCopyOutputBuffer* output) const {
   return SerializeHeadersGivenEncoding(*headers_ir_, encoding,
                                        !has_next_frame(), output);
 }
@@ -368,7 +383,7 @@ size_t SpdyFramer::SpdyPushPromiseFrameIterator::GetFrameSizeSansBlock() const {
 }
 
 bool SpdyFramer::SpdyPushPromiseFrameIterator::SerializeGivenEncoding(
-    const std::string& encoding, ZeroCopyOutputBuffer* output) const {
+    absl::string_view encoding, ZeroCopyOutputBuffer* output) const {
   return SerializePushPromiseGivenEncoding(*push_promise_ir_, encoding,
                                            !has_next_frame(), output);
 }
@@ -1180,17 +1195,9 @@ bool SpdyFramer::SerializePushPromise(const SpdyPushPromiseIR& push_promise,
 
 bool SpdyFramer::SerializeContinuation(const SpdyContinuationIR& continuation,
                                        ZeroCopyOutputBuffer* output) const {
-  const std::string& encoding = continuation.encoding();
-  size_t frame_size = kContinuationFrameMinimumSize + encoding.size();
-  SpdyFrameBuilder builder(frame_size, output);
-  uint8_t flags = continuation.end_headers() ? HEADERS_FLAG_END_HEADERS : 0;
-  bool ok = builder.BeginNewFrame(SpdyFrameType::CONTINUATION, flags,
-                                  continuation.stream_id(),
-                                  frame_size - kFrameHeaderSize);
-  QUICHE_DCHECK_EQ(kFrameHeaderSize, builder.length());
-
-  ok = ok && builder.WriteBytes(encoding.data(), encoding.size());
-  return ok;
+  return SerializeContinuationGivenEncoding(continuation.stream_id(),
+                                            continuation.encoding(),
+                                            continuation.end_headers(), output);
 }
 
 bool SpdyFramer::SerializeAltSvc(const SpdyAltSvcIR& altsvc_ir,
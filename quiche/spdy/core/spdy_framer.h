@@ -273,7 +273,7 @@ class QUICHE_EXPORT_PRIVATE SpdyFramer {
 
    protected:
     virtual size_t GetFrameSizeSansBlock() const = 0;
-    virtual bool SerializeGivenEncoding(const std::string& encoding,
+    virtual bool SerializeGivenEncoding(absl::string_view encoding,
                                         ZeroCopyOutputBuffer* output) const = 0;
 
     SpdyFramer* GetFramer() const { return framer_; }
@@ -307,7 +307,7 @@ class QUICHE_EXPORT_PRIVATE SpdyFramer {
    private:
     const SpdyFrameIR& GetIR() const override;
     size_t GetFrameSizeSansBlock() const override;
-    bool SerializeGivenEncoding(const std::string& encoding,
+    bool SerializeGivenEncoding(absl::string_view encoding,
                                 ZeroCopyOutputBuffer* output) const override;
 
     const std::unique_ptr<const SpdyHeadersIR> headers_ir_;
@@ -329,7 +329,7 @@ class QUICHE_EXPORT_PRIVATE SpdyFramer {
    private:
     const SpdyFrameIR& GetIR() const override;
     size_t GetFrameSizeSansBlock() const override;
-    bool SerializeGivenEncoding(const std::string& encoding,
+    bool SerializeGivenEncoding(absl::string_view encoding,
                                 ZeroCopyOutputBuffer* output) const override;
 
     const std::unique_ptr<const SpdyPushPromiseIR> push_promise_ir_;
@@ -368,6 +368,12 @@ class QUICHE_EXPORT_PRIVATE SpdyFramer {
 
   std::unique_ptr<HpackEncoder> hpack_encoder_;
 
+  // Holds the HPACK encoding of the frame being serialized by an iterator.
+  // Its capacity is traded with the encoder's output stream on every frame,
+  // so that header blocks are encoded without allocating once both have grown
+  // to the usual block size.
+  std::string hpack_encoding_buffer_;
+
   SpdyFramerDebugVisitorInterface* debug_visitor_;
 
   // Determines whether HPACK compression is used.
@@ -9,11 +9,13 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <set>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include "absl/base/macros.h"
+#include "absl/strings/str_cat.h"
 #include "quiche/common/platform/api/quiche_logging.h"
 #include "quiche/common/platform/api/quiche_test.h"
 #include "quiche/common/quiche_text_utils.h"
@@ -78,6 +80,10 @@ MATCHER_P(IsFrameUnionOf, frame_list, "") {
 
 class SpdyFramerPeer {
  public:
+  static const std::string& GetHpackEncodingBuffer(const SpdyFramer* framer) {
+    return framer->hpack_encoding_buffer_;
+  }
+
   // TODO(dahollings): Remove these methods when deprecating non-incremental
   // header serialization path.
   static std::unique_ptr<SpdyHeadersIR> CloneSpdyHeadersIR(
@@ -2805,6 +2811,31 @@ TEST_P(SpdyFramerTest, TooLargeHeadersFrameUsesContinuation) {
   EXPECT_EQ(0, visitor.zero_length_control_frame_header_data_count_);
 }
 
+// Header blocks serialized by successive iterators are encoded into buffers
+// owned by the framer and its encoder, rather than into new strings.
+TEST_P(SpdyFramerTest, IteratorsReuseHpackEncodingBuffer) {
+  SpdyFramer framer(SpdyFramer::ENABLE_COMPRESSION);
+  std::set<const char*> encoding_buffers;
+  for (int i = 0; i < 10; ++i) {
+    auto headers = std::make_unique<SpdyHeadersIR>(/* stream_id = */ 1 + 2 * i);
+    // A distinct name in every block, so that none of them is indexed.
+    headers->SetHeader(absl::StrCat("foo", i), std::string(1000, 'a'));
+    std::unique_ptr<SpdyFrameSequence> frame_it =
+        SpdyFramer::CreateIterator(&framer, std::move(headers));
+    while (frame_it->HasNextFrame()) {
+      output_.Reset();
+      EXPECT_GT(frame_it->NextFrame(&output_), 0u);
+    }
+    const std::string& encoding_buffer =
+        SpdyFramerPeer::GetHpackEncodingBuffer(&framer);
+    EXPECT_LT(500u, encoding_buffer.size());
+    encoding_buffers.insert(encoding_buffer.data());
+  }
+  // The framer's buffer and the encoder's output stream trade their capacity,
+  // so every block ends up in one of the same two allocations.
+  EXPECT_GE(2u, encoding_buffers.size());
+}
+
 TEST_P(SpdyFramerTest, MultipleContinuationFramesWithIterator) {
   SpdyFramer framer(SpdyFramer::DISABLE_COMPRESSION);
   auto headers = std::make_unique<SpdyHeadersIR>(/* stream_id = */ 1);